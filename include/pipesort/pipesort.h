@@ -19,6 +19,7 @@ extern "C" {
  * Sorts N keys stored in a flat uint64_t array:
  *   keys length = n * limbs
  *   key i stored at keys[i*limbs + 0 .. i*limbs + limbs-1]
+ * The engine itself allocates nothing; run detection may (see psort_u128).
  */
 void psort_u(uint64_t* keys, size_t n, size_t limbs);
 
@@ -34,10 +35,41 @@ typedef struct { uint64_t w7,w6,w5,w4,w3,w2,w1,w0; } psort_u512_t;
 
 /* ---------------- Specialized variants ---------------- */
 
-/* In place sort for psort_u128 */
+/* In place sort for psort_u128.
+ * psort_u128, psort_u256, psort_u512 and psort_u sort without buffers,
+ * except after their O(n) run check: merging a long sorted prefix with the
+ * sorted rest copies the shorter part, min(prefix, rest) <= n / 2 keys, and
+ * a drop-merge of nearly sorted input holds at most n / 8 keys. That scratch
+ * comes from the bound psort_ctx or malloc; without it they just sort
+ * without the shortcut. Random input never allocates. */
 void psort_u128(psort_u128_t* keys, int n);
 int  psort_u128_is_sorted(const psort_u128_t* keys, int n);
 
+/* Selection. select (nth element): afterwards keys[k] is the k-th smallest
+ * key (0 based), keys before it are <= and keys after it are >= it.
+ * partial_sort: the k smallest keys in ascending order in keys[0..k), the
+ * rest unordered. Expected O(n) and O(n + k log k). */
+void psort_u128_select(psort_u128_t* keys, int n, int k);
+void psort_u128_partial_sort(psort_u128_t* keys, int n, int k);
+
+/* Sort + deduplicate in one pass: keys[0..m) become the distinct keys in
+ * ascending order and m is returned. If counts is not NULL (length n),
+ * counts[g] is the multiplicity of keys[g]; its prefix sums are the group
+ * boundaries in the fully sorted order. */
+int psort_u128_unique(psort_u128_t* keys, int n, uint32_t* counts);
+
+/* Multithreaded psort_u128. nthreads <= 0 uses all online CPUs.
+ * Output is byte identical to psort_u128. */
+void psort_u128_parallel(psort_u128_t* keys, int n, int nthreads);
+
+/* In place key sorts for 256/512-bit keys (no index; scratch only for run
+ * merges, as for psort_u128) */
+void psort_u256(psort_u256_t* keys, int n);
+int  psort_u256_is_sorted(const psort_u256_t* keys, int n);
+
+void psort_u512(psort_u512_t* keys, int n);
+int  psort_u512_is_sorted(const psort_u512_t* keys, int n);
+
 /* Index sort (does not move keys). tmp must be length n. */
 void psort_u256_index(uint32_t* idx, uint32_t* tmp,
                       const psort_u256_t* keys, int n);
@@ -45,6 +77,379 @@ void psort_u256_index(uint32_t* idx, uint32_t* tmp,
 void psort_u512_index(uint32_t* idx, uint32_t* tmp,
                       const psort_u512_t* keys, int n);
 
+/* Index selection, same contracts as psort_u128_select / _partial_sort on
+ * keys[idx[i]]. idx must hold a permutation of 0..n-1 (e.g. the identity),
+ * tmp must be length n. */
+void psort_u256_index_select(uint32_t* idx, uint32_t* tmp,
+                             const psort_u256_t* keys, int n, int k);
+void psort_u256_index_partial_sort(uint32_t* idx, uint32_t* tmp,
+                                   const psort_u256_t* keys, int n, int k);
+
+void psort_u512_index_select(uint32_t* idx, uint32_t* tmp,
+                             const psort_u512_t* keys, int n, int k);
+void psort_u512_index_partial_sort(uint32_t* idx, uint32_t* tmp,
+                                   const psort_u512_t* keys, int n, int k);
+
+/* Index sort + deduplicate: idx[0..m) index one key per distinct value
+ * (the first occurrence in idx order), ascending; m is returned. counts is
+ * optional, as for psort_u128_unique. idx must hold a permutation of 0..n-1. */
+int psort_u256_index_unique(uint32_t* idx, uint32_t* tmp,
+                            const psort_u256_t* keys, int n, uint32_t* counts);
+int psort_u512_index_unique(uint32_t* idx, uint32_t* tmp,
+                            const psort_u512_t* keys, int n, uint32_t* counts);
+
+/* Index sorts with key prefix caching: passes run over dense
+ * (32-bit key chunk, index) pairs and only gather keys when a digit crosses
+ * a chunk boundary. Best once keys exceed the caches. Same idx output as
+ * psort_u256_index / psort_u512_index. tmp must have length 4n (the pairs
+ * are built there); nothing is allocated. */
+void psort_u256_index_cached(uint32_t* idx, uint32_t* tmp,
+                             const psort_u256_t* keys, int n);
+
+void psort_u512_index_cached(uint32_t* idx, uint32_t* tmp,
+                             const psort_u512_t* keys, int n);
+
+/* Index sorts for uniformly distributed keys (hashes, digests): the leading
+ * 64 bits are copied once into dense (prefix, index) pairs and radix sorted
+ * on about log2(n) + 12 bits; only the rare runs still sharing those bits are
+ * ordered at full width. Other distributions sort correctly but pay for the
+ * prefix passes. Same idx output as psort_u256_index / psort_u512_index
+ * (stable). Allocates 32 bytes per key; runs psort_u*_index with tmp if that
+ * fails. */
+void psort_u256_index_hash(uint32_t* idx, uint32_t* tmp,
+                           const psort_u256_t* keys, int n);
+
+void psort_u512_index_hash(uint32_t* idx, uint32_t* tmp,
+                           const psort_u512_t* keys, int n);
+
+/* Multithreaded index sorts. nthreads <= 0 uses all online CPUs.
+ * Same idx output as the serial versions. */
+void psort_u256_index_parallel(uint32_t* idx, uint32_t* tmp,
+                               const psort_u256_t* keys, int n, int nthreads);
+
+void psort_u512_index_parallel(uint32_t* idx, uint32_t* tmp,
+                               const psort_u512_t* keys, int n, int nthreads);
+
+/* ---------------- 64-bit sizes ----------------
+ *
+ * The entry points above take int n and uint32_t indices (<= INT_MAX keys).
+ * These accept any n. Key sorts: n <= INT_MAX runs the int version,
+ * larger arrays the psort_u engine. Index sorts: idx is a permutation of
+ * 0..n-1 and tmp has n entries; when n <= INT_MAX the indices are narrowed
+ * to uint32_t inside tmp and the psort_uW_index engine runs, so the int API
+ * (half the index memory) stays the faster choice whenever n fits.
+ */
+void psort_u128_large(psort_u128_t* keys, size_t n);
+void psort_u256_large(psort_u256_t* keys, size_t n);
+void psort_u512_large(psort_u512_t* keys, size_t n);
+
+void psort_u256_index64(uint64_t* idx, uint64_t* tmp,
+                        const psort_u256_t* keys, size_t n);
+void psort_u512_index64(uint64_t* idx, uint64_t* tmp,
+                        const psort_u512_t* keys, size_t n);
+
+/* ---------------- Key + payload sorts ----------------
+ *
+ * vals is a parallel array of n elements of val_size bytes (SoA layout);
+ * vals[i] moves together with keys[i]. 4 and 8 byte payloads use dedicated
+ * moves, any other size is copied bytewise. Not stable.
+ */
+void psort_u128_kv(psort_u128_t* keys, void* vals, int n, size_t val_size);
+void psort_u256_kv(psort_u256_t* keys, void* vals, int n, size_t val_size);
+
+/* ---------------- Stable buffered sorts ----------------
+ *
+ * Out of place MSD radix sorts using caller scratch (tmp: n keys, tmp_vals:
+ * n * val_size bytes). Each level scatters from the buffer holding the range
+ * into the other one, so nothing is copied back per level. The result is in
+ * keys / vals and equal keys keep their input order.
+ */
+void psort_u128_stable(psort_u128_t* keys, psort_u128_t* tmp, int n);
+void psort_u128_kv_stable(psort_u128_t* keys, void* vals,
+                          psort_u128_t* tmp, void* tmp_vals,
+                          int n, size_t val_size);
+
+/* ---------------- Merging sorted arrays ----------------
+ *
+ * Merge ascending inputs into out (length = total input length, must not
+ * overlap the inputs). Equal keys keep input order. The k-way merges use a
+ * loser tree (log2(k) compares per key).
+ */
+void psort_u128_merge(psort_u128_t* out,
+                      const psort_u128_t* a, size_t na,
+                      const psort_u128_t* b, size_t nb);
+void psort_u128_merge_k(psort_u128_t* out, const psort_u128_t* const* runs,
+                        const size_t* lens, size_t k);
+
+void psort_u256_merge(psort_u256_t* out,
+                      const psort_u256_t* a, size_t na,
+                      const psort_u256_t* b, size_t nb);
+void psort_u256_merge_k(psort_u256_t* out, const psort_u256_t* const* runs,
+                        const size_t* lens, size_t k);
+
+/* ---------------- Streaming sorter ----------------
+ *
+ * Keys arrive in batches; a sorted view is needed now and then.
+ * push copies and sorts the batch into a run; runs of similar size are
+ * merged as they accumulate (size tiered), so there are O(log(n / batch))
+ * runs and each key is merged O(log(n / batch)) times in total.
+ * finish writes all keys pushed so far, ascending, to out (length
+ * psort_u128_stream_size()); the stream stays usable for more pushes.
+ * push returns 0, or -1 if out of memory (the batch is then not added).
+ */
+typedef struct psort_u128_stream psort_u128_stream;
+
+psort_u128_stream* psort_u128_stream_create(void);
+void   psort_u128_stream_destroy(psort_u128_stream* s);
+int    psort_u128_stream_push(psort_u128_stream* s, const psort_u128_t* keys, size_t n);
+size_t psort_u128_stream_size(const psort_u128_stream* s);
+void   psort_u128_stream_finish(const psort_u128_stream* s, psort_u128_t* out);
+
+/* ---------------- Byte string keys ----------------
+ *
+ * Fixed width keys stored as raw bytes (key i = bytes[i*width ..
+ * i*width + width), e.g. SHA-256 digests), sorted in memcmp order without
+ * converting to limbs: bits and digits are read with byte swapped loads.
+ * psort_bytes sorts in place (any width; 16, 20, 32 and 64 are specialized).
+ * psort_bytes_index is stable and leaves the keys untouched; idx holds a
+ * permutation of 0..n-1 and tmp has n entries, as for psort_u256_index.
+ */
+void psort_bytes(void* keys, size_t n, size_t width);
+void psort_bytes_index(uint32_t* idx, uint32_t* tmp, const void* bytes,
+                       int n, size_t width);
+
+/* ---------------- Records with an embedded key ----------------
+ *
+ * Record i is stride bytes at (char*)base + i * stride; its key is a
+ * psort_u128_t / psort_u256_t (same limb layout, any alignment) at byte
+ * key_offset. Keys are read in place. The record sorts move whole records;
+ * the index sorts are stable, idx holds a permutation of 0..n-1 and tmp has
+ * n entries. Calls with key_offset + key size > stride do nothing.
+ */
+void psort_u128_records(void* base, size_t n, size_t stride, size_t key_offset);
+void psort_u256_records(void* base, size_t n, size_t stride, size_t key_offset);
+void psort_u128_records_index(uint32_t* idx, uint32_t* tmp, const void* base, int n,
+                              size_t stride, size_t key_offset);
+void psort_u256_records_index(uint32_t* idx, uint32_t* tmp, const void* base, int n,
+                              size_t stride, size_t key_offset);
+
+/* ---------------- Applying an index permutation ----------------
+ *
+ * Materialize the result of an index sort: element i of the output is
+ * element idx[i] of the input, elements being width bytes (keys or payload
+ * columns of any width). idx is the idx output of any of the index sorts.
+ * psort_apply_index gathers into out (not overlapping src); wide elements
+ * are prefetched ahead so their random reads overlap. psort_apply_index_columns
+ * applies idx to ncols column arrays (outs[c], srcs[c], widths[c]) block by
+ * block, reading idx once for all of them. psort_apply_index_inplace permutes
+ * data itself by following the cycles of idx: no second buffer, but each
+ * step waits on the previous one, so it is slower than a gather. idx is
+ * unchanged on return (it holds visited marks meanwhile).
+ */
+void psort_apply_index(void* out, const void* src, const uint32_t* idx,
+                       int n, size_t width);
+void psort_apply_index_columns(void* const* outs, const void* const* srcs,
+                               const size_t* widths, size_t ncols,
+                               const uint32_t* idx, int n);
+void psort_apply_index_inplace(void* data, uint32_t* idx, int n, size_t width);
+
+/* ---------------- Lookups in sorted arrays ----------------
+ *
+ * A directory over a sorted key array for repeated lower bound searches.
+ * Keys below the array's common prefix are bucketed on their next `bits`
+ * bits (0: about two keys per bucket, at most 24 bits, 4 bytes per bucket);
+ * a lookup reads its bucket start and searches just that bucket, instead of
+ * the ~log2(n) dependent cache misses of a binary search. The batch versions
+ * work through the queries in groups and prefetch the directory entries and
+ * buckets of a whole group before searching, so the misses overlap.
+ * lower_bound returns the first i with keys[i] >= *key, n if none; a key is
+ * present iff that i < n and keys[i] equals it. The directory refers to keys:
+ * they must stay in place and unchanged until it is destroyed. build returns
+ * NULL with errno set if out of memory or n >= 2^32.
+ */
+typedef struct psort_u128_dir psort_u128_dir;
+typedef struct psort_u256_dir psort_u256_dir;
+
+psort_u128_dir* psort_u128_dir_build(const psort_u128_t* keys, size_t n, int bits);
+void   psort_u128_dir_destroy(psort_u128_dir* d);
+size_t psort_u128_lower_bound(const psort_u128_dir* d, const psort_u128_t* key);
+void   psort_u128_lower_bound_batch(const psort_u128_dir* d, const psort_u128_t* keys,
+                                    size_t m, size_t* out);
+
+psort_u256_dir* psort_u256_dir_build(const psort_u256_t* keys, size_t n, int bits);
+void   psort_u256_dir_destroy(psort_u256_dir* d);
+size_t psort_u256_lower_bound(const psort_u256_dir* d, const psort_u256_t* key);
+void   psort_u256_lower_bound_batch(const psort_u256_dir* d, const psort_u256_t* keys,
+                                    size_t m, size_t* out);
+
+/* ---------------- External memory sorts ----------------
+ *
+ * Sort a file of fixed width big endian keys (the byte order memcmp sorts
+ * by; 16, 32 or 64 bytes per key) into out_path, for inputs larger than RAM.
+ * mem_budget bounds the working memory in bytes (raised to 1 MiB if
+ * smaller). Sorted runs go to unlinked temp files in tmp_dir (NULL: $TMPDIR,
+ * else /tmp) and are k-way merged; run reads and output writes overlap with
+ * sorting and merging. in_path may equal out_path.
+ * Returns 0, or -1 with errno set.
+ */
+int psort_file_u128(const char* in_path, const char* out_path,
+                    size_t mem_budget, const char* tmp_dir);
+int psort_file_u256(const char* in_path, const char* out_path,
+                    size_t mem_budget, const char* tmp_dir);
+int psort_file_u512(const char* in_path, const char* out_path,
+                    size_t mem_budget, const char* tmp_dir);
+
+/* ---------------- Sort contexts ----------------
+ *
+ * A psort_ctx owns scratch memory that sorts reuse from call to call, so a
+ * caller sorting many arrays stops paying for malloc, free and fresh page
+ * faults each time. Chunks come from the psort_allocator (NULL, or a NULL
+ * alloc: malloc / free; free gets the size that was passed to alloc and may
+ * be NULL). PSORT_CTX_HUGE_PAGES maps chunks of 1 MiB and more with a
+ * transparent huge page hint (Linux, default allocator only).
+ *
+ * psort_ctx_bind makes the sorts called on this thread take their scratch
+ * (run detection merges, cached prefix and hash entries, k-way merge trees)
+ * from ctx and returns the previous binding; bind NULL to go back to malloc.
+ * The context grows to the largest call seen and then serves calls of that
+ * size without any allocator call; psort_ctx_reserve sizes it up front.
+ * psort_ctx_alloc / psort_ctx_free hand out 64 byte aligned blocks, e.g. for
+ * the tmp arrays of the index sorts (free in reverse order to reuse space at
+ * once); psort_u256_index_ctx / psort_u512_index_ctx do both for
+ * psort_u256_index / psort_u512_index. psort_ctx_peak is the most scratch in
+ * use at once (bytes, block headers included), psort_ctx_capacity what the
+ * context holds. Parallel sorts, streams and file sorts still allocate their
+ * own state. A context serves one thread at a time.
+ * create and alloc return NULL if out of memory; reserve and the _ctx sorts
+ * return 0, or -1 with errno set (idx is then untouched).
+ */
+typedef struct {
+    void* (*alloc)(void* user, size_t bytes);
+    void  (*free)(void* user, void* p, size_t bytes);
+    void* user;
+} psort_allocator;
+
+typedef struct psort_ctx psort_ctx;
+
+#define PSORT_CTX_HUGE_PAGES 1u
+
+psort_ctx* psort_ctx_create(const psort_allocator* a, unsigned flags);
+void       psort_ctx_destroy(psort_ctx* ctx);
+int        psort_ctx_reserve(psort_ctx* ctx, size_t bytes);
+size_t     psort_ctx_capacity(const psort_ctx* ctx);
+size_t     psort_ctx_peak(const psort_ctx* ctx);
+psort_ctx* psort_ctx_bind(psort_ctx* ctx);
+void*      psort_ctx_alloc(psort_ctx* ctx, size_t bytes);
+void       psort_ctx_free(psort_ctx* ctx, void* p);
+int psort_u256_index_ctx(psort_ctx* ctx, uint32_t* idx, const psort_u256_t* keys, int n);
+int psort_u512_index_ctx(psort_ctx* ctx, uint32_t* idx, const psort_u512_t* keys, int n);
+
+/* ---------------- Tuning ----------------
+ *
+ * Partition kernel of the in place bit partition sorts (psort_u128,
+ * psort_u128_parallel, psort_u):
+ *   AUTO  — AVX-512 compress stores for 128-bit keys if the CPU has them,
+ *           else the block partition for large ranges, Hoare for small ones
+ *           (default)
+ *   HOARE — classic two sided scan, best when the tested bit is predictable
+ *   BLOCK — BlockQuicksort style: branch free offset buffers, batched swaps
+ *   SIMD  — AVX-512 compress stores (BLOCK on other CPUs)
+ * The PIPESORT_PARTITION=auto|hoare|block|simd environment variable sets the
+ * initial mode. Output does not depend on the mode.
+ */
+enum {
+    PSORT_PARTITION_AUTO  = 0,
+    PSORT_PARTITION_HOARE = 1,
+    PSORT_PARTITION_BLOCK = 2,
+    PSORT_PARTITION_SIMD  = 3
+};
+void psort_set_partition(int mode);
+int  psort_get_partition(void);
+
+/* ---------------- Machine profile ----------------
+ *
+ * Leaf cutoffs, radix digit widths and engine choices the sorts consult.
+ * The right values move with cache sizes and CPU generation, so they live in
+ * a profile instead of constants:
+ *   u128_cutoff       insertion sort leaf size of psort_u128 and of its
+ *                     select, partial sort and unique (likewise u256_cutoff,
+ *                     u512_cutoff and u_cutoff for psort_u256 / psort_u512 /
+ *                     psort_u)
+ *   radix_cutoff      leaf size of the radix index sorts: psort_u256_index
+ *                     (select, unique, _cached, index64 too),
+ *                     psort_bytes_index and the records index sorts
+ *   radix_bits*_min   ranges of at least this many keys take 6, 8 and 11 bit
+ *                     digits in those index sorts (4 bits below)
+ *   u512_radix_*      the same settings for 512-bit keys: psort_u512_index
+ *                     and its variants, psort_bytes_index of 64 byte keys
+ *   u*_generic_min    psort_u128 / psort_u256 / psort_u512 sort arrays of at
+ *                     least this many keys with the psort_u engine instead of
+ *                     their width specialized one (INT_MAX: never)
+ * Defaults are the built in constants. At first use the profile is read from
+ * the file named by PIPESORT_PROFILE, if set. psort_tune() times candidates
+ * on this host with random keys of up to max_n keys (0: 1M; several seconds),
+ * installs the winners and copies them to out (may be NULL); save the result
+ * with psort_profile_save and point PIPESORT_PROFILE at it. Returns 0, or -1
+ * with errno set if the scratch buffers cannot be allocated.
+ * Change the profile only while no sort is running.
+ * load / save return 0, or -1 with errno set (EINVAL: not a profile file).
+ */
+typedef struct {
+    int u128_cutoff;
+    int u256_cutoff;
+    int u512_cutoff;
+    int u_cutoff;
+    int radix_cutoff;
+    int radix_bits6_min;
+    int radix_bits8_min;
+    int radix_bits11_min;
+    int u512_radix_cutoff;
+    int u512_radix_bits6_min;
+    int u512_radix_bits8_min;
+    int u512_radix_bits11_min;
+    int u128_generic_min;
+    int u256_generic_min;
+    int u512_generic_min;
+} psort_profile;
+
+void psort_profile_default(psort_profile* p);
+void psort_get_profile(psort_profile* p);
+void psort_set_profile(const psort_profile* p); /* NULL restores the defaults */
+int  psort_profile_load(const char* path, psort_profile* p);
+int  psort_profile_save(const char* path, const psort_profile* p);
+int  psort_tune(psort_profile* out, size_t max_n);
+
+/* ---------------- Instrumentation ----------------
+ *
+ * Counters filled by the in place u128 sort (psort_u128), the adaptive
+ * radix index sorts (psort_u256_index / psort_u512_index) and psort_u.
+ * Only builds configured with PIPESORT_STATS (cmake -DPIPESORT_STATS=ON,
+ * make STATS=1) count anything; otherwise the hooks compile away,
+ * psort_stats_enabled returns 0 and psort_stats_get reports zeros.
+ *
+ * Counters are per thread and accumulate until psort_stats_reset. The
+ * cycles_* fields are TSC ticks on x86, nanoseconds elsewhere.
+ */
+typedef struct {
+    uint64_t levels;          /* diff scans / digit count passes run */
+    uint64_t skipped_levels;  /* levels where all keys agreed */
+    uint64_t partitions;      /* bit partitions and digit scatters */
+    uint64_t leaf_calls;      /* insertion sort leaves */
+    uint64_t leaf_elems;      /* keys sorted in leaves */
+    uint64_t max_leaf;        /* largest leaf */
+    uint64_t max_depth;       /* deepest recursion / explicit stack */
+    uint64_t elems_moved;     /* keys or indices written by partitions */
+    uint64_t bytes_moved;
+    uint64_t cycles_diff_scan;
+    uint64_t cycles_partition;
+    uint64_t cycles_scatter;
+    uint64_t cycles_leaf;
+} psort_stats;
+
+int  psort_stats_enabled(void);
+void psort_stats_reset(void);
+void psort_stats_get(psort_stats* out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,21 +1,16 @@
 #include "pipe_sort_u128.h"
+#include "psort_partition.h"
+#include "psort_simd.h"
+#include "psort_stats.h"
+#include "psort_tune.h"
+#include "psort_bits.h"
 #include <stddef.h>
 #include <assert.h>
 
-static inline int clz64_nonzero(uint64_t x) {
-#if defined(__GNUC__) || defined(__clang__)
-    return __builtin_clzll(x);
-#else
-    int n = 0;
-    while ((x & (1ULL << 63)) == 0) { n++; x <<= 1; }
-    return n;
-#endif
-}
-
 static inline int highest_set_bit_index_u128(uint64_t diff_hi, uint64_t diff_lo) {
     // diff is guaranteed non zero by caller
-    if (diff_hi) return 127 - clz64_nonzero(diff_hi);
-    return 63 - clz64_nonzero(diff_lo);
+    if (diff_hi) return 127 - psort_clz64(diff_hi);
+    return 63 - psort_clz64(diff_lo);
 }
 
 static inline void insertion_sort_u128(u128* a, int n) {
@@ -30,6 +25,32 @@ static inline void insertion_sort_u128(u128* a, int n) {
     }
 }
 
+// OR of (key ^ base) over a[0..n), per limb. Unrolled: this is the hot loop.
+static inline void diff_scan_u128(const u128* a, int n, uint64_t bh, uint64_t bl,
+                                  uint64_t* out_hi, uint64_t* out_lo) {
+    if (psort_simd_level() > PSORT_SIMD_SCALAR) {
+        const uint64_t base[2] = { bh, bl };
+        uint64_t d[2] = { 0, 0 };
+        psort_simd_diff_scan((const uint64_t*)a, (size_t)n, 2, base, 0, 2, d);
+        *out_hi |= d[0];
+        *out_lo |= d[1];
+        return;
+    }
+
+    uint64_t diff_hi = 0, diff_lo = 0;
+    int i = 0;
+    for (; i + 3 < n; i += 4) {
+        diff_hi |= (a[i+0].hi ^ bh) | (a[i+1].hi ^ bh) | (a[i+2].hi ^ bh) | (a[i+3].hi ^ bh);
+        diff_lo |= (a[i+0].lo ^ bl) | (a[i+1].lo ^ bl) | (a[i+2].lo ^ bl) | (a[i+3].lo ^ bl);
+    }
+    for (; i < n; i++) {
+        diff_hi |= (a[i].hi ^ bh);
+        diff_lo |= (a[i].lo ^ bl);
+    }
+    *out_hi |= diff_hi;
+    *out_lo |= diff_lo;
+}
+
 // Faster partition: choose limb once, no per element (bit>=64) branch
 static inline int partition_by_bit_hi(u128* a, int n, int shift) {
     const uint64_t mask = 1ULL << shift;
@@ -42,6 +63,7 @@ static inline int partition_by_bit_hi(u128* a, int n, int shift) {
             u128 tmp = a[i];
             a[i] = a[j];
             a[j] = tmp;
+            PSORT_STAT_MOVE(2, sizeof(u128));
             i++; j--;
         }
     }
@@ -59,39 +81,56 @@ static inline int partition_by_bit_lo(u128* a, int n, int shift) {
             u128 tmp = a[i];
             a[i] = a[j];
             a[j] = tmp;
+            PSORT_STAT_MOVE(2, sizeof(u128));
             i++; j--;
         }
     }
     return i;
 }
 
+// bit in 0..127. Kernel per psort_partition_pick: Hoare (the two loops
+// above), branch free blocks, or AVX-512 compress stores.
+static inline int partition_by_bit(u128* a, int n, int bit) {
+    const size_t word = bit >= 64 ? 0 : 1;
+    switch (psort_partition_pick((size_t)n, 2)) {
+        case PSORT_PART_SIMD:
+            PSORT_STAT_MOVE(n, sizeof(u128)); // compress stores rewrite the whole range
+            return (int)psort_simd_partition_bit((uint64_t*)a, (size_t)n, 2, word, bit & 63);
+        case PSORT_PART_BLOCK:
+            if (word == 0) return (int)psort_block_partition_bit((uint64_t*)a, (size_t)n, 2, 0, bit - 64);
+            return (int)psort_block_partition_bit((uint64_t*)a, (size_t)n, 2, 1, bit);
+        default:
+            if (bit >= 64) return partition_by_bit_hi(a, n, bit - 64);
+            return partition_by_bit_lo(a, n, bit);
+    }
+}
+
 void pipe_sort_u128(u128* restrict a, int n) {
-    const int INSERTION_CUTOFF = 48;
+    const int INSERTION_CUTOFF = psort_tune_profile()->u128_cutoff;
+    PSORT_STAT_ENTER();
 
     while (n > INSERTION_CUTOFF) {
         const uint64_t bh = a[0].hi;
         const uint64_t bl = a[0].lo;
 
+        PSORT_STAT_CLOCK(t_scan);
         uint64_t diff_hi = 0, diff_lo = 0;
+        diff_scan_u128(a + 1, n - 1, bh, bl, &diff_hi, &diff_lo);
+        PSORT_STAT_CYCLES(cycles_diff_scan, t_scan);
+        PSORT_STAT_ADD(levels, 1);
 
-        // Unrolled diff scan (hot loop)
-        int i = 1;
-        for (; i + 3 < n; i += 4) {
-            diff_hi |= (a[i+0].hi ^ bh) | (a[i+1].hi ^ bh) | (a[i+2].hi ^ bh) | (a[i+3].hi ^ bh);
-            diff_lo |= (a[i+0].lo ^ bl) | (a[i+1].lo ^ bl) | (a[i+2].lo ^ bl) | (a[i+3].lo ^ bl);
-        }
-        for (; i < n; i++) {
-            diff_hi |= (a[i].hi ^ bh);
-            diff_lo |= (a[i].lo ^ bl);
+        if ((diff_hi | diff_lo) == 0) { // all equal in this range
+            PSORT_STAT_ADD(skipped_levels, 1);
+            PSORT_STAT_LEAVE();
+            return;
         }
 
-        if ((diff_hi | diff_lo) == 0) return; // all equal in this range
-
         const int bit_index = highest_set_bit_index_u128(diff_hi, diff_lo);
 
-        int split;
-        if (bit_index >= 64) split = partition_by_bit_hi(a, n, bit_index - 64);
-        else                split = partition_by_bit_lo(a, n, bit_index);
+        PSORT_STAT_CLOCK(t_part);
+        const int split = partition_by_bit(a, n, bit_index);
+        PSORT_STAT_CYCLES(cycles_partition, t_part);
+        PSORT_STAT_ADD(partitions, 1);
 
         // If diff had this bit set, split must be non degenerate.
         // If this ever fires, there's a bug in diff computation or partitioning.
@@ -111,9 +150,153 @@ void pipe_sort_u128(u128* restrict a, int n) {
         }
     }
 
+    PSORT_STAT_CLOCK(t_leaf);
+    insertion_sort_u128(a, n);
+    PSORT_STAT_CYCLES(cycles_leaf, t_leaf);
+    PSORT_STAT_LEAF(n);
+    PSORT_STAT_LEAVE();
+}
+
+// ---------------- selection ----------------
+//
+// The same bit partitions, but only the side holding the target position is
+// refined (select); a partial sort also fully sorts the left side when the
+// target lies right of the split. Expected O(n) / O(n + k log k).
+
+void pipe_sort_u128_select(u128* a, int n, int k) {
+    const int INSERTION_CUTOFF = psort_tune_profile()->u128_cutoff;
+    if (n <= 1 || k < 0 || k >= n) return;
+
+    while (n > INSERTION_CUTOFF) {
+        uint64_t diff_hi = 0, diff_lo = 0;
+        diff_scan_u128(a + 1, n - 1, a[0].hi, a[0].lo, &diff_hi, &diff_lo);
+        if ((diff_hi | diff_lo) == 0) return; // all equal: any position is right
+
+        const int split = partition_by_bit(a, n, highest_set_bit_index_u128(diff_hi, diff_lo));
+        if (k < split) {
+            n = split;
+        } else {
+            a += split;
+            n -= split;
+            k -= split;
+        }
+    }
+
     insertion_sort_u128(a, n);
 }
 
+void pipe_sort_u128_partial(u128* a, int n, int k) {
+    const int INSERTION_CUTOFF = psort_tune_profile()->u128_cutoff;
+    if (n <= 1 || k <= 0) return;
+
+    while (n > INSERTION_CUTOFF) {
+        if (k >= n) {
+            pipe_sort_u128(a, n);
+            return;
+        }
+
+        uint64_t diff_hi = 0, diff_lo = 0;
+        diff_scan_u128(a + 1, n - 1, a[0].hi, a[0].lo, &diff_hi, &diff_lo);
+        if ((diff_hi | diff_lo) == 0) return;
+
+        const int split = partition_by_bit(a, n, highest_set_bit_index_u128(diff_hi, diff_lo));
+        if (k <= split) {
+            n = split; // the k smallest are all left of the split
+        } else {
+            pipe_sort_u128(a, split);
+            a += split;
+            n -= split;
+            k -= split;
+        }
+    }
+
+    insertion_sort_u128(a, n);
+}
+
+// ---------------- unique ----------------
+//
+// Sort + deduplicate in one pass. Ranges are finished in ascending order
+// (left side first, right sides on a stack: each level splits on a lower
+// bit, so at most 128 are pending) and every finished range is emitted
+// straight to a[0..w). A range whose diff scan comes back zero is one group,
+// emitted without another look at its keys; only insertion sort leaves
+// compare neighbours. Equal keys never straddle a split, so groups never
+// continue across ranges, and w never passes the start of the current range.
+
+// Emit key (cnt copies) as group w; returns w + 1.
+static inline int unique_emit(u128* a, uint32_t* counts, int w, u128 key, int cnt) {
+    a[w] = key;
+    if (counts) counts[w] = (uint32_t)cnt;
+    return w + 1;
+}
+
+int pipe_sort_u128_unique(u128* a, int n, uint32_t* counts) {
+    const int INSERTION_CUTOFF = psort_tune_profile()->u128_cutoff;
+    if (n <= 0) return 0;
+
+    struct { int off, n; } stack[130];
+    int sp = 0;
+    int w = 0;
+    int off = 0;
+
+    for (;;) {
+        while (n > INSERTION_CUTOFF) {
+            u128* r = a + off;
+            uint64_t diff_hi = 0, diff_lo = 0;
+            diff_scan_u128(r + 1, n - 1, r[0].hi, r[0].lo, &diff_hi, &diff_lo);
+            if ((diff_hi | diff_lo) == 0) break; // all equal: one group
+
+            const int split = partition_by_bit(r, n, highest_set_bit_index_u128(diff_hi, diff_lo));
+            stack[sp].off = off + split;
+            stack[sp].n = n - split;
+            sp++;
+            n = split;
+        }
+
+        u128* r = a + off;
+        if (n > INSERTION_CUTOFF) {
+            w = unique_emit(a, counts, w, r[0], n);
+        } else {
+            insertion_sort_u128(r, n);
+            int g = 0;
+            for (int i = 1; i <= n; i++) {
+                if (i == n || r[i].hi != r[g].hi || r[i].lo != r[g].lo) {
+                    w = unique_emit(a, counts, w, r[g], i - g);
+                    g = i;
+                }
+            }
+        }
+
+        if (sp == 0) return w;
+        sp--;
+        off = stack[sp].off;
+        n = stack[sp].n;
+    }
+}
+
+// ---------------- building blocks for the parallel driver ----------------
+
+void u128_diff_scan(const u128* a, int n, const u128* base,
+                    uint64_t* diff_hi, uint64_t* diff_lo) {
+    diff_scan_u128(a, n, base->hi, base->lo, diff_hi, diff_lo);
+}
+
+int u128_highest_diff_bit(uint64_t diff_hi, uint64_t diff_lo) {
+    return highest_set_bit_index_u128(diff_hi, diff_lo);
+}
+
+int u128_partition_by_bit(u128* a, int n, int bit) {
+    return partition_by_bit(a, n, bit);
+}
+
+int pipe_sort_u128_split(u128* a, int n) {
+    if (n <= 1) return 0;
+    uint64_t diff_hi = 0, diff_lo = 0;
+    diff_scan_u128(a + 1, n - 1, a[0].hi, a[0].lo, &diff_hi, &diff_lo);
+    if ((diff_hi | diff_lo) == 0) return 0;
+    return partition_by_bit(a, n, highest_set_bit_index_u128(diff_hi, diff_lo));
+}
+
 int u128_is_sorted(const u128* a, int n) {
     for (int i = 1; i < n; i++) {
         if (u128_cmp(&a[i - 1], &a[i]) > 0) return 0;
@@ -4,3 +4,27 @@
 void pipe_sort_u128(u128* restrict a, int n);
 int u128_is_sorted(const u128* a, int n);
 
+// Multithreaded pipe_sort_u128 (nthreads <= 0 = all online CPUs).
+// Produces exactly the same bytes as pipe_sort_u128.
+void pipe_sort_u128_parallel(u128* a, int n, int nthreads);
+
+// nth element: afterwards a[k] is the k-th smallest key, a[0..k) <= a[k] <= a(k..n).
+// Expected O(n): only the partition holding position k is refined.
+void pipe_sort_u128_select(u128* a, int n, int k);
+// The k smallest keys, ascending, in a[0..k); a[k..n) holds the rest unordered.
+void pipe_sort_u128_partial(u128* a, int n, int k);
+
+// Sort + deduplicate: a[0..m) = the distinct keys ascending, counts[g]
+// (optional, length n) = multiplicity of a[g]. Returns m.
+int pipe_sort_u128_unique(u128* a, int n, uint32_t* counts);
+
+// One partition step of pipe_sort_u128: split a[0..n) in place on the highest
+// bit that differs. Returns the split index (0 < split < n), or 0 if all keys are equal.
+int pipe_sort_u128_split(u128* a, int n);
+
+// Kernels behind the split step, exposed for the parallel driver.
+// u128_diff_scan ORs (key ^ base) over a[0..n) into *diff_hi / *diff_lo.
+void u128_diff_scan(const u128* a, int n, const u128* base,
+                    uint64_t* diff_hi, uint64_t* diff_lo);
+int  u128_highest_diff_bit(uint64_t diff_hi, uint64_t diff_lo); // diff must be non zero
+int  u128_partition_by_bit(u128* a, int n, int bit);            // returns count of 0 bits
@@ -0,0 +1,86 @@
+#include "pipe_sort_u128_kv.h"
+#include "pipe_sort_u128.h"
+#include "psort_tune.h"
+#include <string.h>
+#include <assert.h>
+
+// Same algorithm as pipe_sort_u128 (diff scan -> partition on the highest
+// differing bit -> recurse), with a payload swap next to every key swap.
+// The helpers take val_size as a parameter and are always called with a
+// compile time constant (4, 8) or the generic path, so the payload moves
+// in the hot loops are plain 32/64-bit loads and stores.
+
+#define KV_KEY u128
+#define KV_KEY_GT(x, y) (u128_cmp((x), (y)) > 0)
+#include "psort_kv.h"
+
+// limb: 1 = hi, 0 = lo
+static inline int partition_kv_impl(u128* a, unsigned char* v, int n, int limb, int shift, size_t vsz) {
+    const uint64_t mask = 1ULL << shift;
+    int i = 0, j = n - 1;
+
+    while (i <= j) {
+        while (i <= j && ((limb ? a[i].hi : a[i].lo) & mask) == 0) i++;
+        while (i <= j && ((limb ? a[j].hi : a[j].lo) & mask) != 0) j--;
+        if (i < j) {
+            swap_kv(a, v, i, j, vsz);
+            i++; j--;
+        }
+    }
+    return i;
+}
+
+static int partition_kv(u128* a, unsigned char* v, int n, int bit, size_t vsz) {
+    const int limb = bit >= 64;
+    const int shift = bit & 63;
+    switch (vsz) {
+        case 8:
+            return limb ? partition_kv_impl(a, v, n, 1, shift, 8)
+                        : partition_kv_impl(a, v, n, 0, shift, 8);
+        case 4:
+            return limb ? partition_kv_impl(a, v, n, 1, shift, 4)
+                        : partition_kv_impl(a, v, n, 0, shift, 4);
+        default:
+            return limb ? partition_kv_impl(a, v, n, 1, shift, vsz)
+                        : partition_kv_impl(a, v, n, 0, shift, vsz);
+    }
+}
+
+static void pipe_sort_u128_kv_rec(u128* a, unsigned char* v, int n, size_t vsz) {
+    const int INSERTION_CUTOFF = psort_tune_profile()->u128_cutoff;
+
+    while (n > INSERTION_CUTOFF) {
+        uint64_t diff_hi = 0, diff_lo = 0;
+        u128_diff_scan(a + 1, n - 1, &a[0], &diff_hi, &diff_lo);
+
+        if ((diff_hi | diff_lo) == 0) return; // all equal in this range
+
+        const int split = partition_kv(a, v, n, u128_highest_diff_bit(diff_hi, diff_lo), vsz);
+        assert(split > 0 && split < n);
+
+        const int left_n  = split;
+        const int right_n = n - split;
+
+        // Tail recursion elimination: recurse smaller side
+        if (left_n < right_n) {
+            pipe_sort_u128_kv_rec(a, v, left_n, vsz);
+            a += split;
+            v += (size_t)split * vsz;
+            n = right_n;
+        } else {
+            pipe_sort_u128_kv_rec(a + split, v + (size_t)split * vsz, right_n, vsz);
+            n = left_n;
+        }
+    }
+
+    insertion_sort_kv(a, v, n, vsz);
+}
+
+void pipe_sort_u128_kv(u128* a, void* vals, int n, size_t val_size) {
+    if (n <= 1) return;
+    if (!vals || val_size == 0) {
+        pipe_sort_u128(a, n);
+        return;
+    }
+    pipe_sort_u128_kv_rec(a, (unsigned char*)vals, n, val_size);
+}
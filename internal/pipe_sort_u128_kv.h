@@ -0,0 +1,7 @@
+#pragma once
+#include <stddef.h>
+#include "u128.h"
+
+// Sort keys ascending and apply the same permutation to vals, a parallel
+// array of n elements of val_size bytes. Not stable (equal keys may swap payloads).
+void pipe_sort_u128_kv(u128* a, void* vals, int n, size_t val_size);
@@ -0,0 +1,76 @@
+#include "pipe_sort_u128_merge.h"
+#include "pipesort/pipesort.h"
+#include "psort_loser_tree.h"
+#include "psort_scratch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Runs up to this count keep the loser tree on the stack.
+#define MERGE_STACK_K 64
+
+// b < a, without branches (the merge loop's only data dependent decision).
+static inline int u128_less_bits(const u128* b, const u128* a) {
+    return (b->hi < a->hi) | ((b->hi == a->hi) & (b->lo < a->lo));
+}
+
+void u128_merge2(u128* out, const u128* a, size_t na, const u128* b, size_t nb) {
+    size_t i = 0, j = 0, o = 0;
+
+    // Pick the source by pointer select (cmov) and step both cursors by the
+    // flag: no mispredicted branch per key on interleaved inputs.
+    while (i < na && j < nb) {
+        const int take_b = u128_less_bits(&b[j], &a[i]);
+        const u128* src = take_b ? &b[j] : &a[i];
+        out[o++] = *src;
+        j += (size_t)take_b;
+        i += (size_t)(take_b ^ 1);
+    }
+    if (i < na) memcpy(out + o, a + i, (na - i) * sizeof(u128));
+    if (j < nb) memcpy(out + o, b + j, (nb - j) * sizeof(u128));
+}
+
+static int cmp_u128(const void* a, const void* b) {
+    return u128_cmp((const u128*)a, (const u128*)b);
+}
+
+static void merge_loser_tree(u128* out, const u128* const* runs, const size_t* lens,
+                             size_t k, int* tree, int* win, size_t* pos) {
+    psort_lt_merge(out, (const void* const*)runs, lens, k, sizeof(u128), cmp_u128,
+                   tree, win, pos);
+}
+
+void u128_merge_k(u128* out, const u128* const* runs, const size_t* lens, size_t k) {
+    if (k == 0) return;
+    if (k == 1) {
+        if (lens[0]) memcpy(out, runs[0], lens[0] * sizeof(u128));
+        return;
+    }
+    if (k == 2) {
+        u128_merge2(out, runs[0], lens[0], runs[1], lens[1]);
+        return;
+    }
+
+    if (k <= MERGE_STACK_K) {
+        int tree[MERGE_STACK_K], win[2 * MERGE_STACK_K];
+        size_t pos[MERGE_STACK_K];
+        merge_loser_tree(out, runs, lens, k, tree, win, pos);
+        return;
+    }
+
+    int* tree = (int*)psort_scratch_get(3 * k * sizeof(int));
+    size_t* pos = (size_t*)psort_scratch_get(k * sizeof(size_t));
+    if (tree && pos) {
+        merge_loser_tree(out, runs, lens, k, tree, tree + k, pos);
+    } else {
+        // No memory for the tree: concatenate and sort (same output).
+        size_t o = 0;
+        for (size_t i = 0; i < k; i++) {
+            if (lens[i]) memcpy(out + o, runs[i], lens[i] * sizeof(u128));
+            o += lens[i];
+        }
+        psort_u((uint64_t*)out, o, 2); // u128 == 2 big endian limbs, size_t n
+    }
+    psort_scratch_put(tree);
+    psort_scratch_put(pos);
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <stddef.h>
+#include "u128.h"
+
+// Merges of ascending arrays into out (which must not overlap the inputs).
+// Equal keys keep input order: a before b, runs[0] before runs[1] ...
+void u128_merge2(u128* out, const u128* a, size_t na, const u128* b, size_t nb);
+void u128_merge_k(u128* out, const u128* const* runs, const size_t* lens, size_t k);
+
+// Streaming sorter: every pushed batch is copied and sorted into a run, and
+// runs of similar size are merged as they pile up (size tiered, like an LSM
+// tree), so a key is merged O(log(total / batch)) times and at most
+// O(log(total / batch)) runs exist.
+typedef struct u128_stream u128_stream;
+
+u128_stream* u128_stream_create(void);
+void   u128_stream_destroy(u128_stream* s);
+int    u128_stream_push(u128_stream* s, const u128* keys, size_t n); // 0, -1 if out of memory
+size_t u128_stream_size(const u128_stream* s);
+void   u128_stream_finish(const u128_stream* s, u128* out);           // all keys, ascending
@@ -0,0 +1,223 @@
+#include "pipe_sort_u128.h"
+#include "psort_parallel.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+// Below this size threads cost more than they save: plain pipe_sort_u128.
+#define PAR_MIN_N   (1 << 16)
+// Pool tasks at or below this size are finished by the serial sort.
+#define POOL_GRAIN  (1 << 14)
+// Each parallel split consumes one bit, so the top phase never has more than
+// 128 levels of pending ranges (+1 for the root).
+#define TOP_STACK   (2 * 128 + 2)
+
+typedef struct { int lo, hi; } span;
+
+typedef struct {
+    psort_team* team;
+    u128* a;
+    int n;
+    int bit;
+    int split;
+    uint64_t* dh;        // per tid diff scan result
+    uint64_t* dl;
+    int* zeros;          // per tid: keys with bit == 0 in its chunk
+    span* left_ones;     // 1-keys that sit left of split
+    span* right_zeros;   // 0-keys that sit right of split
+    int n_left, n_right;
+    int m;               // number of misplaced pairs
+} split_ctx;
+
+static inline int chunk_at(int n, int tid, int nt) {
+    return (int)((long long)n * tid / nt);
+}
+
+static void phase_diff(void* p, int tid, int nt) {
+    split_ctx* c = (split_ctx*)p;
+    const int lo = chunk_at(c->n, tid, nt);
+    const int hi = chunk_at(c->n, tid + 1, nt);
+    c->dh[tid] = 0;
+    c->dl[tid] = 0;
+    u128_diff_scan(c->a + lo, hi - lo, &c->a[0], &c->dh[tid], &c->dl[tid]);
+}
+
+static void phase_partition(void* p, int tid, int nt) {
+    split_ctx* c = (split_ctx*)p;
+    const int lo = chunk_at(c->n, tid, nt);
+    const int hi = chunk_at(c->n, tid + 1, nt);
+    c->zeros[tid] = u128_partition_by_bit(c->a + lo, hi - lo, c->bit);
+}
+
+// Position of the r-th element over a list of non empty spans.
+static inline void span_locate(const span* s, int r, int* k, int* pos) {
+    int i = 0;
+    while (r >= s[i].hi - s[i].lo) {
+        r -= s[i].hi - s[i].lo;
+        i++;
+    }
+    *k = i;
+    *pos = s[i].lo + r;
+}
+
+// Every chunk is now [0s][1s]. Pair the r-th misplaced 1 on the left with the
+// r-th misplaced 0 on the right; each tid swaps its own slice of pairs.
+static void phase_fixup(void* p, int tid, int nt) {
+    split_ctx* c = (split_ctx*)p;
+    const int r0 = chunk_at(c->m, tid, nt);
+    const int r1 = chunk_at(c->m, tid + 1, nt);
+    if (r0 >= r1) return;
+
+    int kl, pl, kr, pr;
+    span_locate(c->left_ones, r0, &kl, &pl);
+    span_locate(c->right_zeros, r0, &kr, &pr);
+
+    for (int r = r0; r < r1; r++) {
+        u128 tmp = c->a[pl];
+        c->a[pl] = c->a[pr];
+        c->a[pr] = tmp;
+        if (++pl == c->left_ones[kl].hi && ++kl < c->n_left) pl = c->left_ones[kl].lo;
+        if (++pr == c->right_zeros[kr].hi && ++kr < c->n_right) pr = c->right_zeros[kr].lo;
+    }
+}
+
+// Parallel version of pipe_sort_u128_split. Same contract.
+static int parallel_split(split_ctx* c, u128* a, int n, int nt) {
+    c->a = a;
+    c->n = n;
+
+    psort_team_run(c->team, phase_diff, c);
+    uint64_t diff_hi = 0, diff_lo = 0;
+    for (int t = 0; t < nt; t++) {
+        diff_hi |= c->dh[t];
+        diff_lo |= c->dl[t];
+    }
+    if ((diff_hi | diff_lo) == 0) return 0; // all equal in this range
+
+    c->bit = u128_highest_diff_bit(diff_hi, diff_lo);
+    psort_team_run(c->team, phase_partition, c);
+
+    int split = 0;
+    for (int t = 0; t < nt; t++) split += c->zeros[t];
+
+    c->n_left = 0;
+    c->n_right = 0;
+    c->m = 0;
+    for (int t = 0; t < nt; t++) {
+        const int lo = chunk_at(n, t, nt);
+        const int hi = chunk_at(n, t + 1, nt);
+        const int mid = lo + c->zeros[t];
+
+        const int ol = mid, oh = hi < split ? hi : split;
+        if (ol < oh) {
+            c->left_ones[c->n_left++] = (span){ ol, oh };
+            c->m += oh - ol;
+        }
+        const int zl = lo > split ? lo : split, zh = mid;
+        if (zl < zh) c->right_zeros[c->n_right++] = (span){ zl, zh };
+    }
+
+    if (c->m > 0) psort_team_run(c->team, phase_fixup, c);
+
+    assert(split > 0 && split < n);
+    return split;
+}
+
+static void u128_task(psort_pool* pool, int worker, psort_task t, void* ctx) {
+    u128* a = (u128*)ctx + t.off;
+    int n = (int)t.n;
+    size_t off = t.off;
+
+    while (n > POOL_GRAIN) {
+        const int split = pipe_sort_u128_split(a, n);
+        if (split == 0) return; // all equal
+
+        const int left_n = split;
+        const int right_n = n - split;
+
+        // Offer the larger side to thieves, keep going on the smaller one.
+        if (left_n >= right_n) {
+            psort_pool_push(pool, worker, (psort_task){ off, (size_t)left_n, 0 });
+            a += split;
+            off += (size_t)split;
+            n = right_n;
+        } else {
+            psort_pool_push(pool, worker, (psort_task){ off + (size_t)split, (size_t)right_n, 0 });
+            n = left_n;
+        }
+    }
+
+    pipe_sort_u128(a, n);
+}
+
+void pipe_sort_u128_parallel(u128* a, int n, int nthreads) {
+    if (nthreads <= 0) nthreads = psort_par_default_threads();
+    if (nthreads == 1 || n < PAR_MIN_N) {
+        pipe_sort_u128(a, n);
+        return;
+    }
+
+    const size_t nt = (size_t)nthreads;
+    split_ctx c;
+    c.team = psort_team_start(nthreads);
+    c.dh = (uint64_t*)malloc(nt * sizeof(uint64_t));
+    c.dl = (uint64_t*)malloc(nt * sizeof(uint64_t));
+    c.zeros = (int*)malloc(nt * sizeof(int));
+    c.left_ones = (span*)malloc(nt * sizeof(span));
+    c.right_zeros = (span*)malloc(nt * sizeof(span));
+
+    size_t seeds_cap = 4 * nt;
+    size_t n_seeds = 0;
+    psort_task* seeds = (psort_task*)malloc(seeds_cap * sizeof(psort_task));
+
+    if (!c.team || !c.dh || !c.dl || !c.zeros || !c.left_ones || !c.right_zeros || !seeds) {
+        psort_team_stop(c.team);
+        free(c.dh); free(c.dl); free(c.zeros); free(c.left_ones); free(c.right_zeros);
+        free(seeds);
+        pipe_sort_u128(a, n);
+        return;
+    }
+
+    // Top phase: ranges big enough to keep every thread busy are split by the
+    // whole team; the rest seed the work stealing pool.
+    int split_min = n / nthreads;
+    if (split_min < PAR_MIN_N) split_min = PAR_MIN_N;
+
+    psort_task stack[TOP_STACK];
+    int sp = 0;
+    stack[sp++] = (psort_task){ 0, (size_t)n, 0 };
+
+    while (sp > 0) {
+        psort_task r = stack[--sp];
+        const int rn = (int)r.n;
+
+        if (rn >= split_min) {
+            const int split = parallel_split(&c, a + r.off, rn, nthreads);
+            if (split == 0) continue;
+            stack[sp++] = (psort_task){ r.off, (size_t)split, 0 };
+            stack[sp++] = (psort_task){ r.off + (size_t)split, (size_t)(rn - split), 0 };
+            continue;
+        }
+
+        if (n_seeds == seeds_cap) {
+            psort_task* ns = (psort_task*)realloc(seeds, 2 * seeds_cap * sizeof(psort_task));
+            if (!ns) {
+                pipe_sort_u128(a + r.off, rn);
+                continue;
+            }
+            seeds = ns;
+            seeds_cap *= 2;
+        }
+        seeds[n_seeds++] = r;
+    }
+
+    psort_pool_run(c.team, u128_task, a, seeds, n_seeds);
+
+    psort_team_stop(c.team);
+    free(c.dh);
+    free(c.dl);
+    free(c.zeros);
+    free(c.left_ones);
+    free(c.right_zeros);
+    free(seeds);
+}
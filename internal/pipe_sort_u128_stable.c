@@ -0,0 +1,154 @@
+#include "pipe_sort_u128_stable.h"
+#include "pipe_sort_u128.h"
+#include <string.h>
+
+// Ping-pong MSD radix sort:
+//   - OR-diff scan (u128_diff_scan) finds the highest differing bit, so a
+//     shared prefix of any length costs one pass, as in pipe_sort_u128
+//   - the digit is the `width` bits from there down: count, then a stable
+//     scatter into the other buffer
+//   - each bucket continues in the buffer it was scattered to; leaves
+//     (and all equal ranges) left in tmp are copied back once
+// Depth is at most 128 / 8 levels.
+
+#define STABLE_WIDE_BITS   11   // 2048 counters for ranges >= STABLE_WIDE_MIN
+#define STABLE_NARROW_BITS 8
+#define STABLE_WIDE_MIN    (1 << 16)
+#define INSERTION_CUTOFF   32
+
+typedef struct {
+    u128* a;              // final buffer
+    u128* t;              // scratch
+    unsigned char* va;    // payloads (NULL when vsz == 0)
+    unsigned char* vt;
+    size_t vsz;
+} stable_ctx;
+
+// `width` bits of k whose lowest is bit `lowbit` (0..127).
+static inline unsigned digit_u128(const u128* k, int lowbit, int width) {
+    uint64_t v;
+    if (lowbit >= 64)              v = k->hi >> (lowbit - 64);
+    else if (lowbit + width <= 64) v = k->lo >> lowbit;
+    else                           v = (k->lo >> lowbit) | (k->hi << (64 - lowbit));
+    return (unsigned)(v & ((1ULL << width) - 1));
+}
+
+#define KV_KEY u128
+#define KV_KEY_GT(x, y) (u128_cmp((x), (y)) > 0)
+#include "psort_kv.h"
+
+// Moves the range into the final buffer if it is in scratch.
+static void to_final(const stable_ctx* C, int off, int n, int in_a) {
+    if (in_a) return;
+    memcpy(C->a + off, C->t + off, (size_t)n * sizeof(u128));
+    if (C->vsz) memcpy(C->va + (size_t)off * C->vsz, C->vt + (size_t)off * C->vsz, (size_t)n * C->vsz);
+}
+
+// Stable: only strictly greater keys are moved past.
+static void leaf_sort(const stable_ctx* C, int off, int n, int in_a) {
+    to_final(C, off, n, in_a);
+    u128* a = C->a + off;
+
+    if (!C->vsz) {
+        for (int i = 1; i < n; i++) {
+            u128 key = a[i];
+            int j = i - 1;
+            while (j >= 0 && u128_cmp(&a[j], &key) > 0) {
+                a[j + 1] = a[j];
+                j--;
+            }
+            a[j + 1] = key;
+        }
+        return;
+    }
+
+    insertion_sort_kv(a, C->va + (size_t)off * C->vsz, n, C->vsz);
+}
+
+static void stable_rec(const stable_ctx* C, int off, int n, int in_a);
+
+static inline void stable_level(const stable_ctx* C, int off, int n, int in_a,
+                                int width, int* c) {
+    const u128* src = (in_a ? C->a : C->t) + off;
+    u128* dst = (in_a ? C->t : C->a) + off;
+
+    uint64_t diff_hi = 0, diff_lo = 0;
+    u128_diff_scan(src + 1, n - 1, src, &diff_hi, &diff_lo);
+    if ((diff_hi | diff_lo) == 0) {
+        to_final(C, off, n, in_a); // all equal: already in order
+        return;
+    }
+
+    const int top = u128_highest_diff_bit(diff_hi, diff_lo);
+    if (width > top + 1) width = top + 1;
+    const int lowbit = top - width + 1;
+    const int nb = 1 << width;
+
+    memset(c, 0, (size_t)nb * sizeof(int));
+    for (int i = 0; i < n; i++) c[digit_u128(&src[i], lowbit, width)]++;
+
+    int sum = 0;
+    for (int b = 0; b < nb; b++) {
+        const int cnt = c[b];
+        c[b] = sum;
+        sum += cnt;
+    }
+
+    if (!C->vsz) {
+        for (int i = 0; i < n; i++) dst[c[digit_u128(&src[i], lowbit, width)]++] = src[i];
+    } else {
+        const size_t vsz = C->vsz;
+        const unsigned char* vs = (in_a ? C->va : C->vt) + (size_t)off * vsz;
+        unsigned char* vd = (in_a ? C->vt : C->va) + (size_t)off * vsz;
+        for (int i = 0; i < n; i++) {
+            const int p = c[digit_u128(&src[i], lowbit, width)]++;
+            dst[p] = src[i];
+            memcpy(vd + (size_t)p * vsz, vs + (size_t)i * vsz, vsz);
+        }
+    }
+
+    // c[b] is now the end of bucket b; buckets live in the other buffer.
+    int start = 0;
+    for (int b = 0; b < nb; b++) {
+        const int end = c[b];
+        if (end > start) stable_rec(C, off + start, end - start, !in_a);
+        start = end;
+    }
+}
+
+// Only large ranges pay for the 8 KB counter frame.
+static void stable_level_wide(const stable_ctx* C, int off, int n, int in_a) {
+    int c[1 << STABLE_WIDE_BITS];
+    stable_level(C, off, n, in_a, STABLE_WIDE_BITS, c);
+}
+
+static void stable_level_narrow(const stable_ctx* C, int off, int n, int in_a) {
+    int c[1 << STABLE_NARROW_BITS];
+    stable_level(C, off, n, in_a, STABLE_NARROW_BITS, c);
+}
+
+static void stable_rec(const stable_ctx* C, int off, int n, int in_a) {
+    if (n <= INSERTION_CUTOFF) {
+        leaf_sort(C, off, n, in_a);
+        return;
+    }
+    if (n >= STABLE_WIDE_MIN) stable_level_wide(C, off, n, in_a);
+    else                      stable_level_narrow(C, off, n, in_a);
+}
+
+void pipe_sort_u128_stable(u128* keys, u128* tmp, int n) {
+    if (n <= 1) return;
+    const stable_ctx C = { keys, tmp, NULL, NULL, 0 };
+    stable_rec(&C, 0, n, 1);
+}
+
+void pipe_sort_u128_kv_stable(u128* keys, void* vals, u128* tmp, void* tmp_vals,
+                              int n, size_t val_size) {
+    if (n <= 1) return;
+    if (!vals || !tmp_vals || val_size == 0) {
+        pipe_sort_u128_stable(keys, tmp, n);
+        return;
+    }
+    const stable_ctx C = { keys, tmp, (unsigned char*)vals, (unsigned char*)tmp_vals, val_size };
+    stable_rec(&C, 0, n, 1);
+}
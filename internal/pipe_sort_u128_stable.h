@@ -0,0 +1,13 @@
+#pragma once
+#include <stddef.h>
+#include "u128.h"
+
+// Stable out of place sort. Each MSD level scatters the range from the
+// buffer it is in to the other one (keys <-> tmp), so there is no copy back;
+// leaves are finished with a stable insertion sort in keys. tmp: n keys.
+void pipe_sort_u128_stable(u128* keys, u128* tmp, int n);
+
+// Same, moving a payload of val_size bytes per key along (vals, tmp_vals:
+// n * val_size bytes). Equal keys keep their payloads in input order.
+void pipe_sort_u128_kv_stable(u128* keys, void* vals, u128* tmp, void* tmp_vals,
+                              int n, size_t val_size);
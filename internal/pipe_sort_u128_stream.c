@@ -0,0 +1,117 @@
+#include "pipe_sort_u128_merge.h"
+#include "pipe_sort_u128.h"
+#include "pipesort/pipesort.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A run is merged into its older neighbour while that one is at most
+// TIER_RATIO times larger, so sizes grow geometrically from old to new.
+#define TIER_RATIO 2
+
+typedef struct {
+    u128* keys;
+    size_t n;
+} u128_run;
+
+struct u128_stream {
+    u128_run* runs;   // oldest first
+    size_t nruns;
+    size_t cap;
+    size_t total;
+};
+
+u128_stream* u128_stream_create(void) {
+    return (u128_stream*)calloc(1, sizeof(u128_stream));
+}
+
+void u128_stream_destroy(u128_stream* s) {
+    if (!s) return;
+    for (size_t i = 0; i < s->nruns; i++) free(s->runs[i].keys);
+    free(s->runs);
+    free(s);
+}
+
+// Merge the two newest runs. Without memory for the result they simply stay
+// separate: finish merges them anyway.
+static int merge_top(u128_stream* s) {
+    u128_run* a = &s->runs[s->nruns - 2];
+    u128_run* b = &s->runs[s->nruns - 1];
+    u128* m = (u128*)malloc((a->n + b->n) * sizeof(u128));
+    if (!m) return 0;
+
+    u128_merge2(m, a->keys, a->n, b->keys, b->n);
+    free(a->keys);
+    free(b->keys);
+    a->keys = m;
+    a->n += b->n;
+    s->nruns--;
+    return 1;
+}
+
+int u128_stream_push(u128_stream* s, const u128* keys, size_t n) {
+    if (!s) return -1;
+    if (n == 0) return 0;
+
+    if (s->nruns == s->cap) {
+        const size_t cap = s->cap ? 2 * s->cap : 16;
+        u128_run* r = (u128_run*)realloc(s->runs, cap * sizeof(u128_run));
+        if (!r) return -1;
+        s->runs = r;
+        s->cap = cap;
+    }
+
+    u128* run = (u128*)malloc(n * sizeof(u128));
+    if (!run) return -1;
+    memcpy(run, keys, n * sizeof(u128));
+    if (n <= (size_t)INT_MAX) pipe_sort_u128(run, (int)n);
+    else                      psort_u((uint64_t*)run, n, 2); // u128 == 2 big endian limbs
+
+    s->runs[s->nruns].keys = run;
+    s->runs[s->nruns].n = n;
+    s->nruns++;
+    s->total += n;
+
+    while (s->nruns >= 2 &&
+           s->runs[s->nruns - 2].n <= TIER_RATIO * s->runs[s->nruns - 1].n) {
+        if (!merge_top(s)) break;
+    }
+    return 0;
+}
+
+size_t u128_stream_size(const u128_stream* s) {
+    return s ? s->total : 0;
+}
+
+void u128_stream_finish(const u128_stream* s, u128* out) {
+    if (!s || s->nruns == 0) return;
+
+    const u128* stack_runs[64];
+    size_t stack_lens[64];
+    const u128** runs = stack_runs;
+    size_t* lens = stack_lens;
+    if (s->nruns > 64) {
+        runs = (const u128**)malloc(s->nruns * sizeof(*runs));
+        lens = (size_t*)malloc(s->nruns * sizeof(*lens));
+    }
+
+    if (runs && lens) {
+        for (size_t i = 0; i < s->nruns; i++) {
+            runs[i] = s->runs[i].keys;
+            lens[i] = s->runs[i].n;
+        }
+        u128_merge_k(out, runs, lens, s->nruns);
+    } else {
+        // No memory for the run table: concatenate and sort.
+        size_t o = 0;
+        for (size_t i = 0; i < s->nruns; i++) {
+            memcpy(out + o, s->runs[i].keys, s->runs[i].n * sizeof(u128));
+            o += s->runs[i].n;
+        }
+        psort_u((uint64_t*)out, o, 2);
+    }
+
+    if (runs != stack_runs) free((void*)runs);
+    if (lens != stack_lens) free(lens);
+}
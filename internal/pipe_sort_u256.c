@@ -0,0 +1,131 @@
+#include "pipe_sort_u256.h"
+#include "psort_simd.h"
+#include "psort_tune.h"
+#include "psort_bits.h"
+#include <assert.h>
+
+// limb 3 = w3 ... limb 0 = w0
+static inline uint64_t limb_at_0_3(const u256* k, int limb0to3) {
+    switch (limb0to3) {
+        case 3: return k->w3;
+        case 2: return k->w2;
+        case 1: return k->w1;
+        default: return k->w0;
+    }
+}
+
+// Per limb OR of (a[i] ^ a[0]) over the range.
+static inline void diff_scan_u256(const u256* a, int n,
+                                  uint64_t* o3, uint64_t* o2, uint64_t* o1, uint64_t* o0) {
+    if (psort_simd_level() > PSORT_SIMD_SCALAR) {
+        uint64_t d[4] = { 0, 0, 0, 0 };
+        psort_simd_diff_scan((const uint64_t*)(a + 1), (size_t)(n - 1), 4,
+                             (const uint64_t*)a, 0, 4, d);
+        *o3 = d[0]; *o2 = d[1]; *o1 = d[2]; *o0 = d[3];
+        return;
+    }
+
+    const u256 b = a[0];
+    uint64_t d3 = 0, d2 = 0, d1 = 0, d0 = 0;
+
+    // Unrolled diff scan (hot loop): one 32-byte key per step, 4 OR chains
+    int i = 1;
+    for (; i + 1 < n; i += 2) {
+        d3 |= (a[i].w3 ^ b.w3) | (a[i+1].w3 ^ b.w3);
+        d2 |= (a[i].w2 ^ b.w2) | (a[i+1].w2 ^ b.w2);
+        d1 |= (a[i].w1 ^ b.w1) | (a[i+1].w1 ^ b.w1);
+        d0 |= (a[i].w0 ^ b.w0) | (a[i+1].w0 ^ b.w0);
+    }
+    for (; i < n; i++) {
+        d3 |= a[i].w3 ^ b.w3;
+        d2 |= a[i].w2 ^ b.w2;
+        d1 |= a[i].w1 ^ b.w1;
+        d0 |= a[i].w0 ^ b.w0;
+    }
+    *o3 = d3; *o2 = d2; *o1 = d1; *o0 = d0;
+}
+
+static inline void insertion_sort_u256(u256* a, int n) {
+    for (int i = 1; i < n; i++) {
+        u256 key = a[i];
+        int j = i - 1;
+        while (j >= 0 && u256_cmp(&a[j], &key) > 0) {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = key;
+    }
+}
+
+// limb is a constant at every call site (see partition_by_bit), so the limb
+// load is a fixed offset and there is no per element switch.
+static inline int partition_by_bit_limb(u256* a, int n, int limb, int shift) {
+    const uint64_t mask = 1ULL << shift;
+    int i = 0, j = n - 1;
+
+    while (i <= j) {
+        while (i <= j && (limb_at_0_3(&a[i], limb) & mask) == 0) i++;
+        while (i <= j && (limb_at_0_3(&a[j], limb) & mask) != 0) j--;
+        if (i < j) {
+            u256 tmp = a[i];
+            a[i] = a[j];
+            a[j] = tmp;
+            i++; j--;
+        }
+    }
+    return i;
+}
+
+static int partition_by_bit(u256* a, int n, int limb, int shift) {
+    if (psort_simd_level() >= PSORT_SIMD_AVX512) {
+        return (int)psort_simd_partition_bit((uint64_t*)a, (size_t)n, 4, (size_t)(3 - limb), shift);
+    }
+    switch (limb) {
+        case 3:  return partition_by_bit_limb(a, n, 3, shift);
+        case 2:  return partition_by_bit_limb(a, n, 2, shift);
+        case 1:  return partition_by_bit_limb(a, n, 1, shift);
+        default: return partition_by_bit_limb(a, n, 0, shift);
+    }
+}
+
+void pipe_sort_u256(u256* a, int n) {
+    const int INSERTION_CUTOFF = psort_tune_profile()->u256_cutoff;
+
+    while (n > INSERTION_CUTOFF) {
+        uint64_t d3, d2, d1, d0;
+        diff_scan_u256(a, n, &d3, &d2, &d1, &d0);
+
+        int limb;
+        uint64_t d;
+        if (d3)      { limb = 3; d = d3; }
+        else if (d2) { limb = 2; d = d2; }
+        else if (d1) { limb = 1; d = d1; }
+        else if (d0) { limb = 0; d = d0; }
+        else return; // all equal in this range
+
+        const int split = partition_by_bit(a, n, limb, 63 - psort_clz64(d));
+        assert(split > 0 && split < n);
+
+        const int left_n  = split;
+        const int right_n = n - split;
+
+        // Tail recursion elimination: recurse smaller side
+        if (left_n < right_n) {
+            pipe_sort_u256(a, left_n);
+            a += split;
+            n = right_n;
+        } else {
+            pipe_sort_u256(a + split, right_n);
+            n = left_n;
+        }
+    }
+
+    insertion_sort_u256(a, n);
+}
+
+int u256_is_sorted(const u256* a, int n) {
+    for (int i = 1; i < n; i++) {
+        if (u256_cmp(&a[i - 1], &a[i]) > 0) return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "u256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// In place key sort (w3..w0 ascending), bit partitioning as in pipe_sort_u128.
+void pipe_sort_u256(u256* a, int n);
+int  u256_is_sorted(const u256* a, int n);
+
+#ifdef __cplusplus
+}
+#endif
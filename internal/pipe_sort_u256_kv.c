@@ -0,0 +1,99 @@
+#include "pipe_sort_u256_kv.h"
+#include "psort_bits.h"
+#include "psort_tune.h"
+#include <string.h>
+#include <assert.h>
+
+// Bit partition sort (as in pipe_sort_u128) over 4 limbs, moving a payload
+// with every key. val_size is passed as a compile time constant for 4 and 8
+// byte payloads so the swaps in the hot loops are single loads/stores.
+
+// limb 3 = w3 ... limb 0 = w0
+static inline uint64_t limb_at_0_3(const u256* k, int limb0to3) {
+    switch (limb0to3) {
+        case 3: return k->w3;
+        case 2: return k->w2;
+        case 1: return k->w1;
+        default: return k->w0;
+    }
+}
+
+#define KV_KEY u256
+#define KV_KEY_GT(x, y) (u256_cmp((x), (y)) > 0)
+#include "psort_kv.h"
+
+static inline int partition_kv_impl(u256* a, unsigned char* v, int n, int limb, int shift, size_t vsz) {
+    const uint64_t mask = 1ULL << shift;
+    int i = 0, j = n - 1;
+
+    while (i <= j) {
+        while (i <= j && (limb_at_0_3(&a[i], limb) & mask) == 0) i++;
+        while (i <= j && (limb_at_0_3(&a[j], limb) & mask) != 0) j--;
+        if (i < j) {
+            swap_kv(a, v, i, j, vsz);
+            i++; j--;
+        }
+    }
+    return i;
+}
+
+static int partition_kv(u256* a, unsigned char* v, int n, int limb, int shift, size_t vsz) {
+    switch (vsz) {
+        case 8:  return partition_kv_impl(a, v, n, limb, shift, 8);
+        case 4:  return partition_kv_impl(a, v, n, limb, shift, 4);
+        default: return partition_kv_impl(a, v, n, limb, shift, vsz);
+    }
+}
+
+static void pipe_sort_u256_kv_rec(u256* a, unsigned char* v, int n, size_t vsz) {
+    const int INSERTION_CUTOFF = psort_tune_profile()->u256_cutoff;
+
+    while (n > INSERTION_CUTOFF) {
+        const u256 b = a[0];
+        uint64_t d3 = 0, d2 = 0, d1 = 0, d0 = 0;
+        for (int i = 1; i < n; i++) {
+            d3 |= a[i].w3 ^ b.w3;
+            d2 |= a[i].w2 ^ b.w2;
+            d1 |= a[i].w1 ^ b.w1;
+            d0 |= a[i].w0 ^ b.w0;
+        }
+
+        int limb;
+        uint64_t d;
+        if (d3)      { limb = 3; d = d3; }
+        else if (d2) { limb = 2; d = d2; }
+        else if (d1) { limb = 1; d = d1; }
+        else if (d0) { limb = 0; d = d0; }
+        else return; // all equal in this range
+
+        const int split = partition_kv(a, v, n, limb, 63 - psort_clz64(d), vsz);
+        assert(split > 0 && split < n);
+
+        const int left_n  = split;
+        const int right_n = n - split;
+
+        // Tail recursion elimination: recurse smaller side
+        if (left_n < right_n) {
+            pipe_sort_u256_kv_rec(a, v, left_n, vsz);
+            a += split;
+            v += (size_t)split * vsz;
+            n = right_n;
+        } else {
+            pipe_sort_u256_kv_rec(a + split, v + (size_t)split * vsz, right_n, vsz);
+            n = left_n;
+        }
+    }
+
+    insertion_sort_kv(a, v, n, vsz);
+}
+
+void pipe_sort_u256_kv(u256* a, void* vals, int n, size_t val_size) {
+    if (n <= 1) return;
+    unsigned char dummy = 0;
+    if (!vals || val_size == 0) {
+        // Keys only: a zero sized payload costs nothing to "move".
+        pipe_sort_u256_kv_rec(a, &dummy, n, 0);
+        return;
+    }
+    pipe_sort_u256_kv_rec(a, (unsigned char*)vals, n, val_size);
+}
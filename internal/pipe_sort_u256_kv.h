@@ -0,0 +1,15 @@
+#pragma once
+#include <stddef.h>
+#include "u256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sort keys ascending (w3..w0) and apply the same permutation to vals, a parallel
+// array of n elements of val_size bytes. Not stable (equal keys may swap payloads).
+void pipe_sort_u256_kv(u256* a, void* vals, int n, size_t val_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,8 @@
+#pragma once
+#include <stddef.h>
+#include "u256.h"
+
+// Merges of ascending arrays into out (which must not overlap the inputs).
+// Equal keys keep input order: a before b, runs[0] before runs[1] ...
+void u256_merge2(u256* out, const u256* a, size_t na, const u256* b, size_t nb);
+void u256_merge_k(u256* out, const u256* const* runs, const size_t* lens, size_t k);
@@ -0,0 +1,141 @@
+#include "u512.h"
+#include "psort_simd.h"
+#include "psort_tune.h"
+#include "psort_bits.h"
+#include <assert.h>
+
+// limb 7 = w7 ... limb 0 = w0
+static inline uint64_t limb_at_0_7(const u512* k, int limb0to7) {
+    switch (limb0to7) {
+        case 7: return k->w7;
+        case 6: return k->w6;
+        case 5: return k->w5;
+        case 4: return k->w4;
+        case 3: return k->w3;
+        case 2: return k->w2;
+        case 1: return k->w1;
+        default: return k->w0;
+    }
+}
+
+int u512_cmp(const u512* a, const u512* b) {
+    for (int l = 7; l >= 0; l--) {
+        const uint64_t x = limb_at_0_7(a, l);
+        const uint64_t y = limb_at_0_7(b, l);
+        if (x != y) return x < y ? -1 : 1;
+    }
+    return 0;
+}
+
+// d[l] = OR of (a[i] ^ a[0]) over the range for limb l (d[7] = w7).
+static inline void diff_scan_u512(const u512* a, int n, uint64_t d[8]) {
+    if (psort_simd_level() > PSORT_SIMD_SCALAR) {
+        uint64_t w[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+        psort_simd_diff_scan((const uint64_t*)(a + 1), (size_t)(n - 1), 8,
+                             (const uint64_t*)a, 0, 8, w);
+        for (int l = 0; l < 8; l++) d[l] = w[7 - l];
+        return;
+    }
+
+    const u512 b = a[0];
+    uint64_t d7 = 0, d6 = 0, d5 = 0, d4 = 0, d3 = 0, d2 = 0, d1 = 0, d0 = 0;
+
+    // Diff scan (hot loop): one cache line per key, 8 independent OR chains
+    for (int i = 1; i < n; i++) {
+        d7 |= a[i].w7 ^ b.w7;
+        d6 |= a[i].w6 ^ b.w6;
+        d5 |= a[i].w5 ^ b.w5;
+        d4 |= a[i].w4 ^ b.w4;
+        d3 |= a[i].w3 ^ b.w3;
+        d2 |= a[i].w2 ^ b.w2;
+        d1 |= a[i].w1 ^ b.w1;
+        d0 |= a[i].w0 ^ b.w0;
+    }
+    d[0] = d0; d[1] = d1; d[2] = d2; d[3] = d3;
+    d[4] = d4; d[5] = d5; d[6] = d6; d[7] = d7;
+}
+
+static inline void insertion_sort_u512(u512* a, int n) {
+    for (int i = 1; i < n; i++) {
+        u512 key = a[i];
+        int j = i - 1;
+        while (j >= 0 && u512_cmp(&a[j], &key) > 0) {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = key;
+    }
+}
+
+// limb is a constant at every call site (see partition_by_bit).
+static inline int partition_by_bit_limb(u512* a, int n, int limb, int shift) {
+    const uint64_t mask = 1ULL << shift;
+    int i = 0, j = n - 1;
+
+    while (i <= j) {
+        while (i <= j && (limb_at_0_7(&a[i], limb) & mask) == 0) i++;
+        while (i <= j && (limb_at_0_7(&a[j], limb) & mask) != 0) j--;
+        if (i < j) {
+            u512 tmp = a[i];
+            a[i] = a[j];
+            a[j] = tmp;
+            i++; j--;
+        }
+    }
+    return i;
+}
+
+static int partition_by_bit(u512* a, int n, int limb, int shift) {
+    if (psort_simd_level() >= PSORT_SIMD_AVX512) {
+        return (int)psort_simd_partition_bit((uint64_t*)a, (size_t)n, 8, (size_t)(7 - limb), shift);
+    }
+    switch (limb) {
+        case 7:  return partition_by_bit_limb(a, n, 7, shift);
+        case 6:  return partition_by_bit_limb(a, n, 6, shift);
+        case 5:  return partition_by_bit_limb(a, n, 5, shift);
+        case 4:  return partition_by_bit_limb(a, n, 4, shift);
+        case 3:  return partition_by_bit_limb(a, n, 3, shift);
+        case 2:  return partition_by_bit_limb(a, n, 2, shift);
+        case 1:  return partition_by_bit_limb(a, n, 1, shift);
+        default: return partition_by_bit_limb(a, n, 0, shift);
+    }
+}
+
+void pipe_sort_u512(u512* a, int n) {
+    // Moving 64-byte keys makes insertion sort dearer than for u128.
+    const int INSERTION_CUTOFF = psort_tune_profile()->u512_cutoff;
+
+    while (n > INSERTION_CUTOFF) {
+        uint64_t d[8];
+        diff_scan_u512(a, n, d);
+
+        int limb = 7;
+        while (limb >= 0 && d[limb] == 0) limb--;
+        if (limb < 0) return; // all equal in this range
+
+        const int split = partition_by_bit(a, n, limb, 63 - psort_clz64(d[limb]));
+        assert(split > 0 && split < n);
+
+        const int left_n  = split;
+        const int right_n = n - split;
+
+        // Tail recursion elimination: recurse smaller side
+        if (left_n < right_n) {
+            pipe_sort_u512(a, left_n);
+            a += split;
+            n = right_n;
+        } else {
+            pipe_sort_u512(a + split, right_n);
+            n = left_n;
+        }
+    }
+
+    insertion_sort_u512(a, n);
+}
+
+int u512_is_sorted(const u512* a, int n) {
+    for (int i = 1; i < n; i++) {
+        if (u512_cmp(&a[i - 1], &a[i]) > 0) return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,118 @@
+#include "psort_apply.h"
+
+#include <string.h>
+
+#define GATHER_DIST      16          // elements prefetched ahead (64 byte or smaller)
+#define GATHER_MIN_DIST  4           // wide elements: fewer, but at least this many
+#define GATHER_MAX_LINES 4           // lines prefetched per wide element
+#define GATHER_PF_WIDTH  32          // narrower elements: no software prefetch
+#define PERMUTE_MARK     0x80000000u // visited flag in idx
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PSORT_PREFETCH(p) __builtin_prefetch((p), 0, 0)
+#define APPLY_INLINE inline __attribute__((always_inline))
+#else
+#define PSORT_PREFETCH(p) ((void)(p))
+#define APPLY_INLINE inline
+#endif
+
+// About GATHER_DIST lines in flight whatever the width.
+static APPLY_INLINE size_t gather_dist(size_t width) {
+    const size_t lines = (width + 63) / 64;
+    const size_t d = GATHER_DIST / lines;
+    return d < GATHER_MIN_DIST ? GATHER_MIN_DIST : d;
+}
+
+// The first line is enough up to 64 bytes (the adjacent line prefetcher
+// fetches the rest); wider elements get their first GATHER_MAX_LINES lines.
+static APPLY_INLINE void prefetch_elem(const uint8_t* p, size_t width) {
+    PSORT_PREFETCH(p);
+    const size_t end = width < GATHER_MAX_LINES * 64 ? width : GATHER_MAX_LINES * 64;
+    for (size_t o = 64; o < end; o += 64) PSORT_PREFETCH(p + o);
+}
+
+// Narrow elements: the loads are independent and out of order execution
+// already overlaps their misses; a prefetch per element only costs issue
+// slots there (measured ~30% slower for 8 byte elements).
+static APPLY_INLINE void gather_w(uint8_t* out, const uint8_t* src, const uint32_t* idx,
+                                  size_t n, size_t width) {
+    size_t i = 0;
+    if (width >= GATHER_PF_WIDTH) {
+        const size_t dist = gather_dist(width);
+        for (; i + dist < n; i++) {
+            prefetch_elem(src + (size_t)idx[i + dist] * width, width);
+            memcpy(out + i * width, src + (size_t)idx[i] * width, width);
+        }
+    }
+    for (; i < n; i++) memcpy(out + i * width, src + (size_t)idx[i] * width, width);
+}
+
+void psort_gather(uint8_t* out, const uint8_t* src, const uint32_t* idx,
+                  size_t n, size_t width) {
+    if (width == 0) return;
+    // Constant widths turn the copies into plain loads and stores.
+    switch (width) {
+        case 4:  gather_w(out, src, idx, n, 4);  break;
+        case 8:  gather_w(out, src, idx, n, 8);  break;
+        case 16: gather_w(out, src, idx, n, 16); break;
+        case 32: gather_w(out, src, idx, n, 32); break;
+        case 64: gather_w(out, src, idx, n, 64); break;
+        default: gather_w(out, src, idx, n, width); break;
+    }
+}
+
+void psort_gather_columns(void* const* outs, const void* const* srcs,
+                          const size_t* widths, size_t ncols,
+                          const uint32_t* idx, size_t n) {
+    for (size_t b = 0; b < n; b += PSORT_GATHER_BLOCK) {
+        const size_t len = n - b < PSORT_GATHER_BLOCK ? n - b : PSORT_GATHER_BLOCK;
+        for (size_t c = 0; c < ncols; c++) {
+            psort_gather((uint8_t*)outs[c] + b * widths[c], (const uint8_t*)srcs[c],
+                         idx + b, len, widths[c]);
+        }
+    }
+}
+
+static APPLY_INLINE void swap_elem(uint8_t* a, uint8_t* b, size_t width) {
+    uint8_t t[64];
+    for (size_t o = 0; o < width; o += sizeof t) {
+        const size_t c = width - o < sizeof t ? width - o : sizeof t;
+        memcpy(t, a + o, c);
+        memcpy(a + o, b + o, c);
+        memcpy(b + o, t, c);
+    }
+}
+
+// Cycle i -> idx[i] -> idx[idx[i]] ...: swapping slot j with its source k
+// fills j and carries the old data[i] along to k; when the cycle closes, it
+// sits in the slot whose source is i.
+static APPLY_INLINE void permute_w(uint8_t* data, uint32_t* idx, size_t n, size_t width) {
+    for (size_t i = 0; i < n; i++) {
+        if (idx[i] & PERMUTE_MARK) continue;
+        size_t j = i, k = idx[i];
+        idx[i] |= PERMUTE_MARK;
+        while (k != i) {
+            const uint32_t next = idx[k];
+            if (next & PERMUTE_MARK) break; // not a permutation
+            PSORT_PREFETCH(data + (size_t)next * width);
+            PSORT_PREFETCH(&idx[next]);
+            swap_elem(data + j * width, data + k * width, width);
+            idx[k] = next | PERMUTE_MARK;
+            j = k;
+            k = next;
+        }
+    }
+    for (size_t i = 0; i < n; i++) idx[i] &= ~PERMUTE_MARK;
+}
+
+void psort_permute_inplace(uint8_t* data, uint32_t* idx, size_t n, size_t width) {
+    if (width == 0) return;
+    switch (width) {
+        case 4:  permute_w(data, idx, n, 4);  break;
+        case 8:  permute_w(data, idx, n, 8);  break;
+        case 16: permute_w(data, idx, n, 16); break;
+        case 32: permute_w(data, idx, n, 32); break;
+        case 64: permute_w(data, idx, n, 64); break;
+        default: permute_w(data, idx, n, width); break;
+    }
+}
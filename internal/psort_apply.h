@@ -0,0 +1,39 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Apply the permutation produced by an index sort: element i of the result
+// is element idx[i] of the source. Elements are `width` bytes (any width;
+// 4, 8, 16, 32 and 64 get fixed size copies). idx must be a permutation of
+// 0..n-1.
+
+// Out of place gather, output written sequentially. Sources of 32 bytes and
+// more are prefetched about 16 lines ahead so their misses overlap; narrower
+// ones are left to out of order execution.
+void psort_gather(uint8_t* out, const uint8_t* src, const uint32_t* idx,
+                  size_t n, size_t width);
+
+// The same permutation applied to several columns (key array plus parallel
+// payload arrays). idx is walked in blocks of PSORT_GATHER_BLOCK entries and
+// every column is gathered for a block before moving on, so idx is read
+// from memory once instead of once per column.
+#define PSORT_GATHER_BLOCK 4096
+
+void psort_gather_columns(void* const* outs, const void* const* srcs,
+                          const size_t* widths, size_t ncols,
+                          const uint32_t* idx, size_t n);
+
+// In place, by following the cycles of idx and swapping along each one: no
+// second buffer, one swap per element. Visited entries are marked in
+// the top bit of idx (so n <= 2^31, as for the int index sorts) and the
+// marks are cleared at the end: idx is unchanged on return. An idx that is
+// not a permutation stops the cycle it breaks instead of looping.
+void psort_permute_inplace(uint8_t* data, uint32_t* idx, size_t n, size_t width);
+
+#ifdef __cplusplus
+}
+#endif
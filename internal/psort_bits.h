@@ -0,0 +1,37 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Bit fields of keys stored as 64-bit words, most significant word first
+// (the u128 / u256 / u512 layouts). Bits are numbered from the top of the
+// key: bit 0 is the MSB of word 0.
+
+// Leading zero bits of x (x != 0).
+static inline int psort_clz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while ((x & (1ULL << 63)) == 0) { n++; x <<= 1; }
+    return n;
+#endif
+}
+
+// `width` (1..64) bits starting at bit `pos`, right aligned. Bits past the
+// end of the key read as 0.
+static inline uint64_t psort_bits_at(const uint64_t* k, size_t limbs, size_t pos, int width) {
+    const size_t word = pos / 64;
+    const unsigned off = (unsigned)(pos % 64);
+    uint64_t v = k[word] << off;
+    if (off + (unsigned)width > 64 && word + 1 < limbs) v |= k[word + 1] >> (64 - off);
+    return v >> (64 - width);
+}
+
+// First bit where a and b differ; limbs * 64 if they are equal.
+static inline size_t psort_bits_first_diff(const uint64_t* a, const uint64_t* b, size_t limbs) {
+    for (size_t l = 0; l < limbs; l++) {
+        const uint64_t d = a[l] ^ b[l];
+        if (d) return l * 64 + (size_t)psort_clz64(d);
+    }
+    return limbs * 64;
+}
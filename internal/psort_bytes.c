@@ -0,0 +1,188 @@
+#include "psort_bytes.h"
+#include "psort_bits.h"
+#include <string.h>
+
+// Byte string keys are big endian numbers, so:
+//   - diff scans XOR raw 8 byte loads and byte swap only the OR-ed result
+//     (one bswap per chunk per range, none per key)
+//   - bit p (0 = MSB of byte 0) is bit 7 - p % 8 of byte p / 8: partitions
+//     test one byte, no load is swapped at all
+//   - radix digits are read with a byte swapped 8 byte load at byte p / 8
+// Leaves compare 8 byte big endian chunks, which is exactly memcmp order.
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PSORT_BYTES_INLINE inline __attribute__((always_inline))
+#else
+#define PSORT_BYTES_INLINE inline
+#endif
+
+#define BYTES_WINDOW 8      // 8 byte chunks folded per diff scan pass
+
+// ---------------- byte order ----------------
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+static inline uint64_t be64_to_host(uint64_t x) { return x; }
+#elif defined(__GNUC__) || defined(__clang__)
+static inline uint64_t be64_to_host(uint64_t x) { return __builtin_bswap64(x); }
+#else
+static inline uint64_t be64_to_host(uint64_t x) {
+    uint64_t r = 0;
+    for (int i = 0; i < 8; i++) { r = (r << 8) | (x & 0xFF); x >>= 8; }
+    return r;
+}
+#endif
+
+static inline uint64_t load_raw(const uint8_t* p) {
+    uint64_t x;
+    memcpy(&x, p, 8);
+    return x;
+}
+
+// Up to 8 bytes at p as a big endian number; bytes past `avail` read as 0.
+static inline uint64_t load_be(const uint8_t* p, size_t avail) {
+    if (avail >= 8) return be64_to_host(load_raw(p));
+    uint64_t x = 0;
+    for (size_t i = 0; i < avail; i++) x |= (uint64_t)p[i] << (56 - 8 * i);
+    return x;
+}
+
+static PSORT_BYTES_INLINE void swap_key(uint8_t* a, uint8_t* b, size_t width) {
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8) {
+        const uint64_t x = load_raw(a + i);
+        const uint64_t y = load_raw(b + i);
+        memcpy(a + i, &y, 8);
+        memcpy(b + i, &x, 8);
+    }
+    for (; i < width; i++) {
+        const uint8_t t = a[i];
+        a[i] = b[i];
+        b[i] = t;
+    }
+}
+
+// 1 if key a > key b; bytes before `from` are equal. Equivalent to
+// memcmp(a, b, width) > 0, but inlined 8 bytes at a time.
+static PSORT_BYTES_INLINE int key_gt(const uint8_t* a, const uint8_t* b, size_t from, size_t width) {
+    for (size_t i = from & ~(size_t)7; i < width; i += 8) {
+        const uint64_t x = load_be(a + i, width - i);
+        const uint64_t y = load_be(b + i, width - i);
+        if (x != y) return x > y;
+    }
+    return 0;
+}
+
+// ---------------- in place sort ----------------
+//
+// The shared psort_inplace.h engine with keys `width` bytes apart; a range
+// remembers the byte of its split bit.
+
+typedef struct {
+    size_t width;
+} ip_keys;
+
+static inline size_t ip_key_bits(const ip_keys* K) { return K->width * 8; }
+static inline size_t ip_step(const ip_keys* K) { return K->width; }
+static inline size_t ip_unit(const ip_keys* K, size_t bit) { (void)K; return bit / 8; }
+
+static PSORT_BYTES_INLINE unsigned ip_bit(const ip_keys* K, const uint8_t* k, size_t bit) {
+    (void)K;
+    return (unsigned)(k[bit / 8] >> (7 - bit % 8)) & 1u;
+}
+
+static PSORT_BYTES_INLINE void ip_swap(const ip_keys* K, uint8_t* a, uint8_t* b) {
+    swap_key(a, b, K->width);
+}
+
+static PSORT_BYTES_INLINE int ip_key_gt(const ip_keys* K, const uint8_t* a, const uint8_t* b,
+                                        size_t top) {
+    return key_gt(a, b, top, K->width);
+}
+
+// Highest bit where keys[1..n) differ from keys[0], scanning from byte
+// `top` (bytes before it are shared by the range). Returns 0 if all keys
+// are equal, else sets *bit.
+static PSORT_BYTES_INLINE int ip_diff_scan(const ip_keys* K, const uint8_t* keys, size_t n,
+                                           size_t top, size_t* bit) {
+    const size_t width = K->width;
+    for (size_t w = top & ~(size_t)7; w < width; w += 8 * BYTES_WINDOW) {
+        const size_t span = width - w < 8 * BYTES_WINDOW ? width - w : 8 * BYTES_WINDOW;
+        const size_t full = span / 8;
+        uint64_t d[BYTES_WINDOW] = {0, 0, 0, 0, 0, 0, 0, 0};
+        uint64_t tail = 0;
+        const uint8_t* b = keys + w;
+
+        for (size_t i = 1; i < n; i++) {
+            const uint8_t* k = keys + i * width + w;
+            for (size_t c = 0; c < full; c++) d[c] |= load_raw(k + 8 * c) ^ load_raw(b + 8 * c);
+            if (span % 8) tail |= load_be(k + 8 * full, span % 8) ^ load_be(b + 8 * full, span % 8);
+        }
+
+        for (size_t c = 0; c < full; c++) {
+            if (d[c]) {
+                *bit = 8 * (w + 8 * c) + (size_t)psort_clz64(be64_to_host(d[c]));
+                return 1;
+            }
+        }
+        if (tail) {
+            *bit = 8 * (w + 8 * full) + (size_t)psort_clz64(tail);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#include "psort_inplace.h"
+
+static PSORT_BYTES_INLINE void bytes_sort(uint8_t* keys, size_t n, size_t width) {
+    const ip_keys K = { width };
+    inplace_sort(&K, keys, n);
+}
+
+static void bytes_sort_generic(uint8_t* keys, size_t n, size_t width) {
+    bytes_sort(keys, n, width);
+}
+
+void psort_bytes_sort(uint8_t* keys, size_t n, size_t width) {
+    if (!keys || n <= 1 || width == 0) return;
+
+    // Common digest widths get a copy of the engine with `width` constant.
+    switch (width) {
+        case 16: bytes_sort(keys, n, 16); break;
+        case 20: bytes_sort(keys, n, 20); break;
+        case 32: bytes_sort(keys, n, 32); break;
+        case 64: bytes_sort(keys, n, 64); break;
+        default: bytes_sort_generic(keys, n, width); break;
+    }
+}
+
+// ---------------- index sort ----------------
+//
+// The shared adaptive radix engine with byte string digits.
+
+typedef struct {
+    const uint8_t* keys;
+    size_t width;
+} idx_keys;
+
+static inline size_t idx_key_bits(const idx_keys* K) { return K->width * 8; }
+
+// `w` (<= 11) bits starting at bit `pos` (from the top of the key).
+static inline unsigned idx_digit(const idx_keys* K, uint32_t id, size_t pos, int w) {
+    const size_t b = pos / 8;
+    const uint64_t v = load_be(K->keys + (size_t)id * K->width + b, K->width - b) << (pos % 8);
+    return (unsigned)(v >> (64 - w));
+}
+
+static inline int idx_key_gt(const idx_keys* K, uint32_t a, uint32_t b, size_t pos) {
+    return key_gt(K->keys + (size_t)a * K->width, K->keys + (size_t)b * K->width, pos / 8, K->width);
+}
+
+#include "psort_idx_radix.h"
+
+void psort_bytes_index_sort(uint32_t* idx, uint32_t* tmp, const uint8_t* keys,
+                            int n, size_t width) {
+    if (!idx || !tmp || !keys || n <= 1 || width == 0) return;
+    const idx_keys K = { keys, width };
+    idx_radix_sort(idx, tmp, &K, n);
+}
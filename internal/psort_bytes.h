@@ -0,0 +1,24 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sorts of fixed width byte string keys (key i = bytes[i*width .. i*width+width)),
+// in memcmp order, e.g. raw SHA-256 digests. Bits are read straight from the
+// bytes: 8 byte loads are byte swapped on little endian hosts, so no pass
+// converts the keys to or from host endian limbs.
+
+// In place bit partition sort (same scheme as psort_u).
+void psort_bytes_sort(uint8_t* keys, size_t n, size_t width);
+
+// Index sort: keys[idx[i]] ascending, stable. idx holds a permutation of
+// 0..n-1, tmp has n entries. Adaptive MSD radix (11 down to 4 bit digits).
+void psort_bytes_index_sort(uint32_t* idx, uint32_t* tmp, const uint8_t* keys,
+                            int n, size_t width);
+
+#ifdef __cplusplus
+}
+#endif
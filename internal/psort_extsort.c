@@ -0,0 +1,445 @@
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+#include "psort_extsort.h"
+#include "pipe_sort_u128.h"
+#include "pipe_sort_u256.h"
+#include "psort_loser_tree.h"
+#include "u512.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define EXT_MIN_BUDGET (1u << 20)   // smaller budgets are raised to this
+#define EXT_MIN_STREAM (64u << 10)  // smallest buffer per merge input / output half
+
+// ---------------- byte order ----------------
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+static inline uint64_t be64_to_host(uint64_t x) { return x; }
+#elif defined(__GNUC__) || defined(__clang__)
+static inline uint64_t be64_to_host(uint64_t x) { return __builtin_bswap64(x); }
+#else
+static inline uint64_t be64_to_host(uint64_t x) {
+    uint64_t r = 0;
+    for (int i = 0; i < 8; i++) { r = (r << 8) | (x & 0xFF); x >>= 8; }
+    return r;
+}
+#endif
+
+// File keys are big endian byte strings, in memory keys are big endian limb
+// order of host order words: the conversion is a per word swap (its own inverse).
+static void swap_words(uint64_t* w, size_t nwords) {
+    for (size_t i = 0; i < nwords; i++) w[i] = be64_to_host(w[i]);
+}
+
+static inline uint64_t load_be64(const unsigned char* p) {
+    uint64_t x;
+    memcpy(&x, p, 8);
+    return be64_to_host(x);
+}
+
+// Runs stay in file (big endian) format, so merge compares limb by limb.
+static inline int key_cmp(const unsigned char* a, const unsigned char* b, size_t limbs) {
+    for (size_t l = 0; l < limbs; l++) {
+        const uint64_t x = load_be64(a + 8 * l);
+        const uint64_t y = load_be64(b + 8 * l);
+        if (x != y) return x < y ? -1 : 1;
+    }
+    return 0;
+}
+
+// ---------------- I/O ----------------
+
+static int read_full(int fd, void* buf, size_t len, off_t off) {
+    unsigned char* p = (unsigned char*)buf;
+    while (len > 0) {
+        const ssize_t r = pread(fd, p, len, off);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) {
+            if (r == 0) errno = EIO; // file shrank under us
+            return -1;
+        }
+        p += r;
+        off += (off_t)r;
+        len -= (size_t)r;
+    }
+    return 0;
+}
+
+static int write_full(int fd, const void* buf, size_t len, off_t off) {
+    const unsigned char* p = (const unsigned char*)buf;
+    while (len > 0) {
+        const ssize_t r = pwrite(fd, p, len, off);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) return -1;
+        p += r;
+        off += (off_t)r;
+        len -= (size_t)r;
+    }
+    return 0;
+}
+
+// One read or write running on a helper thread. If the thread cannot be
+// started the job runs synchronously.
+typedef struct {
+    int fd;
+    void* buf;
+    size_t len;
+    off_t off;
+    int is_write;
+    int err;        // errno of a failed job, else 0
+    pthread_t th;
+    int running;
+} io_job;
+
+static void* io_job_main(void* p) {
+    io_job* j = (io_job*)p;
+    const int r = j->is_write ? write_full(j->fd, j->buf, j->len, j->off)
+                              : read_full(j->fd, j->buf, j->len, j->off);
+    j->err = r ? errno : 0;
+    return NULL;
+}
+
+static void io_start(io_job* j, int fd, void* buf, size_t len, off_t off, int is_write) {
+    j->fd = fd;
+    j->buf = buf;
+    j->len = len;
+    j->off = off;
+    j->is_write = is_write;
+    j->err = 0;
+    j->running = pthread_create(&j->th, NULL, io_job_main, j) == 0;
+    if (!j->running) io_job_main(j);
+}
+
+// Waits for the job; returns its errno (0 = ok).
+static int io_wait(io_job* j) {
+    if (j->running) {
+        pthread_join(j->th, NULL);
+        j->running = 0;
+    }
+    return j->err;
+}
+
+static int open_temp(const char* dir) {
+    if (!dir) dir = getenv("TMPDIR");
+    if (!dir || !*dir) dir = "/tmp";
+
+    const size_t len = strlen(dir) + sizeof("/psort_run_XXXXXX");
+    char* path = (char*)malloc(len);
+    if (!path) return -1;
+    snprintf(path, len, "%s/psort_run_XXXXXX", dir);
+
+    const int fd = mkstemp(path);
+    if (fd >= 0) unlink(path); // reclaimed on close, even after a crash
+    free(path);
+    return fd;
+}
+
+// ---------------- run generation ----------------
+
+typedef struct {
+    off_t off;      // byte offset in the run file
+    uint64_t n;     // keys
+} ext_run;
+
+static void sort_chunk(unsigned char* buf, size_t n, size_t key_bytes) {
+    swap_words((uint64_t*)buf, n * (key_bytes / 8));
+    switch (key_bytes) {
+        case 16: pipe_sort_u128_parallel((u128*)buf, (int)n, 0); break;
+        case 32: pipe_sort_u256((u256*)buf, (int)n); break;
+        default: pipe_sort_u512((u512*)buf, (int)n); break;
+    }
+    swap_words((uint64_t*)buf, n * (key_bytes / 8));
+}
+
+// Input -> sorted runs in run_fd. buf holds two chunks of chunk_keys keys:
+// chunk i + 1 is read while chunk i is sorted and written.
+static int make_runs(int in_fd, uint64_t total, size_t key_bytes,
+                     unsigned char* buf, size_t chunk_keys,
+                     int run_fd, ext_run* runs, size_t* nruns) {
+    unsigned char* cur = buf;
+    unsigned char* next = buf + chunk_keys * key_bytes;
+    uint64_t read_keys = 0;
+    off_t run_off = 0;
+    io_job rd;
+    size_t cur_n = (size_t)(total < chunk_keys ? total : chunk_keys);
+
+    if (read_full(in_fd, cur, cur_n * key_bytes, 0)) return -1;
+    read_keys = cur_n;
+    *nruns = 0;
+
+    while (cur_n > 0) {
+        const uint64_t left = total - read_keys;
+        const size_t next_n = (size_t)(left < chunk_keys ? left : chunk_keys);
+        if (next_n > 0) {
+            io_start(&rd, in_fd, next, next_n * key_bytes,
+                     (off_t)(read_keys * key_bytes), 0);
+        }
+
+        sort_chunk(cur, cur_n, key_bytes);
+        int err = write_full(run_fd, cur, cur_n * key_bytes, run_off) ? errno : 0;
+        runs[*nruns].off = run_off;
+        runs[*nruns].n = cur_n;
+        (*nruns)++;
+        run_off += (off_t)(cur_n * key_bytes);
+
+        if (next_n > 0) {
+            const int rerr = io_wait(&rd);
+            if (!err) err = rerr;
+        }
+        if (err) {
+            errno = err;
+            return -1;
+        }
+
+        read_keys += next_n;
+        unsigned char* t = cur;
+        cur = next;
+        next = t;
+        cur_n = next_n;
+    }
+    return 0;
+}
+
+// ---------------- k-way merge ----------------
+
+typedef struct {
+    unsigned char* buf;
+    size_t cap;     // keys
+    size_t len;     // keys in buf
+    size_t pos;     // next key in buf
+    off_t next;     // file offset of the next unread key
+    uint64_t left;  // keys not yet read
+} ext_stream;
+
+static inline int stream_done(const ext_stream* s) {
+    return s->pos == s->len && s->left == 0;
+}
+
+static int stream_fill(ext_stream* s, int fd, size_t key_bytes) {
+    const size_t n = (size_t)(s->left < s->cap ? s->left : s->cap);
+    if (read_full(fd, s->buf, n * key_bytes, s->next)) return -1;
+    s->next += (off_t)(n * key_bytes);
+    s->left -= n;
+    s->len = n;
+    s->pos = 0;
+#ifdef POSIX_FADV_WILLNEED
+    // Let the kernel fetch the following block while this one is merged.
+    if (s->left > 0) {
+        (void)posix_fadvise(fd, s->next, (off_t)(s->cap * key_bytes), POSIX_FADV_WILLNEED);
+    }
+#endif
+    return 0;
+}
+
+typedef struct {
+    const ext_stream* st;
+    size_t key_bytes;
+} stream_set;
+
+// Loser tree order: exhausted streams compare greater than everything; ties
+// go to the lower stream.
+static inline int stream_less(const void* p, int a, int b) {
+    const stream_set* S = (const stream_set*)p;
+    const ext_stream* st = S->st;
+    if (stream_done(&st[a])) return 0;
+    if (stream_done(&st[b])) return 1;
+    const int c = key_cmp(st[a].buf + st[a].pos * S->key_bytes,
+                          st[b].buf + st[b].pos * S->key_bytes, S->key_bytes / 8);
+    return c < 0 || (c == 0 && a < b);
+}
+
+// Merges runs[0..k) of in_fd into out_fd at out_off, using mem_bytes of mem
+// (k input buffers + 2 output halves).
+static int merge_runs(int in_fd, const ext_run* runs, size_t k,
+                      int out_fd, off_t out_off, size_t key_bytes,
+                      unsigned char* mem, size_t mem_bytes) {
+    const size_t per = mem_bytes / (k + 2) / key_bytes; // keys per buffer
+    ext_stream* st = (ext_stream*)malloc(k * sizeof(ext_stream));
+    int* tree = (int*)malloc(3 * k * sizeof(int)); // k losers + 2k build scratch
+    if (!st || !tree || per == 0) {
+        free(st);
+        free(tree);
+        if (per == 0) errno = EINVAL;
+        return -1;
+    }
+
+    int err = 0;
+    for (size_t i = 0; i < k && !err; i++) {
+        st[i].buf = mem + i * per * key_bytes;
+        st[i].cap = per;
+        st[i].len = st[i].pos = 0;
+        st[i].next = runs[i].off;
+        st[i].left = runs[i].n;
+#ifdef POSIX_FADV_SEQUENTIAL
+        (void)posix_fadvise(in_fd, runs[i].off, (off_t)(runs[i].n * key_bytes), POSIX_FADV_SEQUENTIAL);
+#endif
+        if (st[i].left > 0 && stream_fill(&st[i], in_fd, key_bytes)) err = errno;
+    }
+
+    const stream_set S = { st, key_bytes };
+    if (!err) psort_lt_build(tree, tree + k, k, stream_less, &S);
+
+    unsigned char* out[2] = { mem + k * per * key_bytes, mem + (k + 1) * per * key_bytes };
+    int half = 0;
+    size_t fill = 0;
+    io_job wr;
+    int writing = 0;
+
+    while (!err) {
+        int w = tree[0];
+        if (stream_done(&st[w])) break;
+
+        ext_stream* s = &st[w];
+        memcpy(out[half] + fill * key_bytes, s->buf + s->pos * key_bytes, key_bytes);
+        fill++;
+        s->pos++;
+        if (s->pos == s->len && s->left > 0 && stream_fill(s, in_fd, key_bytes)) {
+            err = errno;
+            break;
+        }
+
+        if (fill == per) {
+            if (writing && (err = io_wait(&wr)) != 0) break;
+            io_start(&wr, out_fd, out[half], fill * key_bytes, out_off, 1);
+            writing = 1;
+            out_off += (off_t)(fill * key_bytes);
+            half ^= 1;
+            fill = 0;
+        }
+
+        psort_lt_replay(tree, k, w, stream_less, &S);
+    }
+
+    if (writing) {
+        const int werr = io_wait(&wr);
+        if (!err) err = werr;
+    }
+    if (!err && fill > 0 && write_full(out_fd, out[half], fill * key_bytes, out_off)) err = errno;
+
+    free(st);
+    free(tree);
+    if (err) {
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+// ---------------- driver ----------------
+
+int psort_ext_sort(const char* in_path, const char* out_path, size_t key_bytes,
+                   size_t mem_budget, const char* tmp_dir) {
+    if (!in_path || !out_path || (key_bytes != 16 && key_bytes != 32 && key_bytes != 64)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (mem_budget < EXT_MIN_BUDGET) mem_budget = EXT_MIN_BUDGET;
+
+    const int in_fd = open(in_path, O_RDONLY);
+    if (in_fd < 0) return -1;
+
+    struct stat sb;
+    if (fstat(in_fd, &sb)) {
+        close(in_fd);
+        return -1;
+    }
+    if (sb.st_size < 0 || (uint64_t)sb.st_size % key_bytes != 0) {
+        close(in_fd);
+        errno = EINVAL; // not a whole number of keys
+        return -1;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    (void)posix_fadvise(in_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    const uint64_t total = (uint64_t)sb.st_size / key_bytes;
+    size_t chunk_keys = mem_budget / 2 / key_bytes;       // two chunks in flight
+    if (chunk_keys > (size_t)INT_MAX) chunk_keys = (size_t)INT_MAX;
+
+    unsigned char* mem = NULL;
+    int run_fd = -1, out_fd = -1, err = 0;
+    ext_run* runs = NULL;
+    ext_run* next_runs = NULL;
+    size_t nruns = 0;
+
+    mem = (unsigned char*)malloc(mem_budget);
+    if (!mem) { err = errno; goto done; }
+
+    if (total <= mem_budget / key_bytes && total <= (uint64_t)INT_MAX) {
+        // Fits: one in memory sort, no temp files.
+        const size_t n = (size_t)total;
+        if (read_full(in_fd, mem, n * key_bytes, 0)) { err = errno; goto done; }
+        sort_chunk(mem, n, key_bytes);
+        out_fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out_fd < 0 || write_full(out_fd, mem, n * key_bytes, 0)) err = errno;
+        goto done;
+    }
+
+    const size_t max_runs = (size_t)((total + chunk_keys - 1) / chunk_keys);
+    runs = (ext_run*)malloc(max_runs * sizeof(ext_run));
+    next_runs = (ext_run*)malloc(max_runs * sizeof(ext_run));
+    run_fd = open_temp(tmp_dir);
+    if (!runs || !next_runs || run_fd < 0) { err = errno; goto done; }
+
+    if (make_runs(in_fd, total, key_bytes, mem, chunk_keys, run_fd, runs, &nruns)) {
+        err = errno;
+        goto done;
+    }
+
+    size_t fan_in = mem_budget / EXT_MIN_STREAM - 2;
+    if (fan_in < 2) fan_in = 2;
+
+    // Intermediate passes until one merge can take all runs.
+    while (nruns > fan_in) {
+        const int pass_fd = open_temp(tmp_dir);
+        if (pass_fd < 0) { err = errno; goto done; }
+
+        size_t m = 0;
+        off_t off = 0;
+        for (size_t g = 0; g < nruns && !err; g += fan_in) {
+            const size_t k = nruns - g < fan_in ? nruns - g : fan_in;
+            uint64_t n = 0;
+            for (size_t i = 0; i < k; i++) n += runs[g + i].n;
+            if (merge_runs(run_fd, runs + g, k, pass_fd, off, key_bytes, mem, mem_budget)) err = errno;
+            next_runs[m].off = off;
+            next_runs[m].n = n;
+            m++;
+            off += (off_t)(n * key_bytes);
+        }
+        close(run_fd);
+        run_fd = pass_fd;
+        if (err) goto done;
+
+        ext_run* t = runs;
+        runs = next_runs;
+        next_runs = t;
+        nruns = m;
+    }
+
+    out_fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0 || merge_runs(run_fd, runs, nruns, out_fd, 0, key_bytes, mem, mem_budget)) {
+        err = errno;
+    }
+
+done:
+    if (out_fd >= 0 && close(out_fd) && !err) err = errno;
+    if (run_fd >= 0) close(run_fd);
+    close(in_fd);
+    free(runs);
+    free(next_runs);
+    free(mem);
+    if (err) {
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// External memory sort of a file of fixed width big endian keys
+// (key_bytes = 16, 32 or 64) into out_path.
+//   - run generation: budget/2 byte chunks, read ahead on a helper thread
+//     while the previous chunk is sorted in memory and written to a run
+//   - merge: loser tree over up to budget / EXT_MIN_STREAM runs at a time
+//     (more runs: extra passes), run reads prefetched with fadvise, output
+//     double buffered and written by a helper thread
+// All buffers come from one mem_budget byte allocation (at least
+// EXT_MIN_BUDGET). Runs live in unlinked temp files under tmp_dir
+// (NULL: $TMPDIR, else /tmp). in_path may equal out_path.
+// Returns 0, or -1 with errno set.
+int psort_ext_sort(const char* in_path, const char* out_path, size_t key_bytes,
+                   size_t mem_budget, const char* tmp_dir);
+
+#ifdef __cplusplus
+}
+#endif
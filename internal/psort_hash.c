@@ -0,0 +1,127 @@
+#include "psort_hash.h"
+#include "psort_idx_words.h"
+#include "psort_scratch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint64_t pfx;   // leading word of keys[id]
+    uint32_t id;
+    uint32_t pad;
+} hash_entry;
+
+#define HASH_DIGIT_BITS 11
+#define HASH_BUCKETS    (1 << HASH_DIGIT_BITS)
+#define HASH_MAX_DIGITS 6       // 6 * 11 >= 64: the whole prefix
+#define HASH_SLACK_BITS 12      // bits past log2 n: ~n / 2^13 keys share them
+#define HASH_MIN_N      4096    // below this the adaptive radix is as fast
+#define HASH_RUN_INSERT 32      // longer equal prefix runs go to the radix engine
+
+// keys[a] < keys[b] on words 1..limbs (word 0 is known equal)
+static inline int less_tail(const uint64_t* keys, size_t limbs, uint32_t a, uint32_t b) {
+    const uint64_t* x = keys + (size_t)a * limbs;
+    const uint64_t* y = keys + (size_t)b * limbs;
+    for (size_t l = 1; l < limbs; l++) {
+        if (x[l] != y[l]) return x[l] < y[l];
+    }
+    return 0;
+}
+
+static int floor_log2(int n) {
+    int b = 0;
+    while ((n >> b) > 1) b++;
+    return b;
+}
+
+void psort_hash_index_sort(uint32_t* idx, uint32_t* tmp, const uint64_t* keys,
+                           int n, size_t limbs) {
+    if (n <= 1) return;
+    if (n < HASH_MIN_N) {
+        psort_words_index_sort(idx, tmp, keys, n, limbs);
+        return;
+    }
+    hash_entry* a = (hash_entry*)psort_scratch_get(2 * (size_t)n * sizeof(hash_entry));
+    int* cnt = (int*)psort_scratch_get(HASH_MAX_DIGITS * HASH_BUCKETS * sizeof(int));
+    if (!a || !cnt) {
+        psort_scratch_put(a); psort_scratch_put(cnt);
+        psort_words_index_sort(idx, tmp, keys, n, limbs);
+        return;
+    }
+    hash_entry* b = a + n;
+
+    // Digits cover the top `bits` bits; digit 0 is the most significant.
+    int digits = (floor_log2(n) + HASH_SLACK_BITS + HASH_DIGIT_BITS - 1) / HASH_DIGIT_BITS;
+    if (digits > HASH_MAX_DIGITS) digits = HASH_MAX_DIGITS;
+    int shift[HASH_MAX_DIGITS], width[HASH_MAX_DIGITS];
+    for (int d = 0; d < digits; d++) {
+        shift[d] = 64 - HASH_DIGIT_BITS * (d + 1);
+        width[d] = HASH_DIGIT_BITS;
+        if (shift[d] < 0) {
+            width[d] += shift[d];
+            shift[d] = 0;
+        }
+    }
+    const int bits = 64 - shift[digits - 1];
+    const uint64_t run_mask = bits >= 64 ? ~0ULL : ~((1ULL << (64 - bits)) - 1);
+
+    // Extract + every digit histogram in one pass.
+    memset(cnt, 0, (size_t)digits * HASH_BUCKETS * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        const uint64_t p = keys[(size_t)idx[i] * limbs];
+        a[i].pfx = p;
+        a[i].id = idx[i];
+        a[i].pad = 0;
+        for (int d = 0; d < digits; d++) {
+            cnt[d * HASH_BUCKETS + (int)((p >> shift[d]) & ((1ULL << width[d]) - 1))]++;
+        }
+    }
+
+    // LSD scatter, least significant digit first, ping-pong between a and b.
+    // A digit where every key falls in one bucket leaves the order unchanged.
+    for (int d = digits - 1; d >= 0; d--) {
+        int* c = cnt + d * HASH_BUCKETS;
+        const int nb = 1 << width[d];
+        const uint64_t mask = (1ULL << width[d]) - 1;
+        int sum = 0, single = 0;
+        for (int v = 0; v < nb; v++) {
+            const int k = c[v];
+            single |= k == n;
+            c[v] = sum;
+            sum += k;
+        }
+        if (single) continue;
+        for (int i = 0; i < n; i++) b[c[(a[i].pfx >> shift[d]) & mask]++] = a[i];
+        hash_entry* t = a; a = b; b = t;
+    }
+
+    for (int i = 0; i < n; i++) idx[i] = a[i].id;
+
+    // Runs sharing the sorted bits: order by the rest of the prefix, then the
+    // remaining words. Stable throughout, so equal keys keep idx order.
+    for (int s = 0; s < n;) {
+        const uint64_t top = a[s].pfx & run_mask;
+        int e = s + 1;
+        while (e < n && (a[e].pfx & run_mask) == top) e++;
+        if (e - s > HASH_RUN_INSERT) {
+            psort_words_index_sort(idx + s, tmp + s, keys, e - s, limbs);
+        } else if (e - s > 1) {
+            // prefix first (bits below the sorted ones), then the tail words
+            for (int i = s + 1; i < e; i++) {
+                const hash_entry x = a[i];
+                int j = i - 1;
+                while (j >= s && (a[j].pfx > x.pfx ||
+                                  (a[j].pfx == x.pfx && less_tail(keys, limbs, x.id, a[j].id)))) {
+                    a[j + 1] = a[j];
+                    j--;
+                }
+                a[j + 1] = x;
+            }
+            for (int i = s; i < e; i++) idx[i] = a[i].id;
+        }
+        s = e;
+    }
+
+    psort_scratch_put(cnt);
+    psort_scratch_put(a < b ? a : b);
+}
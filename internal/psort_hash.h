@@ -0,0 +1,26 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Index sort tuned for uniformly distributed keys (hashes, digests).
+// keys: n keys of `limbs` (4 or 8) 64-bit words, most significant first
+// (the u256 / u512 layouts). Same result as the radix index sorts (stable),
+// tmp must be length n.
+//
+// The leading word of every key is copied once into dense (prefix, index)
+// entries, which an LSD radix sorts on just enough top bits to separate n
+// random keys (log2 n + 12, in 11-bit digits, one histogram pass for all of
+// them). Only runs that still share those bits are then ordered at full
+// width: tiny runs by insertion, large ones (not hash like input) by the
+// adaptive radix engine. Allocates 2n 16-byte entries; without them, or for
+// small n, it runs the adaptive radix engine directly.
+void psort_hash_index_sort(uint32_t* idx, uint32_t* tmp, const uint64_t* keys,
+                           int n, size_t limbs);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,240 @@
+#include "psort_idx_words.h"
+#include "psort_parallel.h"
+#include "psort_tune.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Parallel driver for psort_words_index_sort. Ranges of at least n / nthreads
+// keys are split by the whole team, one digit level at a time (per thread
+// histograms, bucket major offsets); the buckets below that seed a work
+// stealing pool whose tasks keep splitting until POOL_GRAIN and finish with
+// the serial engine. Digit widths follow the profile, as in the serial sort.
+
+// Below this size threads cost more than they save: serial radix sort.
+#define PAR_MIN_N   (1 << 16)
+// Pool tasks at or below this size are finished by the serial radix sort.
+#define POOL_GRAIN  (1 << 14)
+#define PAR_WIDE_BITS 11
+
+static inline int digit_width(size_t limbs, size_t pos, int n) {
+    const int w = psort_tune_digit_width(psort_tune_profile(), limbs, n);
+    const size_t left = limbs * 64 - pos;
+    return left < (size_t)w ? (int)left : w;
+}
+
+typedef struct {
+    psort_team* team;
+    uint32_t* idx;
+    uint32_t* tmp;
+    const uint64_t* keys;
+    size_t limbs;
+    int n;
+    size_t pos;
+    int w;
+    int* c;            // per tid histograms of 1 << w counters (stride 1 << PAR_WIDE_BITS),
+                       // turned into per tid scatter positions
+} level_ctx;
+
+static inline int chunk_at(int n, int tid, int nt) {
+    return (int)((long long)n * tid / nt);
+}
+
+static inline int* hist_of(const level_ctx* L, int tid) {
+    return L->c + ((size_t)tid << PAR_WIDE_BITS);
+}
+
+static void phase_count(void* p, int tid, int nt) {
+    level_ctx* L = (level_ctx*)p;
+    const int lo = chunk_at(L->n, tid, nt);
+    const int hi = chunk_at(L->n, tid + 1, nt);
+    int* c = hist_of(L, tid);
+    memset(c, 0, ((size_t)1 << L->w) * sizeof(int));
+    psort_words_digit_count(L->idx + lo, L->keys, hi - lo, L->limbs, L->pos, L->w, c);
+}
+
+static void phase_scatter(void* p, int tid, int nt) {
+    level_ctx* L = (level_ctx*)p;
+    const int lo = chunk_at(L->n, tid, nt);
+    const int hi = chunk_at(L->n, tid + 1, nt);
+    psort_words_digit_scatter(L->idx + lo, L->tmp, L->keys, hi - lo, L->limbs, L->pos, L->w,
+                              hist_of(L, tid));
+}
+
+static void phase_copy(void* p, int tid, int nt) {
+    level_ctx* L = (level_ctx*)p;
+    const int lo = chunk_at(L->n, tid, nt);
+    const int hi = chunk_at(L->n, tid + 1, nt);
+    memcpy(L->idx + lo, L->tmp + lo, (size_t)(hi - lo) * sizeof(uint32_t));
+}
+
+// One digit level over idx[0..n) with the whole team.
+// Fills bucket sizes in c (1 << w) and returns the number of non empty
+// buckets; idx is only reordered when that number is > 1.
+static int parallel_level(level_ctx* L, int nt, int* c) {
+    const int nb = 1 << L->w;
+    psort_team_run(L->team, phase_count, L);
+
+    int nonempty = 0;
+    for (int b = 0; b < nb; b++) {
+        c[b] = 0;
+        for (int t = 0; t < nt; t++) c[b] += hist_of(L, t)[b];
+        nonempty += (c[b] != 0);
+    }
+    if (nonempty <= 1) return nonempty;
+
+    // Bucket major, thread minor offsets: keeps every bucket in input order.
+    int at = 0;
+    for (int b = 0; b < nb; b++) {
+        for (int t = 0; t < nt; t++) {
+            int* h = hist_of(L, t);
+            const int cnt = h[b];
+            h[b] = at;
+            at += cnt;
+        }
+    }
+
+    psort_team_run(L->team, phase_scatter, L);
+    psort_team_run(L->team, phase_copy, L);
+    return nonempty;
+}
+
+typedef struct {
+    uint32_t* idx;
+    uint32_t* tmp;
+    const uint64_t* keys;
+    size_t limbs;
+} job_ctx;
+
+static void idx_task(psort_pool* pool, int worker, psort_task t, void* ctx) {
+    const job_ctx* J = (const job_ctx*)ctx;
+    uint32_t* idx = J->idx + t.off;
+    uint32_t* tmp = J->tmp + t.off;
+    const int n = (int)t.n;
+    const size_t total = J->limbs * 64;
+    size_t pos = (size_t)t.aux;
+
+    while (n > POOL_GRAIN && pos < total) {
+        const int w = digit_width(J->limbs, pos, n);
+        const int nb = 1 << w;
+        int c[1 << PAR_WIDE_BITS];
+        memset(c, 0, (size_t)nb * sizeof(int));
+        psort_words_digit_count(idx, J->keys, n, J->limbs, pos, w, c);
+
+        int nonempty = 0;
+        for (int b = 0; b < nb && nonempty < 2; b++) nonempty += (c[b] != 0);
+        if (nonempty <= 1) {
+            pos += (size_t)w;
+            continue;
+        }
+
+        // c -> bucket starts; the scatter turns them into bucket ends.
+        int sum = 0;
+        for (int b = 0; b < nb; b++) {
+            const int cnt = c[b];
+            c[b] = sum;
+            sum += cnt;
+        }
+        psort_words_digit_scatter(idx, tmp, J->keys, n, J->limbs, pos, w, c);
+        memcpy(idx, tmp, (size_t)n * sizeof(uint32_t));
+
+        // Big buckets go back to the pool, small ones are finished here.
+        int start = 0;
+        for (int b = 0; b < nb; b++) {
+            const int sz = c[b] - start;
+            if (sz > POOL_GRAIN) {
+                psort_pool_push(pool, worker,
+                                (psort_task){ t.off + (size_t)start, (size_t)sz, (int)(pos + (size_t)w) });
+            } else if (sz > 1) {
+                psort_words_index_rec(idx + start, tmp + start, J->keys, sz, J->limbs, pos + (size_t)w);
+            }
+            start = c[b];
+        }
+        return;
+    }
+
+    psort_words_index_rec(idx, tmp, J->keys, n, J->limbs, pos);
+}
+
+static int grow_seeds(psort_task** seeds, size_t* cap) {
+    psort_task* ns = (psort_task*)realloc(*seeds, 2 * *cap * sizeof(psort_task));
+    if (!ns) return 0;
+    *seeds = ns;
+    *cap *= 2;
+    return 1;
+}
+
+void psort_words_index_parallel(uint32_t* idx, uint32_t* tmp, const uint64_t* keys, int n,
+                                size_t limbs, int nthreads) {
+    if (n <= 1) return;
+    if (nthreads <= 0) nthreads = psort_par_default_threads();
+    if (nthreads == 1 || n < PAR_MIN_N) {
+        psort_words_index_sort(idx, tmp, keys, n, limbs);
+        return;
+    }
+
+    // Top phase: digits of ranges that are large enough are counted and
+    // scattered by the whole team; smaller buckets seed the pool. The ranges
+    // on the stack are disjoint and at least split_min long.
+    int split_min = n / nthreads;
+    if (split_min < PAR_MIN_N) split_min = PAR_MIN_N;
+    const size_t stack_cap = (size_t)(n / split_min) + 1;
+    const size_t total = limbs * 64;
+
+    const size_t nt = (size_t)nthreads;
+    psort_team* team = psort_team_start(nthreads);
+    int* hist = (int*)malloc((nt << PAR_WIDE_BITS) * sizeof(int));
+    psort_task* stack = (psort_task*)malloc(stack_cap * sizeof(psort_task));
+    size_t seeds_cap = 8 * nt;
+    size_t n_seeds = 0;
+    psort_task* seeds = (psort_task*)malloc(seeds_cap * sizeof(psort_task));
+
+    if (!team || !hist || !stack || !seeds) {
+        psort_team_stop(team);
+        free(hist);
+        free(stack);
+        free(seeds);
+        psort_words_index_sort(idx, tmp, keys, n, limbs);
+        return;
+    }
+
+    size_t sp = 0;
+    stack[sp++] = (psort_task){ 0, (size_t)n, 0 };
+
+    while (sp > 0) {
+        psort_task r = stack[--sp];
+        const int rn = (int)r.n;
+        const size_t pos = (size_t)r.aux;
+
+        if (pos >= total) continue; // all keys equal
+        const int w = digit_width(limbs, pos, rn);
+        level_ctx L = { team, idx + r.off, tmp + r.off, keys, limbs, rn, pos, w, hist };
+        int c[1 << PAR_WIDE_BITS];
+        const int next = (int)(pos + (size_t)w);
+        if (parallel_level(&L, nthreads, c) <= 1) {
+            stack[sp++] = (psort_task){ r.off, r.n, next };
+            continue;
+        }
+        size_t off = r.off;
+        for (int b = 0; b < (1 << w); b++) {
+            if (c[b] >= split_min) {
+                stack[sp++] = (psort_task){ off, (size_t)c[b], next };
+            } else if (c[b] > 1) {
+                if (n_seeds < seeds_cap || grow_seeds(&seeds, &seeds_cap)) {
+                    seeds[n_seeds++] = (psort_task){ off, (size_t)c[b], next };
+                } else {
+                    psort_words_index_rec(idx + off, tmp + off, keys, c[b], limbs, (size_t)next);
+                }
+            }
+            off += (size_t)c[b];
+        }
+    }
+
+    job_ctx J = { idx, tmp, keys, limbs };
+    psort_pool_run(team, idx_task, &J, seeds, n_seeds);
+
+    psort_team_stop(team);
+    free(hist);
+    free(stack);
+    free(seeds);
+}
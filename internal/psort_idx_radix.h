@@ -0,0 +1,362 @@
+// Adaptive MSD radix index engine over any key layout: digit width 11, 8, 6,
+// then 4 bits as ranges shrink, and a level whose keys all share the digit
+// costs only the count pass. Leaf size and width thresholds come from the
+// profile (the u512_radix_ fields for 512-bit keys). Stable; tmp has n
+// entries. Random keys reach the leaves in 2-3 count+scatter+copy passes.
+//
+// Include once per translation unit, after defining the key accessor:
+//
+//   typedef struct { ... } idx_keys;
+//   // key length in bits
+//   static inline size_t idx_key_bits(const idx_keys* K);
+//   // `w` (<= 11) bits of key id starting at bit `pos` (0 = MSB)
+//   static inline unsigned idx_digit(const idx_keys* K, IDX_T id, size_t pos, int w);
+//   // key a > key b, given that the bits above `pos` are equal
+//   static inline int idx_key_gt(const idx_keys* K, IDX_T a, IDX_T b, size_t pos);
+//
+// Optional settings, also defined before the include:
+//
+//   IDX_T, IDX_N      index and count types (default uint32_t and int)
+//   IDX_SIMD_DIGITS   the accessor also has
+//       static inline void idx_digits(const idx_keys* K, const uint32_t* ids, int m,
+//                                     size_t pos, int w, uint16_t* out);
+//     a batch digit load (psort_simd_idx_digits) used on large levels when
+//     the CPU has AVX-512 gathers
+//   IDX_RADIX_SELECT  also define idx_radix_select
+//   IDX_RADIX_UNIQUE  also define idx_radix_unique
+//
+// The header then defines, with the accessor inlined into every pass:
+//
+//   // sort idx[0..n) on bits pos.. (the bits above are equal across it)
+//   static void idx_radix_rec(IDX_T* idx, IDX_T* tmp, const idx_keys* K, IDX_N n, size_t pos);
+//   static void idx_radix_sort(IDX_T* idx, IDX_T* tmp, const idx_keys* K, IDX_N n);
+//   // digit histogram of idx[0..n) added to c / stable scatter to dst[at[d]++]
+//   static void idx_digit_count(const IDX_T* idx, const idx_keys* K, IDX_N n,
+//                               size_t pos, int w, IDX_N* c);
+//   static void idx_digit_scatter(const IDX_T* idx, IDX_T* dst, const idx_keys* K,
+//                                 IDX_N n, size_t pos, int w, IDX_N* at);
+//   // digit width / leaf size for a range of n keys
+//   static int idx_width_for(const idx_keys* K, IDX_N n);
+//   static IDX_N idx_cutoff(const idx_keys* K);
+//   // select: keys[idx[k]] is the k-th smallest, smaller keys before it;
+//   // partial (partial != 0): idx[0..k) index the k smallest, ascending
+//   static void idx_radix_select(IDX_T* idx, IDX_T* tmp, const idx_keys* K,
+//                                IDX_N n, IDX_N k, int partial);
+//   // sort + deduplicate: idx[0..m) one index per distinct key (the first
+//   // in idx order), counts[g] (optional) its multiplicity; returns m
+//   static IDX_N idx_radix_unique(IDX_T* idx, IDX_T* tmp, const idx_keys* K,
+//                                 IDX_N n, uint32_t* counts);
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "psort_stats.h"
+#include "psort_tune.h"
+#ifdef IDX_SIMD_DIGITS
+#include "psort_simd.h"
+#endif
+
+#ifndef IDX_T
+#define IDX_T uint32_t
+#endif
+#ifndef IDX_N
+#define IDX_N int
+#endif
+
+#define IDX_WIDE_BITS   11   // largest digit (2048 counters)
+#define IDX_NARROW_BITS 4    // frames below this keep a 16 counter array
+#define IDX_SIMD_MIN    4096 // smaller levels keep the scalar loads
+#define IDX_SIMD_CHUNK  256
+
+static inline int idx_width_for(const idx_keys* K, IDX_N n) {
+    const int m = (size_t)n > (size_t)INT_MAX ? INT_MAX : (int)n;
+    return psort_tune_digit_width(psort_tune_profile(), idx_key_bits(K) / 64, m);
+}
+
+static inline IDX_N idx_cutoff(const idx_keys* K) {
+    return (IDX_N)psort_tune_radix_cutoff(psort_tune_profile(), idx_key_bits(K) / 64);
+}
+
+static inline void insertion_sort_idx(IDX_T* idx, const idx_keys* K, IDX_N n, size_t pos) {
+    PSORT_STAT_CLOCK(t_leaf);
+    for (IDX_N i = 1; i < n; i++) {
+        const IDX_T id = idx[i];
+        IDX_N j = i;
+        while (j > 0 && idx_key_gt(K, idx[j - 1], id, pos)) {
+            idx[j] = idx[j - 1];
+            j--;
+        }
+        idx[j] = id;
+    }
+    PSORT_STAT_CYCLES(cycles_leaf, t_leaf);
+    PSORT_STAT_LEAF(n);
+}
+
+static inline void idx_digit_count(const IDX_T* idx, const idx_keys* K, IDX_N n,
+                                   size_t pos, int w, IDX_N* c) {
+#ifdef IDX_SIMD_DIGITS
+    if (n >= IDX_SIMD_MIN && psort_simd_level() >= PSORT_SIMD_AVX512) {
+        uint16_t dig[IDX_SIMD_CHUNK];
+        for (IDX_N i = 0; i < n; i += IDX_SIMD_CHUNK) {
+            const int m = n - i < IDX_SIMD_CHUNK ? (int)(n - i) : IDX_SIMD_CHUNK;
+            idx_digits(K, idx + i, m, pos, w, dig);
+            for (int j = 0; j < m; j++) c[dig[j]]++;
+        }
+        return;
+    }
+#endif
+    for (IDX_N i = 0; i < n; i++) c[idx_digit(K, idx[i], pos, w)]++;
+}
+
+static inline void idx_digit_scatter(const IDX_T* idx, IDX_T* dst, const idx_keys* K,
+                                     IDX_N n, size_t pos, int w, IDX_N* at) {
+#ifdef IDX_SIMD_DIGITS
+    if (n >= IDX_SIMD_MIN && psort_simd_level() >= PSORT_SIMD_AVX512) {
+        uint16_t dig[IDX_SIMD_CHUNK];
+        for (IDX_N i = 0; i < n; i += IDX_SIMD_CHUNK) {
+            const int m = n - i < IDX_SIMD_CHUNK ? (int)(n - i) : IDX_SIMD_CHUNK;
+            idx_digits(K, idx + i, m, pos, w, dig);
+            for (int j = 0; j < m; j++) dst[at[dig[j]]++] = idx[i + j];
+        }
+        return;
+    }
+#endif
+    for (IDX_N i = 0; i < n; i++) {
+        const IDX_T id = idx[i];
+        dst[at[idx_digit(K, id, pos, w)]++] = id;
+    }
+}
+
+// Digit histogram of idx[0..n) into c (1 << w counters). Returns 1 if more
+// than one bucket is non empty.
+static inline int level_count(const IDX_T* idx, const idx_keys* K, IDX_N n,
+                              size_t pos, int w, IDX_N* c) {
+    PSORT_STAT_CLOCK(t_count);
+    const int nb = 1 << w;
+    memset(c, 0, (size_t)nb * sizeof(IDX_N));
+    idx_digit_count(idx, K, n, pos, w, c);
+
+    int nonempty = 0;
+    for (int b = 0; b < nb && nonempty < 2; b++) nonempty += (c[b] != 0);
+    PSORT_STAT_CYCLES(cycles_diff_scan, t_count);
+    PSORT_STAT_ADD(levels, 1);
+    PSORT_STAT_ADD(skipped_levels, nonempty < 2);
+    return nonempty > 1;
+}
+
+// Stable scatter of idx[0..n) by the digit counted in c, through tmp.
+// Counts -> bucket starts; the scatter turns them into bucket ends.
+static inline void level_scatter(IDX_T* idx, IDX_T* tmp, const idx_keys* K, IDX_N n,
+                                 size_t pos, int w, IDX_N* c) {
+    PSORT_STAT_CLOCK(t_scatter);
+    const int nb = 1 << w;
+    IDX_N sum = 0;
+    for (int b = 0; b < nb; b++) {
+        const IDX_N cnt = c[b];
+        c[b] = sum;
+        sum += cnt;
+    }
+    idx_digit_scatter(idx, tmp, K, n, pos, w, c);
+    memcpy(idx, tmp, (size_t)n * sizeof(IDX_T));
+    PSORT_STAT_CYCLES(cycles_scatter, t_scatter);
+    PSORT_STAT_ADD(partitions, 1);
+    PSORT_STAT_MOVE(2 * (uint64_t)n, sizeof(IDX_T)); // scatter + copy back
+}
+
+static void idx_radix_rec(IDX_T* idx, IDX_T* tmp, const idx_keys* K, IDX_N n, size_t pos);
+
+// One digit level from bit pos, then recurse into the buckets. Levels where
+// every key has the same digit only cost the count pass. c holds 1 << max_width
+// counters.
+static inline void radix_level(IDX_T* idx, IDX_T* tmp, const idx_keys* K,
+                               IDX_N n, size_t pos, int max_width, IDX_N* c) {
+    const size_t total = idx_key_bits(K);
+    for (;;) {
+        if (pos >= total) return; // all keys equal
+        const int w = total - pos < (size_t)max_width ? (int)(total - pos) : max_width;
+        if (!level_count(idx, K, n, pos, w, c)) {
+            pos += (size_t)w;
+            continue;
+        }
+        level_scatter(idx, tmp, K, n, pos, w, c);
+
+        // c[b] is now the end of bucket b.
+        const int nb = 1 << w;
+        IDX_N start = 0;
+        for (int b = 0; b < nb; b++) {
+            const IDX_N end = c[b];
+            if (end - start > 1) idx_radix_rec(idx + start, tmp + start, K, end - start, pos + (size_t)w);
+            start = end;
+        }
+        return;
+    }
+}
+
+// Only frames that use more than 4 bit digits pay for the wide counter array.
+static void radix_level_wide(IDX_T* idx, IDX_T* tmp, const idx_keys* K,
+                             IDX_N n, size_t pos, int w) {
+    IDX_N c[1 << IDX_WIDE_BITS];
+    radix_level(idx, tmp, K, n, pos, w, c);
+}
+
+static void radix_level_narrow(IDX_T* idx, IDX_T* tmp, const idx_keys* K,
+                               IDX_N n, size_t pos) {
+    IDX_N c[1 << IDX_NARROW_BITS];
+    radix_level(idx, tmp, K, n, pos, IDX_NARROW_BITS, c);
+}
+
+static void idx_radix_rec(IDX_T* idx, IDX_T* tmp, const idx_keys* K, IDX_N n, size_t pos) {
+    if (n <= 1) return;
+    if (n <= idx_cutoff(K)) {
+        insertion_sort_idx(idx, K, n, pos);
+        return;
+    }
+    PSORT_STAT_ENTER();
+    const int w = idx_width_for(K, n);
+    if (w > IDX_NARROW_BITS) radix_level_wide(idx, tmp, K, n, pos, w);
+    else                     radix_level_narrow(idx, tmp, K, n, pos);
+    PSORT_STAT_LEAVE();
+}
+
+static inline void idx_radix_sort(IDX_T* idx, IDX_T* tmp, const idx_keys* K, IDX_N n) {
+    idx_radix_rec(idx, tmp, K, n, 0);
+}
+
+#ifdef IDX_RADIX_SELECT
+// Same digit levels, but after a scatter only the bucket holding the target
+// position is refined; buckets past it are left as they are, buckets before
+// it are fully sorted for a partial sort. Expected O(n) for select and
+// O(n + k log k) for a partial sort.
+static void idx_radix_select(IDX_T* idx, IDX_T* tmp, const idx_keys* K,
+                             IDX_N n, IDX_N k, int partial) {
+    const size_t total = idx_key_bits(K);
+    const IDX_N cutoff = idx_cutoff(K);
+    IDX_N c[1 << IDX_WIDE_BITS];
+    size_t pos = 0;
+
+    for (;;) {
+        if (partial && k >= n) {
+            idx_radix_rec(idx, tmp, K, n, pos);
+            return;
+        }
+        if (n <= cutoff || pos >= total) {
+            insertion_sort_idx(idx, K, n, pos);
+            return;
+        }
+
+        int w = idx_width_for(K, n);
+        if ((size_t)w > total - pos) w = (int)(total - pos);
+        const size_t at = pos;
+        pos += (size_t)w;
+        if (!level_count(idx, K, n, at, w, c)) continue;
+        level_scatter(idx, tmp, K, n, at, w, c);
+
+        // c[b] is now the end of bucket b: find the one holding position t.
+        const IDX_N t = partial ? k - 1 : k;
+        IDX_N start = 0;
+        int b = 0;
+        for (; c[b] <= t; b++) {
+            const IDX_N end = c[b];
+            if (partial && end - start > 1) idx_radix_rec(idx + start, tmp + start, K, end - start, pos);
+            start = end;
+        }
+        idx += start;
+        tmp += start;
+        n = c[b] - start;
+        k -= start;
+    }
+}
+#endif
+
+#ifdef IDX_RADIX_UNIQUE
+// The sort with buckets visited in ascending order and each finished range
+// emitted straight into idx[0..w): one index per distinct key plus its
+// multiplicity. A range that runs out of digits is all equal and becomes one
+// group without another look at the keys; only insertion sort leaves compare
+// neighbours. w never passes the start of the current range.
+
+typedef struct {
+    IDX_T* idx;         // whole array (output is compacted to the front)
+    IDX_T* tmp;
+    const idx_keys* K;
+    uint32_t* counts;   // NULL: no counts
+    IDX_N w;            // groups emitted so far
+} unique_ctx;
+
+static inline void unique_emit(unique_ctx* u, IDX_T id, IDX_N cnt) {
+    u->idx[u->w] = id;
+    if (u->counts) u->counts[u->w] = (uint32_t)cnt;
+    u->w++;
+}
+
+static void unique_rec(unique_ctx* u, IDX_N off, IDX_N n, size_t pos);
+
+static inline void unique_level(unique_ctx* u, IDX_N off, IDX_N n, size_t pos, int max_width, IDX_N* c) {
+    const size_t total = idx_key_bits(u->K);
+    IDX_T* idx = u->idx + off;
+    for (;;) {
+        if (pos >= total) {
+            unique_emit(u, idx[0], n);
+            return;
+        }
+        const int w = total - pos < (size_t)max_width ? (int)(total - pos) : max_width;
+        if (!level_count(idx, u->K, n, pos, w, c)) {
+            pos += (size_t)w;
+            continue;
+        }
+        level_scatter(idx, u->tmp + off, u->K, n, pos, w, c);
+
+        const int nb = 1 << w;
+        IDX_N start = 0;
+        for (int b = 0; b < nb; b++) {
+            const IDX_N end = c[b];
+            if (end > start) unique_rec(u, off + start, end - start, pos + (size_t)w);
+            start = end;
+        }
+        return;
+    }
+}
+
+static void unique_level_wide(unique_ctx* u, IDX_N off, IDX_N n, size_t pos, int w) {
+    IDX_N c[1 << IDX_WIDE_BITS];
+    unique_level(u, off, n, pos, w, c);
+}
+
+static void unique_level_narrow(unique_ctx* u, IDX_N off, IDX_N n, size_t pos) {
+    IDX_N c[1 << IDX_NARROW_BITS];
+    unique_level(u, off, n, pos, IDX_NARROW_BITS, c);
+}
+
+static void unique_rec(unique_ctx* u, IDX_N off, IDX_N n, size_t pos) {
+    if (n == 1 || pos >= idx_key_bits(u->K)) {
+        unique_emit(u, u->idx[off], n);
+        return;
+    }
+    if (n <= idx_cutoff(u->K)) {
+        IDX_T* idx = u->idx + off;
+        insertion_sort_idx(idx, u->K, n, pos);
+        IDX_N g = 0;
+        for (IDX_N i = 1; i <= n; i++) {
+            if (i == n || idx_key_gt(u->K, idx[i], idx[g], pos)) {
+                unique_emit(u, idx[g], i - g);
+                g = i;
+            }
+        }
+        return;
+    }
+
+    const int w = idx_width_for(u->K, n);
+    if (w > IDX_NARROW_BITS) unique_level_wide(u, off, n, pos, w);
+    else                     unique_level_narrow(u, off, n, pos);
+}
+
+static IDX_N idx_radix_unique(IDX_T* idx, IDX_T* tmp, const idx_keys* K,
+                              IDX_N n, uint32_t* counts) {
+    if (n <= 0) return 0;
+    unique_ctx u = { idx, tmp, K, counts, 0 };
+    unique_rec(&u, 0, n, 0);
+    return u.w;
+}
+#endif
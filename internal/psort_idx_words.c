@@ -0,0 +1,89 @@
+#include "psort_idx_words.h"
+#include "psort_simd.h"
+
+// Key id is keys[id * limbs .. id * limbs + limbs); digits are read in place
+// and compared words start at the word holding `pos`.
+
+typedef struct {
+    const uint64_t* keys;
+    size_t limbs;
+} idx_keys;
+
+static inline size_t idx_key_bits(const idx_keys* K) { return K->limbs * 64; }
+
+static inline unsigned idx_digit(const idx_keys* K, uint32_t id, size_t pos, int w) {
+    const uint64_t* k = K->keys + (size_t)id * K->limbs;
+    const size_t word = pos / 64;
+    const unsigned off = (unsigned)(pos % 64);
+    uint64_t v = k[word] << off;
+    if (off + (unsigned)w > 64 && word + 1 < K->limbs) v |= k[word + 1] >> (64 - off);
+    return (unsigned)(v >> (64 - w));
+}
+
+static inline int idx_key_gt(const idx_keys* K, uint32_t a, uint32_t b, size_t pos) {
+    const uint64_t* x = K->keys + (size_t)a * K->limbs;
+    const uint64_t* y = K->keys + (size_t)b * K->limbs;
+    for (size_t l = pos / 64; l < K->limbs; l++) {
+        if (x[l] != y[l]) return x[l] > y[l];
+    }
+    return 0;
+}
+
+// psort_simd_idx_digits counts shifts from the bottom of a word and takes
+// straddling bits from the word before: locate the digit by its lowest bit.
+static inline void idx_digits(const idx_keys* K, const uint32_t* ids, int m,
+                              size_t pos, int w, uint16_t* out) {
+    const size_t low = pos + (size_t)w - 1;
+    psort_simd_idx_digits(ids, (size_t)m, K->keys, K->limbs, low / 64,
+                          63 - (int)(low % 64), w, out);
+}
+
+#define IDX_SIMD_DIGITS
+#define IDX_RADIX_SELECT
+#define IDX_RADIX_UNIQUE
+#include "psort_idx_radix.h"
+
+void psort_words_index_sort(uint32_t* idx, uint32_t* tmp, const uint64_t* keys, int n,
+                            size_t limbs) {
+    const idx_keys K = { keys, limbs };
+    idx_radix_sort(idx, tmp, &K, n);
+}
+
+void psort_words_index_rec(uint32_t* idx, uint32_t* tmp, const uint64_t* keys, int n,
+                           size_t limbs, size_t pos) {
+    const idx_keys K = { keys, limbs };
+    idx_radix_rec(idx, tmp, &K, n, pos);
+}
+
+void psort_words_index_select(uint32_t* idx, uint32_t* tmp, const uint64_t* keys, int n,
+                              size_t limbs, int k) {
+    if (n <= 1 || k < 0 || k >= n) return;
+    const idx_keys K = { keys, limbs };
+    idx_radix_select(idx, tmp, &K, n, k, 0);
+}
+
+void psort_words_index_partial(uint32_t* idx, uint32_t* tmp, const uint64_t* keys, int n,
+                               size_t limbs, int k) {
+    if (n <= 1 || k <= 0) return;
+    if (k > n) k = n;
+    const idx_keys K = { keys, limbs };
+    idx_radix_select(idx, tmp, &K, n, k, 1);
+}
+
+int psort_words_index_unique(uint32_t* idx, uint32_t* tmp, const uint64_t* keys, int n,
+                             size_t limbs, uint32_t* counts) {
+    const idx_keys K = { keys, limbs };
+    return idx_radix_unique(idx, tmp, &K, n, counts);
+}
+
+void psort_words_digit_count(const uint32_t* idx, const uint64_t* keys, int n,
+                             size_t limbs, size_t pos, int w, int* c) {
+    const idx_keys K = { keys, limbs };
+    idx_digit_count(idx, &K, n, pos, w, c);
+}
+
+void psort_words_digit_scatter(const uint32_t* idx, uint32_t* dst, const uint64_t* keys,
+                               int n, size_t limbs, size_t pos, int w, int* at) {
+    const idx_keys K = { keys, limbs };
+    idx_digit_scatter(idx, dst, &K, n, pos, w, at);
+}
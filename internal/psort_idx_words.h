@@ -0,0 +1,53 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Index sorts over keys of `limbs` 64-bit words, most significant first (the
+// u256 / u512 layouts): the psort_idx_radix.h engine with SIMD digit loads.
+// Bits are numbered from the top of the key (0 = MSB of word 0).
+
+// Sort indices so that keys[idx[i]] is in ascending order, tmp length n.
+// MSD radix, digit width chosen per level from the range size (4..11 bits).
+void psort_words_index_sort(uint32_t* idx, uint32_t* tmp, const uint64_t* keys, int n,
+                            size_t limbs);
+
+// Same, for a range whose keys share the bits above `pos`.
+void psort_words_index_rec(uint32_t* idx, uint32_t* tmp, const uint64_t* keys, int n,
+                           size_t limbs, size_t pos);
+
+// Selection on the same digit levels (idx holds a permutation, as above).
+// select: afterwards keys[idx[k]] is the k-th smallest key, idx[0..k) index
+// keys <= it and idx(k..n) keys >= it. Expected O(n).
+// partial: idx[0..k) index the k smallest keys in ascending order, the rest
+// of idx holds the other indices in no particular order. O(n + k log k).
+void psort_words_index_select(uint32_t* idx, uint32_t* tmp, const uint64_t* keys, int n,
+                              size_t limbs, int k);
+void psort_words_index_partial(uint32_t* idx, uint32_t* tmp, const uint64_t* keys, int n,
+                               size_t limbs, int k);
+
+// Sort + deduplicate in one pass: idx[0..m) gets one index per distinct key
+// (the first in idx order), ascending; counts[g] (optional, length n) the
+// multiplicity of group g. Returns m.
+int psort_words_index_unique(uint32_t* idx, uint32_t* tmp, const uint64_t* keys, int n,
+                             size_t limbs, uint32_t* counts);
+
+// One digit level, for drivers that split the work themselves: the `w` bit
+// digit at bit `pos` of keys[idx[0..n)] is counted into c (added), or each
+// index is stored at dst[at[digit]++] (stable).
+void psort_words_digit_count(const uint32_t* idx, const uint64_t* keys, int n,
+                             size_t limbs, size_t pos, int w, int* c);
+void psort_words_digit_scatter(const uint32_t* idx, uint32_t* dst, const uint64_t* keys,
+                               int n, size_t limbs, size_t pos, int w, int* at);
+
+// Multithreaded variant (nthreads <= 0 = all online CPUs). Same result as
+// the serial sort: the parallel scatter keeps each bucket in input order.
+void psort_words_index_parallel(uint32_t* idx, uint32_t* tmp, const uint64_t* keys, int n,
+                                size_t limbs, int nthreads);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,56 @@
+#include "psort_index64.h"
+#include "psort_idx_words.h"
+#include "psort_bits.h"
+#include "psort_tune.h"
+#include <limits.h>
+
+// The psort_idx_radix.h engine with uint64_t indices and size_t counts.
+// Key id is keys[id * limbs .. id * limbs + limbs), bits numbered from the
+// top (0 = MSB of word 0).
+
+typedef struct {
+    const uint64_t* keys;
+    size_t limbs;
+} idx_keys;
+
+static inline size_t idx_key_bits(const idx_keys* K) { return K->limbs * 64; }
+
+static inline unsigned idx_digit(const idx_keys* K, uint64_t id, size_t pos, int w) {
+    return (unsigned)psort_bits_at(K->keys + id * K->limbs, K->limbs, pos, w);
+}
+
+static inline int idx_key_gt(const idx_keys* K, uint64_t a, uint64_t b, size_t pos) {
+    const uint64_t* x = K->keys + a * K->limbs;
+    const uint64_t* y = K->keys + b * K->limbs;
+    for (size_t l = pos / 64; l < K->limbs; l++) {
+        if (x[l] != y[l]) return x[l] > y[l];
+    }
+    return 0;
+}
+
+#define IDX_T uint64_t
+#define IDX_N size_t
+#include "psort_idx_radix.h"
+
+void psort_index64_radix(uint64_t* idx, uint64_t* tmp, const uint64_t* keys,
+                         size_t n, size_t limbs) {
+    if (!idx || !tmp || !keys || n <= 1 || limbs == 0) return;
+    const idx_keys K = { keys, limbs };
+    idx_radix_sort(idx, tmp, &K, n);
+}
+
+void psort_index64_sort(uint64_t* idx, uint64_t* tmp, const uint64_t* keys,
+                        size_t n, size_t limbs) {
+    if (!idx || !tmp || !keys || n <= 1 || limbs == 0) return;
+    if (n > (size_t)INT_MAX) {
+        psort_index64_radix(idx, tmp, keys, n, limbs);
+        return;
+    }
+
+    // tmp (n * 8 bytes) holds both uint32_t arrays of the compact engine.
+    uint32_t* i32 = (uint32_t*)tmp;
+    uint32_t* t32 = i32 + n;
+    for (size_t i = 0; i < n; i++) i32[i] = (uint32_t)idx[i];
+    psort_words_index_sort(i32, t32, keys, (int)n, limbs);
+    for (size_t i = 0; i < n; i++) idx[i] = i32[i];
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Index sorts past the int / uint32_t limits of the psort_words_index_*
+// engines. keys: n keys of `limbs` 64-bit words, most significant word
+// first (u256 / u512 layout). idx holds a permutation of 0..n-1, tmp: n entries.
+
+// Sorts idx so that keys[idx[i]] is ascending (stable). When n <= INT_MAX the
+// indices are narrowed to uint32_t inside tmp and the uint32 engine
+// (psort_words_index_sort) runs, so the radix passes move half the bytes;
+// otherwise psort_index64_radix runs.
+void psort_index64_sort(uint64_t* idx, uint64_t* tmp, const uint64_t* keys,
+                        size_t n, size_t limbs);
+
+// The 64-bit engine itself: the shared MSD radix (11, 8, 6 or 4 bit digits
+// from the profile) with size_t counters; levels whose keys all share the
+// digit are skipped without a scatter.
+void psort_index64_radix(uint64_t* idx, uint64_t* tmp, const uint64_t* keys,
+                         size_t n, size_t limbs);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,172 @@
+// In place bit partition engine over keys stored at a fixed step (the psort_u
+// scheme): per range a bit probe or diff scan finds the highest bit that
+// varies, a block partition (Hoare below 2 * IP_BLOCK) splits on it, the
+// smaller side is sorted first and leaves of IP_SMALL keys or fewer are
+// insertion sorted.
+//
+// Include once per translation unit, after defining the key accessor. keys
+// points at key 0, key i is at keys + i * ip_step(K):
+//
+//   typedef struct { ... } ip_keys;
+//   // key length in bits; distance between keys in bytes
+//   static inline size_t ip_key_bits(const ip_keys* K);
+//   static inline size_t ip_step(const ip_keys* K);
+//   // unit (byte, word, ...) holding `bit`: ranges remember the unit of the
+//   // bit they were split on, everything before it is equal across them
+//   static inline size_t ip_unit(const ip_keys* K, size_t bit);
+//   // bit `bit` (0 = MSB) of key k, as 0 or 1
+//   static inline unsigned ip_bit(const ip_keys* K, const uint8_t* k, size_t bit);
+//   // swap the records holding keys a and b
+//   static inline void ip_swap(const ip_keys* K, uint8_t* a, uint8_t* b);
+//   // key a > key b, units before `top` are equal
+//   static inline int ip_key_gt(const ip_keys* K, const uint8_t* a, const uint8_t* b, size_t top);
+//   // highest bit where keys 1..n-1 differ from key 0, from unit `top` on;
+//   // 0 if all keys are equal, else 1 and *bit set
+//   static inline int ip_diff_scan(const ip_keys* K, const uint8_t* keys, size_t n,
+//                                  size_t top, size_t* bit);
+//
+// The header then defines
+//
+//   static inline void inplace_sort(const ip_keys* K, uint8_t* keys, size_t n);
+//
+// with every accessor inlined, so a caller passing a constant K gets a copy of
+// the engine specialized for it.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define IP_INLINE inline __attribute__((always_inline))
+#else
+#define IP_INLINE inline
+#endif
+
+#define IP_STACK 64     // smaller side first: pending ranges <= log2(n)
+#define IP_SMALL 16
+#define IP_BLOCK 128    // offsets per side buffer of the block partition
+
+// Early exit probe (as in psort_u): does the bit take both values in the range?
+static IP_INLINE int ip_bit_varies(const ip_keys* K, const uint8_t* keys, size_t n, size_t bit) {
+    const size_t step = ip_step(K);
+    const unsigned first = ip_bit(K, keys, bit);
+    for (size_t i = 1; i < n; i++) {
+        if (ip_bit(K, keys + i * step, bit) != first) return 1;
+    }
+    return 0;
+}
+
+static IP_INLINE size_t ip_hoare_partition(const ip_keys* K, uint8_t* keys, size_t n, size_t bit) {
+    const size_t step = ip_step(K);
+    size_t i = 0, j = n;
+    for (;;) {
+        while (i < j && ip_bit(K, keys + i * step, bit) == 0) i++;
+        while (i < j && ip_bit(K, keys + (j - 1) * step, bit) != 0) j--;
+        if (i >= j) break;
+        ip_swap(K, keys + i * step, keys + (j - 1) * step);
+        i++;
+        j--;
+    }
+    return i;
+}
+
+// psort_block_partition_bit over keys at a step: classify a block from each
+// end without branches, then swap the misplaced pairs in one batch.
+static IP_INLINE size_t ip_block_partition(const ip_keys* K, uint8_t* keys, size_t n, size_t bit) {
+    const size_t step = ip_step(K);
+    uint8_t off_l[IP_BLOCK], off_r[IP_BLOCK];
+    size_t l = 0, r = n;
+    size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+    while (r - l > 2 * IP_BLOCK) {
+        if (num_l == 0) {
+            start_l = 0;
+            const uint8_t* k = keys + l * step;
+            for (size_t i = 0; i < IP_BLOCK; i++) {
+                off_l[num_l] = (uint8_t)i;
+                num_l += (size_t)ip_bit(K, k + i * step, bit);
+            }
+        }
+        if (num_r == 0) {
+            start_r = 0;
+            const uint8_t* k = keys + (r - 1) * step;
+            for (size_t i = 0; i < IP_BLOCK; i++) {
+                off_r[num_r] = (uint8_t)i;
+                num_r += (size_t)(ip_bit(K, k - i * step, bit) ^ 1u);
+            }
+        }
+
+        const size_t m = num_l < num_r ? num_l : num_r;
+        for (size_t k = 0; k < m; k++) {
+            ip_swap(K, keys + (l + off_l[start_l + k]) * step,
+                    keys + (r - 1 - off_r[start_r + k]) * step);
+        }
+        num_l -= m; start_l += m;
+        num_r -= m; start_r += m;
+        if (num_l == 0) l += IP_BLOCK;
+        if (num_r == 0) r -= IP_BLOCK;
+    }
+    return l + ip_hoare_partition(K, keys + l * step, r - l, bit);
+}
+
+static IP_INLINE void ip_insertion_sort(const ip_keys* K, uint8_t* keys, size_t n, size_t top) {
+    const size_t step = ip_step(K);
+    for (size_t i = 1; i < n; i++) {
+        size_t j = i;
+        while (j > 0 && ip_key_gt(K, keys + (j - 1) * step, keys + j * step, top)) {
+            ip_swap(K, keys + (j - 1) * step, keys + j * step);
+            j--;
+        }
+    }
+}
+
+static IP_INLINE void inplace_sort(const ip_keys* K, uint8_t* keys, size_t n) {
+    // Per range: units [0, top) are equal across it, `next` = the bit below
+    // the one the parent split on (ip_key_bits: none).
+    struct { uint8_t* keys; size_t n; size_t top; size_t next; } stack[IP_STACK];
+    const size_t step = ip_step(K);
+    const size_t nbits = ip_key_bits(K);
+    int sp = 0;
+    size_t top = 0;
+    size_t next = nbits;
+
+    for (;;) {
+        while (n > IP_SMALL) {
+            size_t bit;
+            if (next < nbits && ip_bit_varies(K, keys, n, next)) {
+                bit = next;
+            } else if (!ip_diff_scan(K, keys, n, top, &bit)) {
+                n = 0; // all equal in this range
+                break;
+            }
+
+            const size_t split = n > 2 * IP_BLOCK ? ip_block_partition(K, keys, n, bit)
+                                                  : ip_hoare_partition(K, keys, n, bit);
+            const size_t right_n = n - split;
+            top = ip_unit(K, bit);
+            next = bit + 1;
+
+            stack[sp].top = top;
+            stack[sp].next = next;
+            if (split < right_n) {
+                stack[sp].keys = keys + split * step;
+                stack[sp].n = right_n;
+                n = split;
+            } else {
+                stack[sp].keys = keys;
+                stack[sp].n = split;
+                keys += split * step;
+                n = right_n;
+            }
+            sp++;
+        }
+
+        ip_insertion_sort(K, keys, n, top);
+
+        if (sp == 0) return;
+        sp--;
+        keys = stack[sp].keys;
+        n = stack[sp].n;
+        top = stack[sp].top;
+        next = stack[sp].next;
+    }
+}
@@ -0,0 +1,59 @@
+// Key + payload moves and the insertion sort leaf shared by the key-value
+// sorts. Payloads are vsz bytes each; the swaps are called with 4 and 8 as
+// compile time constants so the hot loops move them with single loads and
+// stores.
+//
+// Include once per translation unit, after defining the key type and order:
+//
+//   #define KV_KEY u128
+//   #define KV_KEY_GT(a, b) (u128_cmp((a), (b)) > 0)   // a, b: const KV_KEY*
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static inline void swap_val(unsigned char* v, size_t i, size_t j, size_t vsz) {
+    unsigned char* x = v + i * vsz;
+    unsigned char* y = v + j * vsz;
+    if (vsz == 8) {
+        uint64_t a, b;
+        memcpy(&a, x, 8); memcpy(&b, y, 8);
+        memcpy(x, &b, 8); memcpy(y, &a, 8);
+    } else if (vsz == 4) {
+        uint32_t a, b;
+        memcpy(&a, x, 4); memcpy(&b, y, 4);
+        memcpy(x, &b, 4); memcpy(y, &a, 4);
+    } else {
+        for (size_t k = 0; k < vsz; k++) {
+            unsigned char t = x[k];
+            x[k] = y[k];
+            y[k] = t;
+        }
+    }
+}
+
+static inline void swap_kv(KV_KEY* a, unsigned char* v, int i, int j, size_t vsz) {
+    KV_KEY t = a[i];
+    a[i] = a[j];
+    a[j] = t;
+    swap_val(v, (size_t)i, (size_t)j, vsz);
+}
+
+// Stable: only strictly greater keys are moved past.
+static inline void insertion_sort_kv_impl(KV_KEY* a, unsigned char* v, int n, size_t vsz) {
+    for (int i = 1; i < n; i++) {
+        int j = i;
+        while (j > 0 && KV_KEY_GT(&a[j - 1], &a[j])) {
+            swap_kv(a, v, j - 1, j, vsz);
+            j--;
+        }
+    }
+}
+
+static inline void insertion_sort_kv(KV_KEY* a, unsigned char* v, int n, size_t vsz) {
+    switch (vsz) {
+        case 8:  insertion_sort_kv_impl(a, v, n, 8); break;
+        case 4:  insertion_sort_kv_impl(a, v, n, 4); break;
+        default: insertion_sort_kv_impl(a, v, n, vsz); break;
+    }
+}
@@ -0,0 +1,156 @@
+#include "psort_lookup.h"
+#include "psort_bits.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PSORT_PREFETCH(p) __builtin_prefetch((p), 0, 0)
+#else
+#define PSORT_PREFETCH(p) ((void)(p))
+#endif
+
+struct psort_lookup {
+    const uint64_t* keys;
+    size_t n;
+    size_t limbs;
+    size_t pos;      // first bit below the shared prefix
+    int bits;        // digit width (0: a single bucket)
+    uint32_t* start; // (1 << bits) + 1 bucket starts
+};
+
+// -1 / 0 / 1 as a <, ==, > b
+static inline int key_cmp(const uint64_t* a, const uint64_t* b, size_t limbs) {
+    for (size_t l = 0; l < limbs; l++) {
+        if (a[l] != b[l]) return a[l] < b[l] ? -1 : 1;
+    }
+    return 0;
+}
+
+// q's bits above pos against the prefix every key shares.
+static inline int prefix_cmp(const psort_lookup* lk, const uint64_t* q) {
+    const uint64_t* k = lk->keys;
+    const size_t full = lk->pos / 64;
+    const unsigned off = (unsigned)(lk->pos % 64);
+    for (size_t l = 0; l < full; l++) {
+        if (q[l] != k[l]) return q[l] < k[l] ? -1 : 1;
+    }
+    if (off) {
+        const uint64_t a = q[full] >> (64 - off), b = k[full] >> (64 - off);
+        if (a != b) return a < b ? -1 : 1;
+    }
+    return 0;
+}
+
+static inline size_t digit_of(const psort_lookup* lk, const uint64_t* k) {
+    return lk->bits ? (size_t)psort_bits_at(k, lk->limbs, lk->pos, lk->bits) : 0;
+}
+
+// First i in [lo, hi) with keys[i] >= q, hi if none.
+static inline size_t bucket_search(const psort_lookup* lk, const uint64_t* q, size_t lo, size_t hi) {
+    const size_t limbs = lk->limbs;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (key_cmp(lk->keys + mid * limbs, q, limbs) < 0) lo = mid + 1;
+        else                                               hi = mid;
+    }
+    return lo;
+}
+
+static int floor_log2(size_t n) {
+    int b = 0;
+    while ((n >> b) > 1) b++;
+    return b;
+}
+
+psort_lookup* psort_lookup_build(const uint64_t* keys, size_t n, size_t limbs, int bits) {
+    if (n > UINT32_MAX) {
+        errno = EINVAL;
+        return NULL;
+    }
+    psort_lookup* lk = (psort_lookup*)malloc(sizeof(psort_lookup));
+    if (!lk) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    lk->keys = keys;
+    lk->n = n;
+    lk->limbs = limbs;
+    lk->pos = n ? psort_bits_first_diff(keys, keys + (n - 1) * limbs, limbs) : limbs * 64;
+    if (bits <= 0) bits = floor_log2(n) - 1; // ~2 keys per bucket
+    if (bits > PSORT_LOOKUP_MAX_BITS) bits = PSORT_LOOKUP_MAX_BITS;
+    if ((size_t)bits > limbs * 64 - lk->pos) bits = (int)(limbs * 64 - lk->pos);
+    if (bits < 0) bits = 0;
+    lk->bits = bits;
+
+    const size_t nb = (size_t)1 << bits;
+    lk->start = (uint32_t*)malloc((nb + 1) * sizeof(uint32_t));
+    if (!lk->start) {
+        free(lk);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    // Keys are sorted, so digits only grow: one pass fills every start.
+    size_t b = 0;
+    for (size_t i = 0; i < n; i++) {
+        const size_t d = digit_of(lk, keys + i * limbs);
+        while (b <= d) lk->start[b++] = (uint32_t)i;
+    }
+    while (b <= nb) lk->start[b++] = (uint32_t)n;
+    return lk;
+}
+
+void psort_lookup_destroy(psort_lookup* lk) {
+    if (!lk) return;
+    free(lk->start);
+    free(lk);
+}
+
+size_t psort_lookup_lower_bound(const psort_lookup* lk, const uint64_t* q) {
+    if (lk->n == 0) return 0;
+    const int c = prefix_cmp(lk, q);
+    if (c) return c < 0 ? 0 : lk->n;
+    const size_t d = digit_of(lk, q);
+    return bucket_search(lk, q, lk->start[d], lk->start[d + 1]);
+}
+
+void psort_lookup_lower_bound_batch(const psort_lookup* lk, const uint64_t* qs,
+                                    size_t m, size_t* out) {
+    const size_t limbs = lk->limbs;
+    size_t lo[PSORT_LOOKUP_BATCH], hi[PSORT_LOOKUP_BATCH];
+    unsigned char pending[PSORT_LOOKUP_BATCH]; // still needs its bucket searched
+
+    if (lk->n == 0) {
+        for (size_t j = 0; j < m; j++) out[j] = 0;
+        return;
+    }
+
+    for (size_t b = 0; b < m; b += PSORT_LOOKUP_BATCH) {
+        const size_t g = m - b < PSORT_LOOKUP_BATCH ? m - b : PSORT_LOOKUP_BATCH;
+        const uint64_t* q = qs + b * limbs;
+
+        // Queries outside the shared prefix are done; the rest touch the directory.
+        for (size_t j = 0; j < g; j++) {
+            const int c = prefix_cmp(lk, q + j * limbs);
+            pending[j] = c == 0;
+            if (c) {
+                out[b + j] = c < 0 ? 0 : lk->n;
+                continue;
+            }
+            lo[j] = digit_of(lk, q + j * limbs);
+            PSORT_PREFETCH(&lk->start[lo[j]]);
+        }
+        for (size_t j = 0; j < g; j++) {
+            if (!pending[j]) continue;
+            const size_t d = lo[j];
+            lo[j] = lk->start[d];
+            hi[j] = lk->start[d + 1];
+            if (lo[j] < hi[j]) PSORT_PREFETCH(lk->keys + (lo[j] + (hi[j] - lo[j]) / 2) * limbs);
+        }
+        for (size_t j = 0; j < g; j++) {
+            if (pending[j]) out[b + j] = bucket_search(lk, q + j * limbs, lo[j], hi[j]);
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Radix directory over a sorted array of n keys, `limbs` 64-bit words each,
+// most significant first. Keys share the bits above `pos` (the common prefix
+// of the first and last key); the next `bits` bits pick one of 2^bits
+// buckets, and start[d] .. start[d + 1] is the range of keys with digit d.
+// A lower bound then reads one directory entry and searches a bucket of a
+// few keys instead of binary searching the whole array (~log2 n misses).
+// The directory refers to the keys; they must stay in place and unchanged.
+
+#define PSORT_LOOKUP_MAX_BITS 24  // 64 MB of offsets at most
+#define PSORT_LOOKUP_BATCH    16  // queries in flight in the batched search
+
+typedef struct psort_lookup psort_lookup;
+
+// bits: directory width, 0 picks about two keys per bucket. NULL if out of
+// memory (errno ENOMEM) or n does not fit the 32-bit offsets (EINVAL).
+psort_lookup* psort_lookup_build(const uint64_t* keys, size_t n, size_t limbs, int bits);
+void          psort_lookup_destroy(psort_lookup* lk);
+
+// First i with keys[i] >= q (n if none).
+size_t psort_lookup_lower_bound(const psort_lookup* lk, const uint64_t* q);
+
+// out[j] = lower bound of query j (qs holds m keys). Queries go through the
+// stages in groups of PSORT_LOOKUP_BATCH: all directory entries of a group
+// are prefetched, then all bucket heads, then the buckets are searched, so
+// the misses of different queries overlap.
+void psort_lookup_lower_bound_batch(const psort_lookup* lk, const uint64_t* qs,
+                                    size_t m, size_t* out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+#include <stddef.h>
+#include <string.h>
+
+// Loser tree for the k-way merges (k >= 1 sources). Leaf i is node k + i,
+// internal node t (1..k-1) keeps the loser of the match between its children
+// 2t and 2t+1, tree[0] the overall winner. less(src, a, b): the head of
+// source a goes before the head of source b. Exhausted sources must lose to
+// everything and ties go to the lower source, so merges are stable and do
+// not depend on the tree shape. Everything is inline: with a constant less
+// the comparisons compile to direct calls.
+
+typedef int (*psort_lt_less)(const void* src, int a, int b);
+
+// tree: k ints, win: 2k ints of build scratch (match winners).
+static inline void psort_lt_build(int* tree, int* win, size_t k,
+                                  psort_lt_less less, const void* src) {
+    for (size_t i = 0; i < k; i++) win[k + i] = (int)i;
+    for (size_t t = k - 1; t >= 1; t--) {
+        const int a = win[2 * t];
+        const int b = win[2 * t + 1];
+        const int a_wins = less(src, a, b);
+        win[t] = a_wins ? a : b;
+        tree[t] = a_wins ? b : a;
+    }
+    tree[0] = k > 1 ? win[1] : 0;
+}
+
+// The head of the winner w was consumed: replay from leaf w to the root.
+// Returns the new winner (also stored in tree[0]).
+static inline int psort_lt_replay(int* tree, size_t k, int w,
+                                  psort_lt_less less, const void* src) {
+    for (size_t t = (k + (size_t)w) / 2; t > 0; t /= 2) {
+        if (less(src, tree[t], w)) {
+            const int l = tree[t];
+            tree[t] = w;
+            w = l;
+        }
+    }
+    tree[0] = w;
+    return w;
+}
+
+// ---------------- in memory runs ----------------
+
+typedef int (*psort_key_cmp)(const void* a, const void* b);
+
+typedef struct {
+    const unsigned char* const* runs;
+    const size_t* lens;
+    size_t* pos;
+    size_t key_bytes;
+    psort_key_cmp cmp;
+} psort_lt_runs;
+
+static inline int psort_lt_runs_less(const void* p, int a, int b) {
+    const psort_lt_runs* m = (const psort_lt_runs*)p;
+    if (m->pos[a] == m->lens[a]) return 0;
+    if (m->pos[b] == m->lens[b]) return 1;
+    const int c = m->cmp(m->runs[a] + m->pos[a] * m->key_bytes,
+                         m->runs[b] + m->pos[b] * m->key_bytes);
+    return c < 0 || (c == 0 && a < b);
+}
+
+// Merges the ascending runs[0..k) (lens[i] keys of key_bytes each, ordered by
+// cmp) into out. tree: k ints, win: 2k ints, pos: k run cursors.
+static inline void psort_lt_merge(void* out, const void* const* runs, const size_t* lens,
+                                  size_t k, size_t key_bytes, psort_key_cmp cmp,
+                                  int* tree, int* win, size_t* pos) {
+    const psort_lt_runs m = { (const unsigned char* const*)runs, lens, pos, key_bytes, cmp };
+    unsigned char* o = (unsigned char*)out;
+    size_t total = 0;
+    for (size_t i = 0; i < k; i++) {
+        pos[i] = 0;
+        total += lens[i];
+    }
+    psort_lt_build(tree, win, k, psort_lt_runs_less, &m);
+
+    int w = tree[0];
+    for (size_t n = 0; n < total; n++) {
+        memcpy(o + n * key_bytes, m.runs[w] + pos[w]++ * key_bytes, key_bytes);
+        w = psort_lt_replay(tree, k, w, psort_lt_runs_less, &m);
+    }
+}
@@ -0,0 +1,322 @@
+#define _POSIX_C_SOURCE 200809L
+#include "psort_parallel.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+int psort_par_default_threads(void) {
+    long c = sysconf(_SC_NPROCESSORS_ONLN);
+    if (c < 1) return 1;
+    if (c > 1024) return 1024;
+    return (int)c;
+}
+
+// ---------------- persistent team ----------------
+//
+// Members sleep on `go` between phases; a phase is published by bumping
+// `gen`, and the caller waits on `done` until `running` drops to zero.
+
+typedef struct {
+    psort_team* team;
+    int tid;
+} team_member;
+
+struct psort_team {
+    int nthreads;
+    pthread_t* th;
+    char* started;
+    team_member* members;
+    pthread_mutex_t mu;
+    pthread_cond_t go;
+    pthread_cond_t done;
+    unsigned long gen;   // phases published so far
+    int running;         // started members still in the current phase
+    int stop;
+    psort_par_fn fn;
+    void* ctx;
+};
+
+static void* team_main(void* p) {
+    team_member* m = (team_member*)p;
+    psort_team* team = m->team;
+    unsigned long seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&team->mu);
+        while (team->gen == seen && !team->stop) pthread_cond_wait(&team->go, &team->mu);
+        if (team->stop) {
+            pthread_mutex_unlock(&team->mu);
+            return NULL;
+        }
+        seen = team->gen;
+        const psort_par_fn fn = team->fn;
+        void* ctx = team->ctx;
+        pthread_mutex_unlock(&team->mu);
+
+        fn(ctx, m->tid, team->nthreads);
+
+        pthread_mutex_lock(&team->mu);
+        if (--team->running == 0) pthread_cond_signal(&team->done);
+        pthread_mutex_unlock(&team->mu);
+    }
+}
+
+psort_team* psort_team_start(int nthreads) {
+    if (nthreads < 1) nthreads = 1;
+    psort_team* team = (psort_team*)calloc(1, sizeof(psort_team));
+    if (!team) return NULL;
+    team->nthreads = nthreads;
+    team->th = (pthread_t*)malloc((size_t)nthreads * sizeof(pthread_t));
+    team->started = (char*)calloc((size_t)nthreads, 1);
+    team->members = (team_member*)malloc((size_t)nthreads * sizeof(team_member));
+    if (!team->th || !team->started || !team->members) {
+        free(team->th); free(team->started); free(team->members);
+        free(team);
+        return NULL;
+    }
+
+    pthread_mutex_init(&team->mu, NULL);
+    pthread_cond_init(&team->go, NULL);
+    pthread_cond_init(&team->done, NULL);
+    for (int t = 1; t < nthreads; t++) {
+        team->members[t].team = team;
+        team->members[t].tid = t;
+        team->started[t] = (char)(pthread_create(&team->th[t], NULL, team_main, &team->members[t]) == 0);
+    }
+    return team;
+}
+
+int psort_team_size(const psort_team* team) {
+    return team->nthreads;
+}
+
+void psort_team_run(psort_team* team, psort_par_fn fn, void* ctx) {
+    const int nt = team->nthreads;
+    int live = 0;
+    for (int t = 1; t < nt; t++) live += team->started[t];
+
+    if (live > 0) {
+        pthread_mutex_lock(&team->mu);
+        team->fn = fn;
+        team->ctx = ctx;
+        team->running = live;
+        team->gen++;
+        pthread_cond_broadcast(&team->go);
+        pthread_mutex_unlock(&team->mu);
+    }
+
+    fn(ctx, 0, nt);
+    for (int t = 1; t < nt; t++) {
+        if (!team->started[t]) fn(ctx, t, nt);
+    }
+
+    if (live > 0) {
+        pthread_mutex_lock(&team->mu);
+        while (team->running > 0) pthread_cond_wait(&team->done, &team->mu);
+        pthread_mutex_unlock(&team->mu);
+    }
+}
+
+void psort_team_stop(psort_team* team) {
+    if (!team) return;
+    pthread_mutex_lock(&team->mu);
+    team->stop = 1;
+    pthread_cond_broadcast(&team->go);
+    pthread_mutex_unlock(&team->mu);
+    for (int t = 1; t < team->nthreads; t++) {
+        if (team->started[t]) pthread_join(team->th[t], NULL);
+    }
+    pthread_cond_destroy(&team->done);
+    pthread_cond_destroy(&team->go);
+    pthread_mutex_destroy(&team->mu);
+    free(team->th);
+    free(team->started);
+    free(team->members);
+    free(team);
+}
+
+// ---------------- work stealing pool ----------------
+
+typedef struct {
+    pthread_mutex_t mu;
+    psort_task* buf;   // ring buffer
+    size_t cap;        // power of two
+    size_t top;        // steal end
+    size_t bottom;     // owner end (exclusive)
+} pool_deque;
+
+struct psort_pool {
+    psort_task_fn fn;
+    void* ctx;
+    int nthreads;
+    pool_deque* dq;
+    atomic_size_t pending;   // tasks pushed but not finished
+    atomic_size_t queued;    // tasks sitting in a deque
+    atomic_int sleepers;     // workers waiting on idle_cv
+    pthread_mutex_t idle_mu;
+    pthread_cond_t idle_cv;
+};
+
+static int deque_push(pool_deque* d, psort_task t) {
+    pthread_mutex_lock(&d->mu);
+    if (d->bottom - d->top == d->cap) {
+        size_t ncap = d->cap ? d->cap * 2 : 64;
+        psort_task* nb = (psort_task*)malloc(ncap * sizeof(psort_task));
+        if (!nb) {
+            pthread_mutex_unlock(&d->mu);
+            return 0;
+        }
+        for (size_t i = d->top; i < d->bottom; i++) {
+            nb[i & (ncap - 1)] = d->buf[i & (d->cap - 1)];
+        }
+        free(d->buf);
+        d->buf = nb;
+        d->cap = ncap;
+    }
+    d->buf[d->bottom & (d->cap - 1)] = t;
+    d->bottom++;
+    pthread_mutex_unlock(&d->mu);
+    return 1;
+}
+
+static int deque_pop(pool_deque* d, psort_task* out) {
+    int ok = 0;
+    pthread_mutex_lock(&d->mu);
+    if (d->bottom != d->top) {
+        d->bottom--;
+        *out = d->buf[d->bottom & (d->cap - 1)];
+        ok = 1;
+    }
+    pthread_mutex_unlock(&d->mu);
+    return ok;
+}
+
+static int deque_steal(pool_deque* d, psort_task* out) {
+    int ok = 0;
+    if (pthread_mutex_trylock(&d->mu) != 0) return 0;
+    if (d->bottom != d->top) {
+        *out = d->buf[d->top & (d->cap - 1)];
+        d->top++;
+        ok = 1;
+    }
+    pthread_mutex_unlock(&d->mu);
+    return ok;
+}
+
+// A worker goes to sleep only after it registered in `sleepers` and saw
+// `queued` == 0 under idle_mu; pushers bump `queued` before they look at
+// `sleepers`, so one side always sees the other.
+static void pool_wake_one(psort_pool* pool) {
+    if (atomic_load(&pool->sleepers) == 0) return;
+    pthread_mutex_lock(&pool->idle_mu);
+    pthread_cond_signal(&pool->idle_cv);
+    pthread_mutex_unlock(&pool->idle_mu);
+}
+
+static void pool_task_done(psort_pool* pool) {
+    if (atomic_fetch_sub(&pool->pending, 1) != 1) return;
+    // Last task: release everyone waiting for work.
+    pthread_mutex_lock(&pool->idle_mu);
+    pthread_cond_broadcast(&pool->idle_cv);
+    pthread_mutex_unlock(&pool->idle_mu);
+}
+
+static void pool_wait(psort_pool* pool) {
+    pthread_mutex_lock(&pool->idle_mu);
+    atomic_fetch_add(&pool->sleepers, 1);
+    while (atomic_load(&pool->queued) == 0 && atomic_load(&pool->pending) != 0) {
+        pthread_cond_wait(&pool->idle_cv, &pool->idle_mu);
+    }
+    atomic_fetch_sub(&pool->sleepers, 1);
+    pthread_mutex_unlock(&pool->idle_mu);
+}
+
+void psort_pool_push(psort_pool* pool, int worker, psort_task t) {
+    atomic_fetch_add(&pool->pending, 1);
+    if (!deque_push(&pool->dq[worker], t)) {
+        // Out of deque space: just do it now.
+        pool->fn(pool, worker, t, pool->ctx);
+        pool_task_done(pool);
+        return;
+    }
+    atomic_fetch_add(&pool->queued, 1);
+    pool_wake_one(pool);
+}
+
+static void pool_main(psort_pool* pool, int self) {
+    const int nt = pool->nthreads;
+    psort_task t;
+
+    for (;;) {
+        int got = deque_pop(&pool->dq[self], &t);
+        for (int k = 1; k < nt && !got; k++) {
+            got = deque_steal(&pool->dq[(self + k) % nt], &t);
+        }
+        if (got) {
+            atomic_fetch_sub(&pool->queued, 1);
+            pool->fn(pool, self, t, pool->ctx);
+            pool_task_done(pool);
+            continue;
+        }
+
+        if (atomic_load(&pool->pending) == 0) return;
+        // A steal can lose a trylock race while tasks are still queued:
+        // retry those, sleep only when every deque is empty.
+        if (atomic_load(&pool->queued) == 0) pool_wait(pool);
+    }
+}
+
+static void pool_member(void* p, int tid, int nthreads) {
+    (void)nthreads;
+    pool_main((psort_pool*)p, tid);
+}
+
+void psort_pool_run(psort_team* team, psort_task_fn fn, void* ctx,
+                    const psort_task* seeds, size_t nseeds)
+{
+    psort_pool pool;
+    pool.fn = fn;
+    pool.ctx = ctx;
+    pool.nthreads = psort_team_size(team);
+    atomic_init(&pool.pending, 0);
+    atomic_init(&pool.queued, 0);
+    atomic_init(&pool.sleepers, 0);
+    pthread_mutex_init(&pool.idle_mu, NULL);
+    pthread_cond_init(&pool.idle_cv, NULL);
+    pool.dq = (pool_deque*)calloc((size_t)pool.nthreads, sizeof(pool_deque));
+
+    if (!pool.dq) {
+        // Degrade to a serial drain: a one worker pool on the caller.
+        pool_deque d1;
+        pool.dq = &d1;
+        pool.nthreads = 1;
+        d1.buf = NULL; d1.cap = 0; d1.top = 0; d1.bottom = 0;
+        pthread_mutex_init(&d1.mu, NULL);
+        for (size_t i = 0; i < nseeds; i++) psort_pool_push(&pool, 0, seeds[i]);
+        pool_main(&pool, 0);
+        pthread_mutex_destroy(&d1.mu);
+        free(d1.buf);
+    } else {
+        for (int w = 0; w < pool.nthreads; w++) pthread_mutex_init(&pool.dq[w].mu, NULL);
+
+        // Seeds are dealt round robin so every worker starts with local work.
+        for (size_t i = 0; i < nseeds; i++) {
+            psort_pool_push(&pool, (int)(i % (size_t)pool.nthreads), seeds[i]);
+        }
+
+        // Worker 0 is the caller. Deques of members that failed to start are
+        // drained by stealing, so no task is lost.
+        psort_team_run(team, pool_member, &pool);
+
+        for (int w = 0; w < pool.nthreads; w++) {
+            pthread_mutex_destroy(&pool.dq[w].mu);
+            free(pool.dq[w].buf);
+        }
+        free(pool.dq);
+    }
+
+    pthread_cond_destroy(&pool.idle_cv);
+    pthread_mutex_destroy(&pool.idle_mu);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Worker count used when a caller passes nthreads <= 0 (online CPUs, at least 1).
+int psort_par_default_threads(void);
+
+// Persistent team: nthreads - 1 threads are started once and then run any
+// number of phases. psort_team_run runs fn(ctx, tid, nthreads) for
+// tid = 0..nthreads-1 and returns once every member is done (a barrier);
+// tid 0 runs on the calling thread and idle members block until the next
+// phase. If a thread cannot be started, its share runs on the caller, so fn
+// must not wait on other tids. psort_team_start returns NULL without memory.
+typedef struct psort_team psort_team;
+typedef void (*psort_par_fn)(void* ctx, int tid, int nthreads);
+psort_team* psort_team_start(int nthreads);
+int psort_team_size(const psort_team* team);
+void psort_team_run(psort_team* team, psort_par_fn fn, void* ctx);
+void psort_team_stop(psort_team* team);
+
+// Work stealing pool over range tasks.
+// Each worker owns a deque: it pushes/pops at the bottom (LIFO, cache warm),
+// idle workers steal from the top of other deques (FIFO, oldest = biggest).
+typedef struct {
+    size_t off;   // start of the range (element offset, meaning is up to fn)
+    size_t n;     // range length
+    int    aux;   // per task state (e.g. next bit / digit position)
+} psort_task;
+
+typedef struct psort_pool psort_pool;
+typedef void (*psort_task_fn)(psort_pool* pool, int worker, psort_task t, void* ctx);
+
+// Runs all seed tasks and everything they push on the members of team,
+// returns when no task is left. Workers without work block until a task is
+// pushed or the pool drains.
+void psort_pool_run(psort_team* team, psort_task_fn fn, void* ctx,
+                    const psort_task* seeds, size_t nseeds);
+
+// Called from inside fn: hand a sub range to the pool (may be stolen).
+void psort_pool_push(psort_pool* pool, int worker, psort_task t);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,31 @@
+#include "psort_partition.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+static atomic_int g_mode = -1;
+
+static int mode_from_env(void) {
+    const char* env = getenv("PIPESORT_PARTITION");
+    if (env) {
+        if (strcmp(env, "hoare") == 0) return PSORT_PART_HOARE;
+        if (strcmp(env, "block") == 0) return PSORT_PART_BLOCK;
+        if (strcmp(env, "simd") == 0) return PSORT_PART_SIMD;
+    }
+    return PSORT_PART_AUTO;
+}
+
+int psort_partition_mode(void) {
+    int mode = atomic_load_explicit(&g_mode, memory_order_relaxed);
+    if (mode < 0) {
+        mode = mode_from_env();
+        atomic_store_explicit(&g_mode, mode, memory_order_relaxed);
+    }
+    return mode;
+}
+
+void psort_partition_set_mode(int mode) {
+    if (mode < PSORT_PART_AUTO || mode > PSORT_PART_SIMD) mode = PSORT_PART_AUTO;
+    atomic_store_explicit(&g_mode, mode, memory_order_relaxed);
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "psort_simd.h"
+#include "psort_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bit partition kernels shared by the in place sorts. Keys are arrays of
+// 64-bit words, `limbs` words per key, most significant word first.
+// Keys whose bit `shift` of word `word` is clear go left; the split is returned.
+
+enum {
+    PSORT_PART_AUTO  = 0,  // see psort_partition_pick
+    PSORT_PART_HOARE = 1,  // two scanning loops, swap on mismatch
+    PSORT_PART_BLOCK = 2,  // BlockQuicksort style, branch free classification
+    PSORT_PART_SIMD  = 3   // AVX-512 compress stores (block if not available)
+};
+
+// Selected kernel: psort_partition_set_mode() or PIPESORT_PARTITION=
+// auto|hoare|block|simd, default auto.
+int  psort_partition_mode(void);
+void psort_partition_set_mode(int mode);
+
+#define PSORT_BLOCK      128               // offsets per side buffer (fits uint8_t)
+#define PSORT_BLOCK_MIN_N (4 * PSORT_BLOCK) // smaller ranges: Hoare is as fast
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PSORT_PART_INLINE inline __attribute__((always_inline))
+#else
+#define PSORT_PART_INLINE inline
+#endif
+
+static PSORT_PART_INLINE void psort_part_swap(uint64_t* a, uint64_t* b, size_t limbs) {
+    PSORT_STAT_MOVE(2, limbs * sizeof(uint64_t));
+    for (size_t l = 0; l < limbs; l++) {
+        uint64_t t = a[l];
+        a[l] = b[l];
+        b[l] = t;
+    }
+}
+
+static PSORT_PART_INLINE size_t psort_hoare_partition_bit(uint64_t* a, size_t n, size_t limbs,
+                                                          size_t word, int shift) {
+    size_t i = 0, j = n;
+
+    for (;;) {
+        while (i < j && ((a[i * limbs + word] >> shift) & 1ULL) == 0) i++;
+        while (i < j && ((a[(j - 1) * limbs + word] >> shift) & 1ULL) != 0) j--;
+        if (i >= j) break;
+        psort_part_swap(a + i * limbs, a + (j - 1) * limbs, limbs);
+        i++;
+        j--;
+    }
+    return i;
+}
+
+// BlockQuicksort (Edelkamp & Weiss) for a bit predicate: classify a block
+// from each end into offset buffers without branches (the offset is always
+// written, the count only advances on a misplaced key), then swap the
+// misplaced pairs in one batch. On random bits this replaces ~n/2 mispredicted
+// loop exits with straight line code. The last < 3 blocks go to Hoare.
+static PSORT_PART_INLINE size_t psort_block_partition_bit(uint64_t* a, size_t n, size_t limbs,
+                                                          size_t word, int shift) {
+    uint8_t off_l[PSORT_BLOCK], off_r[PSORT_BLOCK];
+    size_t l = 0, r = n;                 // [l, r) not yet placed
+    size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+    while (r - l > 2 * PSORT_BLOCK) {
+        if (num_l == 0) {
+            start_l = 0;
+            const uint64_t* k = a + l * limbs + word;
+            for (size_t i = 0; i < PSORT_BLOCK; i++) {
+                off_l[num_l] = (uint8_t)i;
+                num_l += (size_t)((k[i * limbs] >> shift) & 1ULL);
+            }
+        }
+        if (num_r == 0) {
+            start_r = 0;
+            const uint64_t* k = a + (r - 1) * limbs + word;
+            for (size_t i = 0; i < PSORT_BLOCK; i++) {
+                off_r[num_r] = (uint8_t)i;
+                num_r += (size_t)(((k[-(ptrdiff_t)(i * limbs)] >> shift) & 1ULL) ^ 1ULL);
+            }
+        }
+
+        const size_t m = num_l < num_r ? num_l : num_r;
+        for (size_t k = 0; k < m; k++) {
+            psort_part_swap(a + (l + off_l[start_l + k]) * limbs,
+                            a + (r - 1 - off_r[start_r + k]) * limbs, limbs);
+        }
+        num_l -= m; start_l += m;
+        num_r -= m; start_r += m;
+        if (num_l == 0) l += PSORT_BLOCK;
+        if (num_r == 0) r -= PSORT_BLOCK;
+    }
+
+    // Everything left of l is clear and right of r is set; a block with
+    // pending offsets is still inside [l, r), so Hoare finishes the rest.
+    return l + psort_hoare_partition_bit(a + l * limbs, r - l, limbs, word, shift);
+}
+
+// Kernel for a range of n keys of `limbs` words: PSORT_PART_HOARE, _BLOCK or
+// _SIMD. AUTO only takes the compress-store path for 2 limb keys: with 4 or
+// more limbs a vector holds <= 2 keys and the block partition measured faster.
+static inline int psort_partition_pick(size_t n, size_t limbs) {
+    const int mode = psort_partition_mode();
+    if (mode == PSORT_PART_HOARE) return PSORT_PART_HOARE;
+    if (mode != PSORT_PART_BLOCK && psort_simd_level() >= PSORT_SIMD_AVX512 &&
+        (mode == PSORT_PART_SIMD || limbs <= 2)) {
+        return PSORT_PART_SIMD;
+    }
+    if (mode == PSORT_PART_AUTO && n < PSORT_BLOCK_MIN_N) return PSORT_PART_HOARE;
+    return PSORT_PART_BLOCK;
+}
+
+#ifdef __cplusplus
+}
+#endif
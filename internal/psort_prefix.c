@@ -0,0 +1,153 @@
+#include "psort_prefix.h"
+#include "psort_tune.h"
+
+#include <string.h>
+
+typedef struct {
+    uint32_t pfx;   // cached chunk of keys[id]
+    uint32_t id;
+} pfx_entry;
+
+#define PREFETCH_DIST     16
+#define RADIX_WIDE_BITS   11
+#define RADIX_NARROW_BITS 4
+#define CHUNK_BITS        32
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PSORT_PREFETCH(p) __builtin_prefetch((p), 0, 0)
+#else
+#define PSORT_PREFETCH(p) ((void)(p))
+#endif
+
+// Chunk h of a key: bits 32h .. 32h + 31 counted from the top.
+static inline uint32_t chunk_at(const uint64_t* k, size_t h) {
+    return (uint32_t)(k[h / 2] >> ((h & 1) ? 0 : 32));
+}
+
+// Reload the cached chunk for a whole range (the only key gathers of this mode).
+static void reload_chunk(pfx_entry* e, const uint64_t* keys, size_t limbs, int n, size_t h) {
+    int i = 0;
+    for (; i + PREFETCH_DIST < n; i++) {
+        PSORT_PREFETCH(keys + (size_t)e[i + PREFETCH_DIST].id * limbs + h / 2);
+        e[i].pfx = chunk_at(keys + (size_t)e[i].id * limbs, h);
+    }
+    for (; i < n; i++) e[i].pfx = chunk_at(keys + (size_t)e[i].id * limbs, h);
+}
+
+// a < b, given that all bits above chunk h are equal and e->pfx holds chunk h.
+static inline int less_cached(const uint64_t* keys, size_t limbs,
+                              const pfx_entry* a, const pfx_entry* b, size_t h) {
+    if (a->pfx != b->pfx) return a->pfx < b->pfx;
+    const uint64_t* x = keys + (size_t)a->id * limbs;
+    const uint64_t* y = keys + (size_t)b->id * limbs;
+    for (size_t l = h / 2; l < limbs; l++) {
+        if (x[l] != y[l]) return x[l] < y[l];
+    }
+    return 0;
+}
+
+static inline void insertion_sort_cached(pfx_entry* e, const uint64_t* keys, size_t limbs,
+                                         int n, size_t h) {
+    for (int i = 1; i < n; i++) {
+        pfx_entry key = e[i];
+        int j = i - 1;
+        while (j >= 0 && less_cached(keys, limbs, &key, &e[j], h)) {
+            e[j + 1] = e[j];
+            j--;
+        }
+        e[j + 1] = key;
+    }
+}
+
+static void msd_cached_rec(pfx_entry* e, pfx_entry* tmp, const uint64_t* keys, size_t limbs,
+                           int n, size_t pos, size_t h);
+
+// One digit level starting at bit pos (from the top) of the cached chunk h,
+// then recurse. A digit never straddles the chunk. c must hold 1 << width
+// counters.
+static inline void cached_level(pfx_entry* e, pfx_entry* tmp, const uint64_t* keys,
+                                size_t limbs, int n, size_t pos, size_t h, int width, int* c) {
+    for (;;) {
+        if (pos >= limbs * 64) return; // all bits equal: already in stable order
+        if (pos >= (h + 1) * CHUNK_BITS) {
+            h = pos / CHUNK_BITS;
+            reload_chunk(e, keys, limbs, n, h);
+        }
+
+        const int left = (int)((h + 1) * CHUNK_BITS - pos); // 1..32 bits left in the chunk
+        const int w = width < left ? width : left;
+        const int shift = left - w;
+        const uint32_t mask = (1u << w) - 1;
+        const int nb = 1 << w;
+
+        memset(c, 0, (size_t)nb * sizeof(int));
+        for (int i = 0; i < n; i++) c[(e[i].pfx >> shift) & mask]++;
+
+        // If all in one bucket, skip to next digit
+        int nonempty = 0;
+        for (int b = 0; b < nb && nonempty < 2; b++) nonempty += (c[b] != 0);
+        if (nonempty <= 1) {
+            pos += (size_t)w;
+            continue;
+        }
+
+        int sum = 0;
+        for (int b = 0; b < nb; b++) {
+            const int cnt = c[b];
+            c[b] = sum;
+            sum += cnt;
+        }
+        for (int i = 0; i < n; i++) tmp[c[(e[i].pfx >> shift) & mask]++] = e[i];
+        memcpy(e, tmp, (size_t)n * sizeof(pfx_entry));
+
+        int start = 0;
+        for (int b = 0; b < nb; b++) {
+            const int end = c[b];
+            if (end - start > 1) {
+                msd_cached_rec(e + start, tmp + start, keys, limbs, end - start, pos + (size_t)w, h);
+            }
+            start = end;
+        }
+        return;
+    }
+}
+
+static void cached_level_wide(pfx_entry* e, pfx_entry* tmp, const uint64_t* keys, size_t limbs,
+                              int n, size_t pos, size_t h, int width) {
+    int c[1 << RADIX_WIDE_BITS];
+    cached_level(e, tmp, keys, limbs, n, pos, h, width, c);
+}
+
+static void cached_level_narrow(pfx_entry* e, pfx_entry* tmp, const uint64_t* keys, size_t limbs,
+                                int n, size_t pos, size_t h, int width) {
+    int c[1 << RADIX_NARROW_BITS];
+    cached_level(e, tmp, keys, limbs, n, pos, h, width, c);
+}
+
+static void msd_cached_rec(pfx_entry* e, pfx_entry* tmp, const uint64_t* keys, size_t limbs,
+                           int n, size_t pos, size_t h) {
+    const psort_profile* p = psort_tune_profile();
+
+    if (n <= 1) return;
+    if (pos >= limbs * 64 || n <= psort_tune_radix_cutoff(p, limbs)) {
+        insertion_sort_cached(e, keys, limbs, n, h);
+        return;
+    }
+
+    const int width = psort_tune_digit_width(p, limbs, n);
+    if (width > RADIX_NARROW_BITS) cached_level_wide(e, tmp, keys, limbs, n, pos, h, width);
+    else                           cached_level_narrow(e, tmp, keys, limbs, n, pos, h, width);
+}
+
+void psort_prefix_index_sort(uint32_t* idx, uint32_t* tmp, const uint64_t* keys,
+                             int n, size_t limbs) {
+    if (n <= 1) return;
+
+    pfx_entry* e = (pfx_entry*)tmp;
+    for (int i = 0; i < n; i++) e[i].id = idx[i];
+    reload_chunk(e, keys, limbs, n, 0);
+
+    msd_cached_rec(e, e + n, keys, limbs, n, 0, 0);
+
+    for (int i = 0; i < n; i++) idx[i] = e[i].id;
+}
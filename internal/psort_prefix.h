@@ -0,0 +1,24 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Index sort with key prefix caching.
+// keys: n keys of `limbs` (4 or 8) 64-bit words, most significant first
+// (the u256 / u512 layouts). Same result as the radix index sorts (stable).
+//
+// Every entry carries the 32-bit key chunk the current digit lives in, so
+// count and scatter passes stream a dense array instead of dereferencing
+// keys[idx[i]] (one cache miss per element per pass once idx is shuffled).
+// Keys are only gathered when a range moves past a chunk boundary, and those
+// gathers are software prefetched. tmp must hold 4n uint32: the 2n 8-byte
+// (chunk, index) entries are built there, nothing is allocated.
+void psort_prefix_index_sort(uint32_t* idx, uint32_t* tmp, const uint64_t* keys,
+                             int n, size_t limbs);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,217 @@
+#include "psort_runs.h"
+#include "psort_scratch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// -1 / 0 / 1 as a <, ==, > b (big endian limbs)
+static inline int key_cmp(const uint64_t* a, const uint64_t* b, size_t limbs) {
+    for (size_t l = 0; l < limbs; l++) {
+        if (a[l] != b[l]) return a[l] < b[l] ? -1 : 1;
+    }
+    return 0;
+}
+
+static void reverse_keys(uint64_t* keys, size_t n, size_t limbs) {
+    for (size_t i = 0, j = n - 1; i < j; i++, j--) {
+        uint64_t* a = keys + i * limbs;
+        uint64_t* b = keys + j * limbs;
+        for (size_t l = 0; l < limbs; l++) {
+            const uint64_t t = a[l];
+            a[l] = b[l];
+            b[l] = t;
+        }
+    }
+}
+
+static void reverse_idx(uint32_t* idx, int n) {
+    for (int i = 0, j = n - 1; i < j; i++, j--) {
+        const uint32_t t = idx[i];
+        idx[i] = idx[j];
+        idx[j] = t;
+    }
+}
+
+// Leading run of keys[0..n): *desc = 0 for non descending, 1 for
+// non ascending (equal keys are interchangeable here). Returns its length.
+static size_t leading_run(const uint64_t* keys, size_t n, size_t limbs, int* desc) {
+    size_t i = 1;
+    if (key_cmp(keys, keys + limbs, limbs) <= 0) {
+        *desc = 0;
+        while (i < n && key_cmp(keys + (i - 1) * limbs, keys + i * limbs, limbs) <= 0) i++;
+    } else {
+        *desc = 1;
+        while (i < n && key_cmp(keys + (i - 1) * limbs, keys + i * limbs, limbs) >= 0) i++;
+    }
+    return i;
+}
+
+static size_t leading_run_idx(const uint32_t* idx, const uint64_t* keys, size_t n,
+                              size_t limbs, int* desc) {
+#define K(i) (keys + (size_t)idx[i] * limbs)
+    size_t i = 1;
+    if (key_cmp(K(0), K(1), limbs) <= 0) {
+        *desc = 0;
+        while (i < n && key_cmp(K(i - 1), K(i), limbs) <= 0) i++;
+    } else {
+        *desc = 1;
+        while (i < n && key_cmp(K(i - 1), K(i), limbs) > 0) i++;
+    }
+#undef K
+    return i;
+}
+
+// keys[0..r) and buf[0..m) sorted -> keys[0..r+m) sorted. Backwards, so
+// prefix keys below buf[0] never move; ties take the buf key first (it goes
+// to the higher slot).
+static void merge_back(uint64_t* keys, size_t r, const uint64_t* buf, size_t m, size_t limbs) {
+    size_t i = r, j = m, k = r + m;
+    while (j > 0) {
+        const uint64_t* src;
+        if (i > 0 && key_cmp(keys + (i - 1) * limbs, buf + (j - 1) * limbs, limbs) > 0) {
+            src = keys + --i * limbs;
+        } else {
+            src = buf + --j * limbs;
+        }
+        memcpy(keys + --k * limbs, src, limbs * sizeof(uint64_t));
+    }
+}
+
+// buf[0..r) (the prefix) and keys[r..r+m) sorted -> keys[0..r+m) sorted.
+// Forwards, so the output never overtakes the unread tail; ties take the
+// prefix key first.
+static void merge_front(uint64_t* keys, const uint64_t* buf, size_t r, size_t m, size_t limbs) {
+    size_t i = 0, j = r, k = 0;
+    const size_t n = r + m;
+    while (i < r) {
+        const uint64_t* src;
+        if (j < n && key_cmp(keys + j * limbs, buf + i * limbs, limbs) < 0) {
+            src = keys + j++ * limbs;
+        } else {
+            src = buf + i++ * limbs;
+        }
+        memcpy(keys + k++ * limbs, src, limbs * sizeof(uint64_t));
+    }
+}
+
+// Only worth a try if the first PSORT_RUNS_DROP_SAMPLE pairs are mostly in
+// order; random input has about half of them descending.
+static int few_descents(const uint64_t* keys, size_t n, size_t limbs) {
+    const size_t end = n < PSORT_RUNS_DROP_SAMPLE + 1 ? n : PSORT_RUNS_DROP_SAMPLE + 1;
+    size_t d = 0;
+    for (size_t i = 1; i < end; i++) d += key_cmp(keys + (i - 1) * limbs, keys + i * limbs, limbs) > 0;
+    return d <= PSORT_RUNS_DROP_SAMPLE / 16;
+}
+
+// Drop-merge: keep a sorted subsequence in place at the front, move keys
+// that break it to buf. A key below the kept top either replaces the top
+// (when it still fits above the key under it: the top was a high outlier) or
+// is dropped; after PSORT_RUNS_DROP_BACKTRACK drops in a row the top itself is
+// popped. Then buf is sorted and merged back. Gives up (restoring a
+// permutation of the input) once more than n / PSORT_RUNS_DROP_DIV keys drop.
+static int drop_merge(uint64_t* keys, size_t n, size_t limbs, psort_runs_sort_fn sort) {
+    const size_t cap = n / PSORT_RUNS_DROP_DIV;
+    const size_t ksz = limbs * sizeof(uint64_t);
+    uint64_t* buf = (uint64_t*)psort_scratch_get(cap * ksz);
+    if (!buf) return 0;
+
+    size_t w = 1, d = 0, run = 0; // kept keys[0..w), dropped buf[0..d); w + d == i
+    for (size_t i = 1; i < n;) {
+        const uint64_t* k = keys + i * limbs;
+        if (w == 0 || key_cmp(keys + (w - 1) * limbs, k, limbs) <= 0) {
+            if (w != i) memcpy(keys + w * limbs, k, ksz);
+            w++; i++; run = 0;
+            continue;
+        }
+        if (d == cap) {
+            memcpy(keys + w * limbs, buf, d * ksz); // slots [w, i) are free
+            psort_scratch_put(buf);
+            return 0;
+        }
+        if (w >= 2 && key_cmp(keys + (w - 2) * limbs, k, limbs) <= 0) {
+            memcpy(buf + d++ * limbs, keys + (w - 1) * limbs, ksz);
+            memcpy(keys + (w - 1) * limbs, k, ksz);
+            i++; run = 0;
+        } else if (run >= PSORT_RUNS_DROP_BACKTRACK) {
+            memcpy(buf + d++ * limbs, keys + --w * limbs, ksz); // retry k on the new top
+            run = 0;
+        } else {
+            memcpy(buf + d++ * limbs, k, ksz);
+            i++; run++;
+        }
+    }
+
+    sort(buf, d, limbs);
+    merge_back(keys, w, buf, d, limbs);
+    psort_scratch_put(buf);
+    return 1;
+}
+
+int psort_runs_presorted(uint64_t* keys, size_t n, size_t limbs, psort_runs_sort_fn sort) {
+    if (n < 2) return 1;
+
+    int desc;
+    const size_t r = leading_run(keys, n, limbs, &desc);
+    if (r == n) {
+        if (desc) reverse_keys(keys, n, limbs);
+        return 1;
+    }
+    if (n < PSORT_RUNS_MIN_N) return 0;
+    if (r < n / PSORT_RUNS_PREFIX_DIV) {
+        return n >= PSORT_RUNS_DROP_MIN_N && few_descents(keys, n, limbs) &&
+               drop_merge(keys, n, limbs, sort);
+    }
+
+    if (desc) reverse_keys(keys, r, limbs);
+    const size_t m = n - r;
+    uint64_t* tail = keys + r * limbs;
+    sort(tail, m, limbs);
+
+    // Appended keys all at or above the prefix: nothing to merge.
+    if (key_cmp(tail - limbs, tail, limbs) <= 0) return 1;
+
+    // Only now, with the tail's own peels done, take a buffer for the
+    // shorter side: at most n / 2 keys, never nested.
+    const size_t ksz = limbs * sizeof(uint64_t);
+    uint64_t* buf = (uint64_t*)psort_scratch_get((m <= r ? m : r) * ksz);
+    if (!buf) return 0;
+    if (m <= r) {
+        memcpy(buf, tail, m * ksz);
+        merge_back(keys, r, buf, m, limbs);
+    } else {
+        memcpy(buf, keys, r * ksz);
+        merge_front(keys, buf, r, m, limbs);
+    }
+    psort_scratch_put(buf);
+    return 1;
+}
+
+int psort_runs_presorted_index(uint32_t* idx, uint32_t* tmp, const uint64_t* keys,
+                               int n, size_t limbs, psort_runs_index_fn sort) {
+    if (n < 2) return 1;
+
+    int desc;
+    const int r = (int)leading_run_idx(idx, keys, (size_t)n, limbs, &desc);
+    if (r == n) {
+        if (desc) reverse_idx(idx, n);
+        return 1;
+    }
+    if (n < PSORT_RUNS_MIN_N || r < n / PSORT_RUNS_PREFIX_DIV) return 0;
+
+    if (desc) reverse_idx(idx, r);
+    const int m = n - r;
+    sort(idx + r, tmp + r, keys, m, limbs);
+
+#define K(id) (keys + (size_t)(id) * limbs)
+    if (key_cmp(K(idx[r - 1]), K(idx[r]), limbs) > 0) {
+        // Stable backwards merge: on ties the tail (later) entry goes last.
+        memcpy(tmp, idx + r, (size_t)m * sizeof(uint32_t));
+        int i = r, j = m, k = n;
+        while (j > 0) {
+            if (i > 0 && key_cmp(K(idx[i - 1]), K(tmp[j - 1]), limbs) > 0) idx[--k] = idx[--i];
+            else                                                           idx[--k] = tmp[--j];
+        }
+    }
+#undef K
+    return 1;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Run detection pre-pass for the sort entry points. Keys are arrays of
+// 64-bit words, `limbs` words per key, most significant word first.
+//
+// One scan finds the leading run: ascending input returns at once, a
+// descending one is reversed. If the run covers at least a quarter of the
+// range (PSORT_RUNS_PREFIX_DIV), only the rest is handed to `sort` (the entry
+// point itself, so a tail made of further runs is peeled the same way) and
+// the two sorted parts are merged. Random input stops after a couple of
+// comparisons.
+//
+// Otherwise, if the first keys are mostly in order, a drop-merge pass keeps
+// the longest easy sorted subsequence in place, sorts the (at most n / 8)
+// keys that break it with `sort` and merges them back: nearly sorted input
+// costs O(n) plus a sort of its outliers.
+//
+// Scratch (psort_scratch_get): the prefix merge copies the shorter of the
+// two sorted parts, min(r, n - r) <= n / 2 keys, and only after the tail
+// sort has returned, so peels never hold buffers at the same time. The
+// drop-merge keeps at most n / 8 dropped keys while they are sorted (their
+// own peels add at most n / 16). Without memory nothing is merged.
+//
+// Returns 1 if keys are now sorted, 0 if the caller should run its engine on
+// the whole range (keys may be permuted then, e.g. after an aborted
+// drop-merge or a failed allocation).
+
+#define PSORT_RUNS_PREFIX_DIV     4    // leading run must cover >= n / 4 keys
+#define PSORT_RUNS_MIN_N          64   // below this only the sorted / reversed checks run
+#define PSORT_RUNS_DROP_MIN_N     4096 // smallest range for a drop-merge attempt
+#define PSORT_RUNS_DROP_SAMPLE    64   // leading pairs checked before one
+#define PSORT_RUNS_DROP_DIV       8    // at most n / 8 keys may be dropped
+#define PSORT_RUNS_DROP_BACKTRACK 8    // drops in a row before the kept top is popped
+
+typedef void (*psort_runs_sort_fn)(uint64_t* keys, size_t n, size_t limbs);
+
+int psort_runs_presorted(uint64_t* keys, size_t n, size_t limbs, psort_runs_sort_fn sort);
+
+// Same for index sorts: runs are read through idx, the merge goes through tmp
+// (length n, so nothing is allocated). Only strictly descending runs are
+// reversed and there is no drop-merge pass (its pops would reorder equal
+// keys), so the index sorts stay stable.
+typedef void (*psort_runs_index_fn)(uint32_t* idx, uint32_t* tmp, const uint64_t* keys,
+                                    int n, size_t limbs);
+
+int psort_runs_presorted_index(uint32_t* idx, uint32_t* tmp, const uint64_t* keys,
+                               int n, size_t limbs, psort_runs_index_fn sort);
+
+#ifdef __cplusplus
+}
+#endif
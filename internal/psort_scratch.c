@@ -0,0 +1,239 @@
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS, MADV_HUGEPAGE with -std=c11
+#include "psort_scratch.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#define ARENA_ALIGN      64          // block alignment (cache line)
+#define ARENA_MIN_CHUNK  (64u << 10) // smallest chunk requested
+#define ARENA_HUGE_PAGE  (2u << 20)  // huge page chunks are multiples of this
+
+typedef struct arena_chunk {
+    struct arena_chunk* next; // older chunk
+    unsigned char* data;      // ARENA_ALIGN aligned start of the blocks
+    size_t size;              // usable bytes at data
+    size_t top;               // bump offset
+    size_t raw_bytes;         // bytes obtained for the chunk (header included)
+    int mapped;               // from mmap (huge pages), not the allocator
+} arena_chunk;
+
+// Precedes every block, padded to ARENA_ALIGN.
+typedef struct {
+    arena_chunk* chunk;
+    size_t start; // offset of this header in chunk->data
+    size_t size;  // header + payload
+} arena_block;
+
+#define ARENA_HDR ((sizeof(arena_block) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+struct psort_arena {
+    psort_allocator a; // a.alloc == NULL: malloc / free
+    unsigned flags;
+    arena_chunk* head; // newest chunk, blocks are carved from it
+    size_t chunks;
+    size_t live;       // blocks handed out and not freed
+    size_t in_use;     // their bytes, headers included
+    size_t peak;
+    size_t capacity;   // usable bytes of all chunks
+};
+
+static _Thread_local psort_arena* psort_tls_arena;
+
+static size_t round_up(size_t x, size_t a) {
+    return (x + a - 1) / a * a;
+}
+
+static arena_chunk* chunk_new(psort_arena* ar, size_t usable) {
+    size_t raw = sizeof(arena_chunk) + ARENA_ALIGN + usable;
+    void* mem = NULL;
+    int mapped = 0;
+
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+    if (!ar->a.alloc && (ar->flags & PSORT_CTX_HUGE_PAGES) && usable >= ARENA_HUGE_PAGE / 2) {
+        raw = round_up(raw, ARENA_HUGE_PAGE);
+        mem = mmap(NULL, raw, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            mem = NULL;
+        } else {
+            mapped = 1;
+#ifdef MADV_HUGEPAGE
+            (void)madvise(mem, raw, MADV_HUGEPAGE); // only a hint: THP may be off
+#endif
+        }
+    }
+#endif
+    if (!mem) mem = ar->a.alloc ? ar->a.alloc(ar->a.user, raw) : malloc(raw);
+    if (!mem) return NULL;
+
+    arena_chunk* c = (arena_chunk*)mem;
+    const uintptr_t base = (uintptr_t)(c + 1);
+    c->data = (unsigned char*)(base + ((ARENA_ALIGN - base % ARENA_ALIGN) % ARENA_ALIGN));
+    c->size = raw - (size_t)(c->data - (unsigned char*)mem);
+    c->top = 0;
+    c->raw_bytes = raw;
+    c->mapped = mapped;
+    c->next = ar->head;
+    ar->head = c;
+    ar->chunks++;
+    ar->capacity += c->size;
+    return c;
+}
+
+static void chunk_release(psort_arena* ar, arena_chunk* c) {
+    ar->capacity -= c->size;
+    ar->chunks--;
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+    if (c->mapped) {
+        munmap(c, c->raw_bytes);
+        return;
+    }
+#endif
+    if (ar->a.alloc) {
+        if (ar->a.free) ar->a.free(ar->a.user, c, c->raw_bytes);
+    } else {
+        free(c);
+    }
+}
+
+static void release_all(psort_arena* ar) {
+    while (ar->head) {
+        arena_chunk* c = ar->head;
+        ar->head = c->next;
+        chunk_release(ar, c);
+    }
+}
+
+// Arena drained: rewind, and fold several chunks into one that holds them all.
+static void arena_drained(psort_arena* ar) {
+    if (ar->chunks > 1) {
+        const size_t total = ar->capacity;
+        release_all(ar);
+        (void)chunk_new(ar, total); // on failure the next call simply grows again
+    } else if (ar->head) {
+        ar->head->top = 0;
+    }
+}
+
+psort_arena* psort_arena_create(const psort_allocator* a, unsigned flags) {
+    psort_arena* ar;
+    if (a && a->alloc) ar = (psort_arena*)a->alloc(a->user, sizeof(psort_arena));
+    else               ar = (psort_arena*)malloc(sizeof(psort_arena));
+    if (!ar) return NULL;
+
+    ar->a.alloc = a ? a->alloc : NULL;
+    ar->a.free = a ? a->free : NULL;
+    ar->a.user = a ? a->user : NULL;
+    ar->flags = flags;
+    ar->head = NULL;
+    ar->chunks = 0;
+    ar->live = 0;
+    ar->in_use = 0;
+    ar->peak = 0;
+    ar->capacity = 0;
+    return ar;
+}
+
+void psort_arena_destroy(psort_arena* ar) {
+    if (!ar) return;
+    if (psort_tls_arena == ar) psort_tls_arena = NULL;
+    release_all(ar);
+    if (ar->a.alloc) {
+        if (ar->a.free) ar->a.free(ar->a.user, ar, sizeof(psort_arena));
+    } else {
+        free(ar);
+    }
+}
+
+int psort_arena_reserve(psort_arena* ar, size_t bytes) {
+    if (ar->capacity >= bytes) return 0;
+    if (ar->live) {
+        // Blocks are out: add a chunk for the difference, folded in later.
+        if (!chunk_new(ar, bytes - ar->capacity)) goto oom;
+        return 0;
+    }
+    release_all(ar);
+    if (!chunk_new(ar, bytes)) goto oom;
+    return 0;
+oom:
+    errno = ENOMEM;
+    return -1;
+}
+
+size_t psort_arena_capacity(const psort_arena* ar) {
+    return ar->capacity;
+}
+
+size_t psort_arena_peak(const psort_arena* ar) {
+    return ar->peak;
+}
+
+void* psort_arena_alloc(psort_arena* ar, size_t bytes) {
+    const size_t need = ARENA_HDR + round_up(bytes ? bytes : 1, ARENA_ALIGN);
+    arena_chunk* c = ar->head;
+    if (!c || c->size - c->top < need) {
+        // Grow geometrically so a growing workload settles after few calls.
+        size_t grow = ar->capacity > need ? ar->capacity : need;
+        if (grow < ARENA_MIN_CHUNK) grow = ARENA_MIN_CHUNK;
+        c = chunk_new(ar, grow);
+        if (!c) c = chunk_new(ar, need);
+        if (!c) return NULL;
+    }
+
+    arena_block* b = (arena_block*)(c->data + c->top);
+    b->chunk = c;
+    b->start = c->top;
+    b->size = need;
+    c->top += need;
+
+    ar->live++;
+    ar->in_use += need;
+    if (ar->in_use > ar->peak) ar->peak = ar->in_use;
+    return (unsigned char*)b + ARENA_HDR;
+}
+
+void psort_arena_free(psort_arena* ar, void* p) {
+    if (!p) return;
+    arena_block* b = (arena_block*)((unsigned char*)p - ARENA_HDR);
+    arena_chunk* c = b->chunk;
+    ar->live--;
+    ar->in_use -= b->size;
+    // Top block: pop it. Anything else waits for the arena to drain.
+    if (b->start + b->size == c->top) c->top = b->start;
+    if (ar->live == 0) arena_drained(ar);
+}
+
+// Does p lie in one of ar's chunks?
+static int arena_owns(const psort_arena* ar, const void* p) {
+    const unsigned char* q = (const unsigned char*)p;
+    for (const arena_chunk* c = ar->head; c; c = c->next) {
+        if (q >= c->data && q < c->data + c->size) return 1;
+    }
+    return 0;
+}
+
+psort_arena* psort_scratch_bind(psort_arena* ar) {
+    psort_arena* prev = psort_tls_arena;
+    psort_tls_arena = ar;
+    return prev;
+}
+
+void* psort_scratch_get(size_t bytes) {
+    psort_arena* ar = psort_tls_arena;
+    if (ar) {
+        void* p = psort_arena_alloc(ar, bytes);
+        if (p) return p;
+    }
+    return malloc(bytes);
+}
+
+void psort_scratch_put(void* p) {
+    if (!p) return;
+    psort_arena* ar = psort_tls_arena;
+    if (ar && arena_owns(ar, p)) psort_arena_free(ar, p);
+    else                         free(p);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <stddef.h>
+
+#include "pipesort/pipesort.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Reusable scratch memory behind psort_ctx.
+//
+// An arena is a list of chunks taken from the caller's allocator (or
+// malloc / huge pages). Blocks are bump allocated from the newest chunk and
+// are nearly always released in reverse order, so freeing the top block just
+// moves the bump pointer back. Whenever the arena drains, chunks added
+// during the call are merged into one chunk as large as all of them: after
+// a warm-up call of a given size the arena serves every later call of that
+// size without touching the allocator.
+//
+// Engines do not take an arena argument. They call psort_scratch_get /
+// psort_scratch_put, which use the arena bound to the calling thread by
+// psort_scratch_bind, or malloc / free when none is bound (or the arena
+// cannot grow). Parallel workers run on their own threads and allocate as
+// before.
+
+typedef struct psort_arena psort_arena;
+
+psort_arena* psort_arena_create(const psort_allocator* a, unsigned flags);
+void         psort_arena_destroy(psort_arena* ar);
+int          psort_arena_reserve(psort_arena* ar, size_t bytes);
+size_t       psort_arena_capacity(const psort_arena* ar);
+size_t       psort_arena_peak(const psort_arena* ar);
+void*        psort_arena_alloc(psort_arena* ar, size_t bytes); // 64 byte aligned, NULL if out of memory
+void         psort_arena_free(psort_arena* ar, void* p);
+
+psort_arena* psort_scratch_bind(psort_arena* ar); // returns the previous binding
+void*        psort_scratch_get(size_t bytes);
+void         psort_scratch_put(void* p);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,326 @@
+#define _POSIX_C_SOURCE 200809L
+#include "psort_simd.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PSORT_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define PSORT_HAVE_X86_SIMD 0
+#endif
+
+// ---------------- dispatch ----------------
+
+static atomic_int g_level = -1;
+
+static int detect_level(void) {
+    int level = PSORT_SIMD_SCALAR;
+#if PSORT_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) level = PSORT_SIMD_AVX2;
+    if (__builtin_cpu_supports("avx512f")) level = PSORT_SIMD_AVX512;
+#endif
+    const char* env = getenv("PIPESORT_SIMD");
+    if (env) {
+        int cap = level;
+        if (strcmp(env, "scalar") == 0) cap = PSORT_SIMD_SCALAR;
+        else if (strcmp(env, "avx2") == 0) cap = PSORT_SIMD_AVX2;
+        if (cap < level) level = cap;
+    }
+    return level;
+}
+
+int psort_simd_level(void) {
+    int level = atomic_load_explicit(&g_level, memory_order_relaxed);
+    if (level < 0) {
+        level = detect_level();
+        atomic_store_explicit(&g_level, level, memory_order_relaxed);
+    }
+    return level;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+// Resolve at load time so the hot paths only see a cached int.
+__attribute__((constructor)) static void psort_simd_init(void) {
+    (void)psort_simd_level();
+}
+#endif
+
+// ---------------- scalar kernels ----------------
+
+static void diff_scan_scalar(const uint64_t* keys, size_t n, size_t limbs,
+                             const uint64_t* base, size_t w, size_t wn, uint64_t* d) {
+    if (w == 0 && wn == limbs && 8 % limbs == 0) {
+        // Flat stream: 8 words per step against the key repeated 8 / limbs times.
+        uint64_t pat[8], acc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        for (size_t j = 0; j < 8; j++) pat[j] = base[j % limbs];
+        const size_t total = n * limbs;
+        size_t q = 0;
+        for (; q + 8 <= total; q += 8) {
+            for (size_t j = 0; j < 8; j++) acc[j] |= keys[q + j] ^ pat[j];
+        }
+        for (size_t j = 0; q + j < total; j++) acc[j] |= keys[q + j] ^ pat[j];
+        for (size_t j = 0; j < 8; j++) d[j % limbs] |= acc[j];
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        const uint64_t* k = keys + i * limbs + w;
+        for (size_t l = 0; l < wn; l++) d[l] |= k[l] ^ base[w + l];
+    }
+}
+
+static void idx_digits_scalar(const uint32_t* idx, size_t n, const uint64_t* keys,
+                              size_t limbs, size_t word, int shift, int width,
+                              uint16_t* out) {
+    const uint64_t mask = (1ULL << width) - 1;
+    if (shift + width > 64) {
+        for (size_t i = 0; i < n; i++) {
+            const uint64_t* k = keys + (size_t)idx[i] * limbs;
+            out[i] = (uint16_t)(((k[word] >> shift) | (k[word - 1] << (64 - shift))) & mask);
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (uint16_t)((keys[(size_t)idx[i] * limbs + word] >> shift) & mask);
+    }
+}
+
+#if PSORT_HAVE_X86_SIMD
+
+// ---------------- AVX2 ----------------
+
+__attribute__((target("avx2")))
+static void diff_scan_avx2(const uint64_t* keys, size_t n, size_t limbs,
+                           const uint64_t* base, size_t w, size_t wn, uint64_t* d) {
+    uint64_t out[8];
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+
+    if (w == 0 && wn == limbs && 8 % limbs == 0) {
+        uint64_t pat[8];
+        for (size_t j = 0; j < 8; j++) pat[j] = base[j % limbs];
+        const __m256i p0 = _mm256_loadu_si256((const __m256i*)pat);
+        const __m256i p1 = _mm256_loadu_si256((const __m256i*)(pat + 4));
+        __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+
+        const size_t total = n * limbs;
+        size_t q = 0;
+        for (; q + 16 <= total; q += 16) {
+            acc0 = _mm256_or_si256(acc0, _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(keys + q)), p0));
+            acc1 = _mm256_or_si256(acc1, _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(keys + q + 4)), p1));
+            acc2 = _mm256_or_si256(acc2, _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(keys + q + 8)), p0));
+            acc3 = _mm256_or_si256(acc3, _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(keys + q + 12)), p1));
+        }
+        acc0 = _mm256_or_si256(acc0, acc2);
+        acc1 = _mm256_or_si256(acc1, acc3);
+        _mm256_storeu_si256((__m256i*)out, acc0);
+        _mm256_storeu_si256((__m256i*)(out + 4), acc1);
+        for (size_t j = 0; q + j < total; j++) out[j & 7] |= keys[q + j] ^ pat[j & 7];
+        for (size_t j = 0; j < 8; j++) d[j % limbs] |= out[j];
+        return;
+    }
+
+    // One key window per step, masked loads so no word outside [w, w + wn) is read.
+    const __m256i lane = _mm256_setr_epi64x(0, 1, 2, 3);
+    const __m256i m0 = _mm256_cmpgt_epi64(_mm256_set1_epi64x((long long)wn), lane);
+    const __m256i m1 = _mm256_cmpgt_epi64(_mm256_set1_epi64x((long long)wn - 4), lane);
+    const __m256i b0 = _mm256_maskload_epi64((const long long*)(base + w), m0);
+    __m256i b1 = _mm256_setzero_si256();
+    if (wn > 4) b1 = _mm256_maskload_epi64((const long long*)(base + w + 4), m1);
+
+    for (size_t i = 0; i < n; i++) {
+        const long long* k = (const long long*)(keys + i * limbs + w);
+        acc0 = _mm256_or_si256(acc0, _mm256_xor_si256(_mm256_maskload_epi64(k, m0), b0));
+        if (wn > 4) acc1 = _mm256_or_si256(acc1, _mm256_xor_si256(_mm256_maskload_epi64(k + 4, m1), b1));
+    }
+    _mm256_storeu_si256((__m256i*)out, acc0);
+    _mm256_storeu_si256((__m256i*)(out + 4), acc1);
+    for (size_t l = 0; l < wn; l++) d[l] |= out[l];
+}
+
+// ---------------- AVX-512 ----------------
+
+__attribute__((target("avx512f")))
+static void diff_scan_avx512(const uint64_t* keys, size_t n, size_t limbs,
+                             const uint64_t* base, size_t w, size_t wn, uint64_t* d) {
+    uint64_t out[8];
+
+    if (w == 0 && wn == limbs && 8 % limbs == 0) {
+        uint64_t pat[8];
+        for (size_t j = 0; j < 8; j++) pat[j] = base[j % limbs];
+        const __m512i p = _mm512_loadu_si512((const void*)pat);
+        __m512i a0 = _mm512_setzero_si512(), a1 = _mm512_setzero_si512();
+        __m512i a2 = _mm512_setzero_si512(), a3 = _mm512_setzero_si512();
+
+        const size_t total = n * limbs;
+        size_t q = 0;
+        for (; q + 32 <= total; q += 32) {
+            a0 = _mm512_or_si512(a0, _mm512_xor_si512(_mm512_loadu_si512((const void*)(keys + q)), p));
+            a1 = _mm512_or_si512(a1, _mm512_xor_si512(_mm512_loadu_si512((const void*)(keys + q + 8)), p));
+            a2 = _mm512_or_si512(a2, _mm512_xor_si512(_mm512_loadu_si512((const void*)(keys + q + 16)), p));
+            a3 = _mm512_or_si512(a3, _mm512_xor_si512(_mm512_loadu_si512((const void*)(keys + q + 24)), p));
+        }
+        for (; q + 8 <= total; q += 8) {
+            a0 = _mm512_or_si512(a0, _mm512_xor_si512(_mm512_loadu_si512((const void*)(keys + q)), p));
+        }
+        if (q < total) {
+            const __mmask8 m = (__mmask8)((1u << (total - q)) - 1);
+            a1 = _mm512_or_si512(a1, _mm512_maskz_xor_epi64(m, _mm512_maskz_loadu_epi64(m, keys + q), p));
+        }
+        a0 = _mm512_or_si512(_mm512_or_si512(a0, a1), _mm512_or_si512(a2, a3));
+        _mm512_storeu_si512((void*)out, a0);
+        for (size_t j = 0; j < 8; j++) d[j % limbs] |= out[j];
+        return;
+    }
+
+    const __mmask8 m = (__mmask8)((1u << wn) - 1);
+    const __m512i b = _mm512_maskz_loadu_epi64(m, base + w);
+    __m512i acc = _mm512_setzero_si512();
+    for (size_t i = 0; i < n; i++) {
+        acc = _mm512_or_si512(acc, _mm512_xor_si512(_mm512_maskz_loadu_epi64(m, keys + i * limbs + w), b));
+    }
+    _mm512_storeu_si512((void*)out, acc);
+    for (size_t l = 0; l < wn; l++) d[l] |= out[l];
+}
+
+// Word mask of the keys flagged in a lane mask that has at most one bit per key
+// (at lane k * limbs + word): every flagged key expands to its `limbs` lanes.
+static inline __mmask8 expand_key_mask(__mmask8 m, unsigned limbs, unsigned word, unsigned keybits) {
+    const unsigned t = ((unsigned)m >> word) & keybits;
+    return (__mmask8)((t * ((1u << limbs) - 1)) & 0xFFu);
+}
+
+// Vectorized in place partition (Bramas style): the first and last vector are
+// held in registers, which leaves a 2-vector gap; each step reads the side with
+// less free room and compress-stores clear-bit keys left, set-bit keys right.
+__attribute__((target("avx512f,popcnt")))
+static size_t partition_bit_avx512(uint64_t* a, size_t n, size_t limbs, size_t word, int shift) {
+    const size_t V = 8 / limbs;   // keys per vector
+    const unsigned ulimbs = (unsigned)limbs;
+    const unsigned uword = (unsigned)word;
+
+    uint64_t lanes[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    unsigned keybits = 0;
+    for (size_t k = 0; k < V; k++) {
+        lanes[k * limbs + word] = 1ULL << shift;
+        keybits |= 1u << (k * limbs);
+    }
+    const __m512i tmask = _mm512_loadu_si512((const void*)lanes);
+
+    size_t lw = 0, rw = n;           // write cursors (keys)
+    size_t lr = V, rr = n - V;       // unread keys are [lr, rr)
+    const __m512i first = _mm512_loadu_si512((const void*)a);
+    const __m512i last = _mm512_loadu_si512((const void*)(a + (n - V) * limbs));
+
+#define PSORT_SPLIT_STORE(vec)                                                      \
+    do {                                                                            \
+        const __mmask8 set_ = _mm512_test_epi64_mask((vec), tmask);                 \
+        const __mmask8 q1_ = expand_key_mask(set_, ulimbs, uword, keybits);         \
+        const size_t c1_ = (size_t)__builtin_popcount((unsigned)set_);              \
+        _mm512_mask_compressstoreu_epi64(a + lw * limbs, (__mmask8)~q1_, (vec));    \
+        lw += V - c1_;                                                              \
+        rw -= c1_;                                                                  \
+        _mm512_mask_compressstoreu_epi64(a + rw * limbs, q1_, (vec));               \
+    } while (0)
+
+    while (rr - lr >= V) {
+        __m512i v;
+        if (lr - lw <= rw - rr) {
+            v = _mm512_loadu_si512((const void*)(a + lr * limbs));
+            lr += V;
+        } else {
+            rr -= V;
+            v = _mm512_loadu_si512((const void*)(a + rr * limbs));
+        }
+        PSORT_SPLIT_STORE(v);
+    }
+
+    // Fewer than V keys left unread: park them, then [lw, rw) is all free.
+    uint64_t tail[8];
+    const size_t rem = rr - lr;
+    memcpy(tail, a + lr * limbs, rem * limbs * sizeof(uint64_t));
+
+    PSORT_SPLIT_STORE(first);
+    PSORT_SPLIT_STORE(last);
+#undef PSORT_SPLIT_STORE
+
+    for (size_t k = 0; k < rem; k++) {
+        const uint64_t* key = tail + k * limbs;
+        uint64_t* dst = ((key[word] >> shift) & 1ULL) ? a + (--rw) * limbs : a + (lw++) * limbs;
+        memcpy(dst, key, limbs * sizeof(uint64_t));
+    }
+    return lw;
+}
+
+__attribute__((target("avx512f")))
+static void idx_digits_avx512(const uint32_t* idx, size_t n, const uint64_t* keys,
+                              size_t limbs, size_t word, int shift, int width,
+                              uint16_t* out) {
+    const int cross = shift + width > 64;
+    const void* lo = (const void*)(keys + word);
+    const void* hi = cross ? (const void*)(keys + word - 1) : lo;
+    const __m512i vlimbs = _mm512_set1_epi64((long long)limbs);
+    const __m512i vmask = _mm512_set1_epi64((long long)((1ULL << width) - 1));
+    const __m128i sh = _mm_cvtsi32_si128(shift);
+    const __m128i shc = _mm_cvtsi32_si128(64 - shift);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i ix = _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i*)(idx + i)));
+        ix = _mm512_mul_epu32(ix, vlimbs);
+        __m512i v = _mm512_srl_epi64(_mm512_i64gather_epi64(ix, lo, 8), sh);
+        if (cross) v = _mm512_or_si512(v, _mm512_sll_epi64(_mm512_i64gather_epi64(ix, hi, 8), shc));
+        v = _mm512_and_si512(v, vmask);
+        _mm_storeu_si128((__m128i*)(out + i), _mm512_cvtepi64_epi16(v));
+    }
+    idx_digits_scalar(idx + i, n - i, keys, limbs, word, shift, width, out + i);
+}
+
+#endif // PSORT_HAVE_X86_SIMD
+
+// ---------------- public entry points ----------------
+
+void psort_simd_diff_scan(const uint64_t* keys, size_t n, size_t limbs,
+                          const uint64_t* base, size_t w, size_t wn, uint64_t* d) {
+#if PSORT_HAVE_X86_SIMD
+    const int level = psort_simd_level();
+    if (level >= PSORT_SIMD_AVX512) { diff_scan_avx512(keys, n, limbs, base, w, wn, d); return; }
+    if (level >= PSORT_SIMD_AVX2)   { diff_scan_avx2(keys, n, limbs, base, w, wn, d); return; }
+#endif
+    diff_scan_scalar(keys, n, limbs, base, w, wn, d);
+}
+
+size_t psort_simd_partition_bit(uint64_t* keys, size_t n, size_t limbs,
+                                size_t word, int shift) {
+#if PSORT_HAVE_X86_SIMD
+    if (n >= 2 * (8 / limbs)) return partition_bit_avx512(keys, n, limbs, word, shift);
+#endif
+    // Scalar two pointer partition (small n / no AVX-512 build).
+    size_t i = 0, j = n;
+    for (;;) {
+        while (i < j && ((keys[i * limbs + word] >> shift) & 1ULL) == 0) i++;
+        while (i < j && ((keys[(j - 1) * limbs + word] >> shift) & 1ULL) != 0) j--;
+        if (i >= j) break;
+        for (size_t l = 0; l < limbs; l++) {
+            uint64_t t = keys[i * limbs + l];
+            keys[i * limbs + l] = keys[(j - 1) * limbs + l];
+            keys[(j - 1) * limbs + l] = t;
+        }
+        i++;
+        j--;
+    }
+    return i;
+}
+
+void psort_simd_idx_digits(const uint32_t* idx, size_t n, const uint64_t* keys,
+                           size_t limbs, size_t word, int shift, int width,
+                           uint16_t* out) {
+#if PSORT_HAVE_X86_SIMD
+    // AVX-512 only: AVX2 gathers measured no faster than scalar loads.
+    if (psort_simd_level() >= PSORT_SIMD_AVX512) { idx_digits_avx512(idx, n, keys, limbs, word, shift, width, out); return; }
+#endif
+    idx_digits_scalar(idx, n, keys, limbs, word, shift, width, out);
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Vector kernels shared by the sorters, selected once per process from cpuid.
+// Keys are viewed as arrays of 64-bit words, `limbs` words per key, most
+// significant word first (u128 = {hi, lo}, u256 = {w3..w0}, ...).
+
+enum {
+    PSORT_SIMD_SCALAR = 0,
+    PSORT_SIMD_AVX2   = 1,
+    PSORT_SIMD_AVX512 = 2
+};
+
+// Best level this CPU supports (cached after the first call / at load time).
+// The environment variable PIPESORT_SIMD=scalar|avx2|avx512 can lower it.
+int psort_simd_level(void);
+
+// OR-diff scan: d[l] |= keys[i*limbs + w + l] ^ base[w + l] for all i < n, l < wn.
+// wn <= 8. When the window is the whole key and limbs is 1, 2, 4 or 8, the
+// keys are scanned as one flat word stream.
+void psort_simd_diff_scan(const uint64_t* keys, size_t n, size_t limbs,
+                          const uint64_t* base, size_t w, size_t wn, uint64_t* d);
+
+// In place partition of n keys (limbs = 2, 4 or 8) on bit `shift` of word
+// `word`: keys with the bit clear come first, their count is returned.
+// Uses AVX-512 compress stores; only valid when psort_simd_level() is AVX512.
+size_t psort_simd_partition_bit(uint64_t* keys, size_t n, size_t limbs,
+                                size_t word, int shift);
+
+// Digit extraction for the index sorts: out[i] = `width` (<= 16) bits of key
+// idx[i], starting at bit `shift` of word `word`. If the digit straddles the
+// word (shift + width > 64) its upper bits come from word - 1. Vectorized
+// with AVX-512 gathers only; other levels run the scalar loop.
+void psort_simd_idx_digits(const uint32_t* idx, size_t n, const uint64_t* keys,
+                           size_t limbs, size_t word, int shift, int width,
+                           uint16_t* out);
+
+#ifdef __cplusplus
+}
+#endif
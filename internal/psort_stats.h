@@ -0,0 +1,80 @@
+#pragma once
+#include <stdint.h>
+
+#include "pipesort/pipesort.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Instrumentation hooks for psort_stats. Only builds with PIPESORT_STATS
+// defined count anything; otherwise every macro below expands to nothing
+// (or a no-op expression), so the default build carries no extra code.
+//
+// Counters are per thread: a sort adds to the calling thread's psort_stats,
+// workers of the parallel sorts to their own.
+
+#ifdef PIPESORT_STATS
+
+typedef struct {
+    psort_stats s;
+    uint64_t depth; // current nesting of recursive levels
+} psort_stats_tls;
+
+extern _Thread_local psort_stats_tls psort_tls_stats;
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+static inline uint64_t psort_stats_clock(void) { return (uint64_t)__rdtsc(); }
+#else
+#include <time.h>
+static inline uint64_t psort_stats_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+#define PSORT_STAT_ADD(field, v) (psort_tls_stats.s.field += (uint64_t)(v))
+#define PSORT_STAT_MAX(field, v) do {                                   \
+        const uint64_t psort_v_ = (uint64_t)(v);                        \
+        if (psort_v_ > psort_tls_stats.s.field) psort_tls_stats.s.field = psort_v_; \
+    } while (0)
+// PSORT_STAT_CLOCK(t) declares the start stamp t, PSORT_STAT_CYCLES adds
+// the time since t to a cycles_* field.
+#define PSORT_STAT_CLOCK(t)        const uint64_t t = psort_stats_clock()
+#define PSORT_STAT_CYCLES(field, t) PSORT_STAT_ADD(field, psort_stats_clock() - (t))
+// Recursive engines bracket each frame; iterative ones report their stack depth.
+#define PSORT_STAT_ENTER() do {                                         \
+        psort_tls_stats.depth++;                                        \
+        PSORT_STAT_MAX(max_depth, psort_tls_stats.depth);               \
+    } while (0)
+#define PSORT_STAT_LEAVE() (psort_tls_stats.depth--)
+#define PSORT_STAT_DEPTH(d) PSORT_STAT_MAX(max_depth, d)
+#define PSORT_STAT_LEAF(n) do {                                         \
+        PSORT_STAT_ADD(leaf_calls, 1);                                  \
+        PSORT_STAT_ADD(leaf_elems, n);                                  \
+        PSORT_STAT_MAX(max_leaf, n);                                    \
+    } while (0)
+#define PSORT_STAT_MOVE(count, elem_bytes) do {                         \
+        PSORT_STAT_ADD(elems_moved, count);                             \
+        PSORT_STAT_ADD(bytes_moved, (uint64_t)(count) * (uint64_t)(elem_bytes)); \
+    } while (0)
+
+#else
+
+#define PSORT_STAT_ADD(field, v)    ((void)0)
+#define PSORT_STAT_MAX(field, v)    ((void)0)
+#define PSORT_STAT_CLOCK(t)         ((void)0)
+#define PSORT_STAT_CYCLES(field, t) ((void)0)
+#define PSORT_STAT_ENTER()          ((void)0)
+#define PSORT_STAT_LEAVE()          ((void)0)
+#define PSORT_STAT_DEPTH(d)         ((void)0)
+#define PSORT_STAT_LEAF(n)          ((void)0)
+#define PSORT_STAT_MOVE(count, elem_bytes) ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,151 @@
+#include "psort_strided.h"
+#include "psort_bits.h"
+#include <string.h>
+
+// Word l of a key is an unaligned 8 byte load at rec + key_offset + 8 * l;
+// bit p (0 = MSB of word 0) is bit 63 - p % 64 of word p / 64. Both sorts
+// are shared engines: psort_inplace.h swapping `stride` bytes per move, and
+// psort_idx_radix.h gathering words through idx.
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PSORT_STRIDED_INLINE inline __attribute__((always_inline))
+#else
+#define PSORT_STRIDED_INLINE inline
+#endif
+
+#define STRIDED_MAX_LIMBS 4
+
+static inline uint64_t load_word(const uint8_t* key, size_t l) {
+    uint64_t x;
+    memcpy(&x, key + 8 * l, 8);
+    return x;
+}
+
+static PSORT_STRIDED_INLINE void swap_rec(uint8_t* a, uint8_t* b, size_t stride) {
+    size_t i = 0;
+    for (; i + 8 <= stride; i += 8) {
+        uint64_t x, y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        memcpy(a + i, &y, 8);
+        memcpy(b + i, &x, 8);
+    }
+    for (; i < stride; i++) {
+        const uint8_t t = a[i];
+        a[i] = b[i];
+        b[i] = t;
+    }
+}
+
+// 1 if key a > key b; words before `from` are equal.
+static PSORT_STRIDED_INLINE int key_gt(const uint8_t* a, const uint8_t* b, size_t from, size_t limbs) {
+    for (size_t l = from; l < limbs; l++) {
+        const uint64_t x = load_word(a, l);
+        const uint64_t y = load_word(b, l);
+        if (x != y) return x > y;
+    }
+    return 0;
+}
+
+// ---------------- in place sort ----------------
+//
+// The shared psort_inplace.h engine: keys points at the key of record 0,
+// record i's key is keys + i * stride, swaps move whole records and a range
+// remembers the word of its split bit.
+
+typedef struct {
+    size_t stride;
+    size_t key_offset;
+    size_t limbs;
+} ip_keys;
+
+static inline size_t ip_key_bits(const ip_keys* K) { return K->limbs * 64; }
+static inline size_t ip_step(const ip_keys* K) { return K->stride; }
+static inline size_t ip_unit(const ip_keys* K, size_t bit) { (void)K; return bit / 64; }
+
+static PSORT_STRIDED_INLINE unsigned ip_bit(const ip_keys* K, const uint8_t* key, size_t bit) {
+    (void)K;
+    return (unsigned)(load_word(key, bit / 64) >> (63 - bit % 64)) & 1u;
+}
+
+static PSORT_STRIDED_INLINE void ip_swap(const ip_keys* K, uint8_t* a, uint8_t* b) {
+    swap_rec(a - K->key_offset, b - K->key_offset, K->stride);
+}
+
+static PSORT_STRIDED_INLINE int ip_key_gt(const ip_keys* K, const uint8_t* a, const uint8_t* b,
+                                          size_t top) {
+    return key_gt(a, b, top, K->limbs);
+}
+
+// Highest bit where keys 1..n-1 differ from key 0, from word `top` on.
+// Returns 0 if all keys are equal, else sets *bit.
+static PSORT_STRIDED_INLINE int ip_diff_scan(const ip_keys* K, const uint8_t* keys, size_t n,
+                                             size_t top, size_t* bit) {
+    uint64_t d[STRIDED_MAX_LIMBS] = {0, 0, 0, 0};
+    for (size_t i = 1; i < n; i++) {
+        const uint8_t* k = keys + i * K->stride;
+        for (size_t l = top; l < K->limbs; l++) d[l] |= load_word(k, l) ^ load_word(keys, l);
+    }
+    for (size_t l = top; l < K->limbs; l++) {
+        if (d[l]) {
+            *bit = 64 * l + (size_t)psort_clz64(d[l]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#include "psort_inplace.h"
+
+static PSORT_STRIDED_INLINE void strided_sort(uint8_t* base, size_t n, size_t stride,
+                                              size_t key_offset, size_t limbs) {
+    const ip_keys K = { stride, key_offset, limbs };
+    inplace_sort(&K, base + key_offset, n);
+}
+
+void psort_strided_sort(uint8_t* base, size_t n, size_t stride, size_t key_offset,
+                        size_t limbs) {
+    if (!base || n <= 1 || limbs == 0 || limbs > STRIDED_MAX_LIMBS) return;
+    if (key_offset + 8 * limbs > stride) return;
+
+    if (limbs == 2)      strided_sort(base, n, stride, key_offset, 2);
+    else if (limbs == 4) strided_sort(base, n, stride, key_offset, 4);
+    else                 strided_sort(base, n, stride, key_offset, limbs);
+}
+
+// ---------------- index sort ----------------
+//
+// The shared adaptive radix engine over strided keys.
+
+typedef struct {
+    const uint8_t* keys; // key of record 0
+    size_t stride;
+    size_t limbs;
+} idx_keys;
+
+static inline size_t idx_key_bits(const idx_keys* K) { return K->limbs * 64; }
+
+// `w` (<= 11) bits starting at bit `pos` (from the top of the key).
+static inline unsigned idx_digit(const idx_keys* K, uint32_t id, size_t pos, int w) {
+    const uint8_t* k = K->keys + (size_t)id * K->stride;
+    const size_t word = pos / 64;
+    const unsigned off = (unsigned)(pos % 64);
+    uint64_t v = load_word(k, word) << off;
+    if (off + (unsigned)w > 64 && word + 1 < K->limbs) v |= load_word(k, word + 1) >> (64 - off);
+    return (unsigned)(v >> (64 - w));
+}
+
+static inline int idx_key_gt(const idx_keys* K, uint32_t a, uint32_t b, size_t pos) {
+    return key_gt(K->keys + (size_t)a * K->stride, K->keys + (size_t)b * K->stride, pos / 64, K->limbs);
+}
+
+#include "psort_idx_radix.h"
+
+void psort_strided_index_sort(uint32_t* idx, uint32_t* tmp, const uint8_t* base, int n,
+                              size_t stride, size_t key_offset, size_t limbs) {
+    if (!idx || !tmp || !base || n <= 1 || limbs == 0 || limbs > STRIDED_MAX_LIMBS) return;
+    if (key_offset + 8 * limbs > stride) return;
+
+    const idx_keys K = { base + key_offset, stride, limbs };
+    idx_radix_sort(idx, tmp, &K, n);
+}
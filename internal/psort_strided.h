@@ -0,0 +1,28 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sorts of fixed size records by an embedded key: record i starts at
+// base + i * stride, its key is `limbs` host order 64-bit words, most
+// significant first (the psort_u128_t / psort_u256_t layout), at byte
+// key_offset of the record. Keys are read in place with unaligned loads;
+// nothing is copied out.
+
+// In place: the psort_u scheme (diff scan, bit probe, block partition,
+// insertion sort at the leaves) moving whole records.
+void psort_strided_sort(uint8_t* base, size_t n, size_t stride, size_t key_offset,
+                        size_t limbs);
+
+// Index sort: record idx[i] ascending by key, stable. idx holds a
+// permutation of 0..n-1, tmp has n entries. Adaptive MSD radix (11 down to
+// 4 bit digits, as psort_u256_index).
+void psort_strided_index_sort(uint32_t* idx, uint32_t* tmp, const uint8_t* base, int n,
+                              size_t stride, size_t key_offset, size_t limbs);
+
+#ifdef __cplusplus
+}
+#endif
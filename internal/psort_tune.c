@@ -0,0 +1,142 @@
+#include "psort_tune.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+psort_profile psort_tune_active;
+atomic_int psort_tune_ready;
+
+#define PROFILE_MAGIC "# pipesort profile 1"
+
+static const struct { const char* name; size_t off; } fields[] = {
+    { "u128_cutoff",           offsetof(psort_profile, u128_cutoff) },
+    { "u256_cutoff",           offsetof(psort_profile, u256_cutoff) },
+    { "u512_cutoff",           offsetof(psort_profile, u512_cutoff) },
+    { "u_cutoff",              offsetof(psort_profile, u_cutoff) },
+    { "radix_cutoff",          offsetof(psort_profile, radix_cutoff) },
+    { "radix_bits6_min",       offsetof(psort_profile, radix_bits6_min) },
+    { "radix_bits8_min",       offsetof(psort_profile, radix_bits8_min) },
+    { "radix_bits11_min",      offsetof(psort_profile, radix_bits11_min) },
+    { "u512_radix_cutoff",     offsetof(psort_profile, u512_radix_cutoff) },
+    { "u512_radix_bits6_min",  offsetof(psort_profile, u512_radix_bits6_min) },
+    { "u512_radix_bits8_min",  offsetof(psort_profile, u512_radix_bits8_min) },
+    { "u512_radix_bits11_min", offsetof(psort_profile, u512_radix_bits11_min) },
+    { "u128_generic_min",      offsetof(psort_profile, u128_generic_min) },
+    { "u256_generic_min",      offsetof(psort_profile, u256_generic_min) },
+    { "u512_generic_min",      offsetof(psort_profile, u512_generic_min) },
+};
+#define NFIELDS (sizeof(fields) / sizeof(fields[0]))
+
+static int* field_at(psort_profile* p, size_t i) {
+    return (int*)(void*)((char*)p + fields[i].off);
+}
+
+void psort_tune_defaults(psort_profile* p) {
+    if (!p) return;
+    p->u128_cutoff = 48;
+    p->u256_cutoff = 32;
+    p->u512_cutoff = 24;
+    p->u_cutoff = 16;
+    p->radix_cutoff = 96;
+    p->radix_bits6_min = 1 << 11;
+    p->radix_bits8_min = 1 << 15;
+    p->radix_bits11_min = 1 << 21;
+    p->u512_radix_cutoff = 96;
+    p->u512_radix_bits6_min = 1 << 11;
+    p->u512_radix_bits8_min = 1 << 15;
+    p->u512_radix_bits11_min = 1 << 21;
+    p->u128_generic_min = INT_MAX;
+    p->u256_generic_min = INT_MAX;
+    p->u512_generic_min = INT_MAX;
+}
+
+static int clamp(int v, int lo, int hi) {
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+void psort_tune_sanitize(psort_profile* p) {
+    // Leaves are insertion sorts: past a few hundred keys they only lose.
+    p->u128_cutoff = clamp(p->u128_cutoff, 2, 1024);
+    p->u256_cutoff = clamp(p->u256_cutoff, 2, 1024);
+    p->u512_cutoff = clamp(p->u512_cutoff, 2, 1024);
+    p->u_cutoff = clamp(p->u_cutoff, 2, 1024);
+    p->radix_cutoff = clamp(p->radix_cutoff, 2, 1024);
+    p->radix_bits6_min = clamp(p->radix_bits6_min, 1, INT_MAX);
+    p->radix_bits8_min = clamp(p->radix_bits8_min, p->radix_bits6_min, INT_MAX);
+    p->radix_bits11_min = clamp(p->radix_bits11_min, p->radix_bits8_min, INT_MAX);
+    p->u512_radix_cutoff = clamp(p->u512_radix_cutoff, 2, 1024);
+    p->u512_radix_bits6_min = clamp(p->u512_radix_bits6_min, 1, INT_MAX);
+    p->u512_radix_bits8_min = clamp(p->u512_radix_bits8_min, p->u512_radix_bits6_min, INT_MAX);
+    p->u512_radix_bits11_min = clamp(p->u512_radix_bits11_min, p->u512_radix_bits8_min, INT_MAX);
+    p->u128_generic_min = clamp(p->u128_generic_min, 0, INT_MAX);
+    p->u256_generic_min = clamp(p->u256_generic_min, 0, INT_MAX);
+    p->u512_generic_min = clamp(p->u512_generic_min, 0, INT_MAX);
+}
+
+void psort_tune_install(const psort_profile* p) {
+    psort_profile v;
+    if (p) v = *p;
+    else   psort_tune_defaults(&v);
+    psort_tune_sanitize(&v);
+    psort_tune_active = v;
+    atomic_store_explicit(&psort_tune_ready, 1, memory_order_release);
+}
+
+void psort_tune_init(void) {
+    psort_profile p;
+    const char* path = getenv("PIPESORT_PROFILE");
+    if (!path || !*path || psort_tune_read(path, &p) != 0) psort_tune_defaults(&p);
+    psort_tune_install(&p);
+}
+
+// Missing keys keep their defaults, unknown ones are skipped, so profiles
+// written by older or newer builds still load.
+int psort_tune_read(const char* path, psort_profile* p) {
+    if (!path || !p) { errno = EINVAL; return -1; }
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+
+    psort_profile v;
+    psort_tune_defaults(&v);
+    char line[128];
+    int ok = fgets(line, sizeof(line), f) && strncmp(line, PROFILE_MAGIC, strlen(PROFILE_MAGIC)) == 0;
+    while (ok && fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        char name[64];
+        long val;
+        if (sscanf(line, "%63s %ld", name, &val) != 2 || val < 0 || val > INT_MAX) {
+            ok = 0;
+            break;
+        }
+        for (size_t i = 0; i < NFIELDS; i++) {
+            if (strcmp(name, fields[i].name) == 0) *field_at(&v, i) = (int)val;
+        }
+    }
+    const int rd_err = ferror(f);
+    fclose(f);
+    if (!ok || rd_err) { errno = rd_err ? EIO : EINVAL; return -1; }
+
+    psort_tune_sanitize(&v);
+    *p = v;
+    return 0;
+}
+
+int psort_tune_write(const char* path, const psort_profile* p) {
+    if (!path || !p) { errno = EINVAL; return -1; }
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+
+    psort_profile v = *p;
+    fprintf(f, "%s\n", PROFILE_MAGIC);
+    for (size_t i = 0; i < NFIELDS; i++) fprintf(f, "%s %d\n", fields[i].name, *field_at(&v, i));
+    const int wr_err = ferror(f);
+    if (fclose(f) != 0 || wr_err) {
+        if (wr_err) errno = EIO;
+        return -1;
+    }
+    return 0;
+}
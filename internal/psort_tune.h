@@ -0,0 +1,62 @@
+#pragma once
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "pipesort/pipesort.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Active psort_profile: leaf cutoffs, radix digit width thresholds and the
+// per width engine choice the sort entry points consult. Starts from the
+// built in defaults, or from the file named by PIPESORT_PROFILE on first use;
+// psort_set_profile / psort_tune replace it.
+
+extern psort_profile psort_tune_active;
+extern atomic_int psort_tune_ready;
+
+void psort_tune_init(void);
+
+static inline const psort_profile* psort_tune_profile(void) {
+    if (!atomic_load_explicit(&psort_tune_ready, memory_order_acquire)) psort_tune_init();
+    return &psort_tune_active;
+}
+
+// Leaf size and digit width (11, 8, 6 or 4 bits for a range of n keys) of
+// the radix index sorts over keys of `limbs` 64-bit words: the u512_radix_
+// fields for 8 words, the shared radix_ ones otherwise.
+static inline int psort_tune_radix_cutoff(const psort_profile* p, size_t limbs) {
+    return limbs == 8 ? p->u512_radix_cutoff : p->radix_cutoff;
+}
+
+static inline int psort_tune_digit_width(const psort_profile* p, size_t limbs, int n) {
+    if (limbs == 8) {
+        if (n >= p->u512_radix_bits11_min) return 11;
+        if (n >= p->u512_radix_bits8_min) return 8;
+        if (n >= p->u512_radix_bits6_min) return 6;
+        return 4;
+    }
+    if (n >= p->radix_bits11_min) return 11;
+    if (n >= p->radix_bits8_min) return 8;
+    if (n >= p->radix_bits6_min) return 6;
+    return 4;
+}
+
+// Built in values, the constants the engines shipped with.
+void psort_tune_defaults(psort_profile* p);
+
+// Clamps a profile into the ranges the engines accept (cutoffs >= 2,
+// ascending digit width thresholds, engine thresholds >= 0).
+void psort_tune_sanitize(psort_profile* p);
+
+// Makes p (defaults if NULL, sanitized) the active profile.
+void psort_tune_install(const psort_profile* p);
+
+// Text profile I/O ("key value" lines). Return 0, or -1 with errno set.
+int psort_tune_read(const char* path, psort_profile* p);
+int psort_tune_write(const char* path, const psort_profile* p);
+
+#ifdef __cplusplus
+}
+#endif
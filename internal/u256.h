@@ -13,6 +13,14 @@ typedef struct {
     uint64_t w0;
 } u256;
 
+static inline int u256_cmp(const u256* a, const u256* b) {
+    if (a->w3 != b->w3) return a->w3 < b->w3 ? -1 : 1;
+    if (a->w2 != b->w2) return a->w2 < b->w2 ? -1 : 1;
+    if (a->w1 != b->w1) return a->w1 < b->w1 ? -1 : 1;
+    if (a->w0 != b->w0) return a->w0 < b->w0 ? -1 : 1;
+    return 0;
+}
+
 #ifdef __cplusplus
 }
 #endif
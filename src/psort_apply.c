@@ -0,0 +1,20 @@
+#include "pipesort/pipesort.h"
+#include "psort_apply.h"
+
+void psort_apply_index(void* out, const void* src, const uint32_t* idx,
+                       int n, size_t width) {
+    if (n <= 0) return;
+    psort_gather((uint8_t*)out, (const uint8_t*)src, idx, (size_t)n, width);
+}
+
+void psort_apply_index_columns(void* const* outs, const void* const* srcs,
+                               const size_t* widths, size_t ncols,
+                               const uint32_t* idx, int n) {
+    if (n <= 0) return;
+    psort_gather_columns(outs, srcs, widths, ncols, idx, (size_t)n);
+}
+
+void psort_apply_index_inplace(void* data, uint32_t* idx, int n, size_t width) {
+    if (n <= 1) return;
+    psort_permute_inplace((uint8_t*)data, idx, (size_t)n, width);
+}
@@ -0,0 +1,11 @@
+#include "pipesort/pipesort.h"
+#include "psort_bytes.h"
+
+void psort_bytes(void* keys, size_t n, size_t width) {
+    psort_bytes_sort((uint8_t*)keys, n, width);
+}
+
+void psort_bytes_index(uint32_t* idx, uint32_t* tmp, const void* bytes,
+                       int n, size_t width) {
+    psort_bytes_index_sort(idx, tmp, (const uint8_t*)bytes, n, width);
+}
@@ -0,0 +1,10 @@
+#include "pipesort/pipesort.h"
+#include "psort_partition.h"
+
+void psort_set_partition(int mode) {
+    psort_partition_set_mode(mode);
+}
+
+int psort_get_partition(void) {
+    return psort_partition_mode();
+}
@@ -0,0 +1,66 @@
+#include "pipesort/pipesort.h"
+#include "psort_scratch.h"
+
+#include <errno.h>
+
+/* psort_ctx is the opaque public name of psort_arena. */
+psort_ctx* psort_ctx_create(const psort_allocator* a, unsigned flags) {
+    return (psort_ctx*)psort_arena_create(a, flags);
+}
+
+void psort_ctx_destroy(psort_ctx* ctx) {
+    psort_arena_destroy((psort_arena*)ctx);
+}
+
+int psort_ctx_reserve(psort_ctx* ctx, size_t bytes) {
+    return psort_arena_reserve((psort_arena*)ctx, bytes);
+}
+
+size_t psort_ctx_capacity(const psort_ctx* ctx) {
+    return psort_arena_capacity((const psort_arena*)ctx);
+}
+
+size_t psort_ctx_peak(const psort_ctx* ctx) {
+    return psort_arena_peak((const psort_arena*)ctx);
+}
+
+psort_ctx* psort_ctx_bind(psort_ctx* ctx) {
+    return (psort_ctx*)psort_scratch_bind((psort_arena*)ctx);
+}
+
+void* psort_ctx_alloc(psort_ctx* ctx, size_t bytes) {
+    return psort_arena_alloc((psort_arena*)ctx, bytes);
+}
+
+void psort_ctx_free(psort_ctx* ctx, void* p) {
+    psort_arena_free((psort_arena*)ctx, p);
+}
+
+// tmp from the context, which is also bound for the engine's own scratch.
+int psort_u256_index_ctx(psort_ctx* ctx, uint32_t* idx, const psort_u256_t* keys, int n) {
+    if (n <= 1) return 0;
+    uint32_t* tmp = (uint32_t*)psort_ctx_alloc(ctx, (size_t)n * sizeof(uint32_t));
+    if (!tmp) {
+        errno = ENOMEM;
+        return -1;
+    }
+    psort_ctx* prev = psort_ctx_bind(ctx);
+    psort_u256_index(idx, tmp, keys, n);
+    psort_ctx_bind(prev);
+    psort_ctx_free(ctx, tmp);
+    return 0;
+}
+
+int psort_u512_index_ctx(psort_ctx* ctx, uint32_t* idx, const psort_u512_t* keys, int n) {
+    if (n <= 1) return 0;
+    uint32_t* tmp = (uint32_t*)psort_ctx_alloc(ctx, (size_t)n * sizeof(uint32_t));
+    if (!tmp) {
+        errno = ENOMEM;
+        return -1;
+    }
+    psort_ctx* prev = psort_ctx_bind(ctx);
+    psort_u512_index(idx, tmp, keys, n);
+    psort_ctx_bind(prev);
+    psort_ctx_free(ctx, tmp);
+    return 0;
+}
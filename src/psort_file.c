@@ -0,0 +1,17 @@
+#include "pipesort/pipesort.h"
+#include "psort_extsort.h"
+
+int psort_file_u128(const char* in_path, const char* out_path,
+                    size_t mem_budget, const char* tmp_dir) {
+    return psort_ext_sort(in_path, out_path, 16, mem_budget, tmp_dir);
+}
+
+int psort_file_u256(const char* in_path, const char* out_path,
+                    size_t mem_budget, const char* tmp_dir) {
+    return psort_ext_sort(in_path, out_path, 32, mem_budget, tmp_dir);
+}
+
+int psort_file_u512(const char* in_path, const char* out_path,
+                    size_t mem_budget, const char* tmp_dir) {
+    return psort_ext_sort(in_path, out_path, 64, mem_budget, tmp_dir);
+}
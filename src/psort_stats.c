@@ -0,0 +1,34 @@
+#include "pipesort/pipesort.h"
+#include "psort_stats.h"
+#include <string.h>
+
+#ifdef PIPESORT_STATS
+
+_Thread_local psort_stats_tls psort_tls_stats;
+
+int psort_stats_enabled(void) {
+    return 1;
+}
+
+void psort_stats_reset(void) {
+    memset(&psort_tls_stats, 0, sizeof(psort_tls_stats));
+}
+
+void psort_stats_get(psort_stats* out) {
+    if (out) *out = psort_tls_stats.s;
+}
+
+#else
+
+int psort_stats_enabled(void) {
+    return 0;
+}
+
+void psort_stats_reset(void) {
+}
+
+void psort_stats_get(psort_stats* out) {
+    if (out) memset(out, 0, sizeof(*out));
+}
+
+#endif
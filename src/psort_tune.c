@@ -0,0 +1,218 @@
+#include "pipesort/pipesort.h"
+#include "psort_tune.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+void psort_profile_default(psort_profile* p) {
+    psort_tune_defaults(p);
+}
+
+void psort_get_profile(psort_profile* p) {
+    if (p) *p = *psort_tune_profile();
+}
+
+void psort_set_profile(const psort_profile* p) {
+    psort_tune_install(p);
+}
+
+int psort_profile_load(const char* path, psort_profile* p) {
+    return psort_tune_read(path, p);
+}
+
+int psort_profile_save(const char* path, const psort_profile* p) {
+    return psort_tune_write(path, p);
+}
+
+// ---------------- tuner ----------------
+//
+// One parameter at a time, the others held at their current best: install a
+// candidate profile, time the engine it steers on random keys (best of
+// TUNE_REPS, small inputs repeated up to TUNE_BATCH keys per measurement so
+// timer resolution does not decide; 4 * max_n for small max_n), keep the fastest. Order matters: leaf
+// cutoffs first with the width specialized engines, then the radix digit
+// widths, then the engine crossover with the tuned cutoffs in place.
+
+#define TUNE_REPS      3
+#define TUNE_BATCH     (1 << 18)
+#define TUNE_DEFAULT_N (1 << 20)
+#define TUNE_MIN_N     (1 << 12)
+#define TUNE_MAX_N     (1 << 24)
+#define TUNE_LEAF_N    (1 << 16) // leaf cutoffs only show at the bottom levels
+
+typedef struct {
+    uint64_t* keys; // random words, room for max_n 256-bit keys
+    uint64_t* work;
+    uint32_t* idx;
+    uint32_t* tmp;
+    size_t max_n;   // in 256-bit keys; 512-bit runs use half as many
+    int batch;      // keys sorted per measurement, small inputs repeated
+} tune_ctx;
+
+typedef enum { RUN_U128, RUN_U256, RUN_U512, RUN_U, RUN_INDEX, RUN_INDEX512 } tune_run;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// One sort of n keys of the engine `run` steers, on a fresh copy. Returns seconds.
+static double time_one(tune_ctx* c, tune_run run, int n) {
+    static const size_t limbs[] = { 2, 4, 8, 3, 4, 8 };
+    const size_t words = (size_t)n * limbs[run];
+    if (run == RUN_INDEX || run == RUN_INDEX512) {
+        for (int i = 0; i < n; i++) c->idx[i] = (uint32_t)i;
+    } else {
+        memcpy(c->work, c->keys, words * sizeof(uint64_t));
+    }
+
+    const double t0 = now_sec();
+    switch (run) {
+        case RUN_U128:  psort_u128((psort_u128_t*)c->work, n); break;
+        case RUN_U256:  psort_u256((psort_u256_t*)c->work, n); break;
+        case RUN_U512:  psort_u512((psort_u512_t*)c->work, n); break;
+        case RUN_U:     psort_u(c->work, (size_t)n, 3); break;
+        case RUN_INDEX: psort_u256_index(c->idx, c->tmp, (const psort_u256_t*)c->keys, n); break;
+        case RUN_INDEX512: psort_u512_index(c->idx, c->tmp, (const psort_u512_t*)c->keys, n); break;
+    }
+    return now_sec() - t0;
+}
+
+// Best of TUNE_REPS; each rep sorts batches of n keys until c->batch keys are done.
+static double time_run(tune_ctx* c, tune_run run, int n) {
+    const int batches = n >= c->batch ? 1 : c->batch / n;
+    double best = 0.0;
+    for (int r = 0; r < TUNE_REPS; r++) {
+        double t = 0.0;
+        for (int b = 0; b < batches; b++) t += time_one(c, run, n);
+        if (r == 0 || t < best) best = t;
+    }
+    return best;
+}
+
+// Sets *field (a member of p) to the fastest of cand[0..nc) for `run` at the
+// sizes in ns[0..nn), summed; p stays installed with the winner.
+static void tune_field(tune_ctx* c, psort_profile* p, int* field,
+                       const int* cand, int nc, tune_run run, const int* ns, int nn) {
+    int best = *field;
+    double best_t = 0.0;
+    for (int i = 0; i < nc; i++) {
+        *field = cand[i];
+        psort_tune_install(p);
+        double t = 0.0;
+        for (int k = 0; k < nn; k++) t += time_run(c, run, ns[k]);
+        if (i == 0 || t < best_t) {
+            best_t = t;
+            best = cand[i];
+        }
+    }
+    *field = best;
+    psort_tune_install(p);
+}
+
+// Radix digit widths: the three thresholds (bits[0..3) = 6, 8 and 11 bit
+// minimums of p) move together by a power of two, timed at max_n keys of
+// the run's width and at 1/16 of that.
+static int shifted(int v, int shift) {
+    return shift < 0 ? v >> -shift : v << shift;
+}
+
+static void tune_digit_widths(tune_ctx* c, psort_profile* p, int* const bits[3],
+                              tune_run run, int max_n) {
+    const int base[3] = { *bits[0], *bits[1], *bits[2] };
+    int best_shift = 0;
+    double best_t = 0.0;
+    for (int shift = -2; shift <= 2; shift++) {
+        for (int b = 0; b < 3; b++) *bits[b] = shifted(base[b], shift);
+        psort_tune_install(p);
+        const double t = time_run(c, run, max_n) + time_run(c, run, max_n / 16);
+        if (shift == -2 || t < best_t) {
+            best_t = t;
+            best_shift = shift;
+        }
+    }
+    for (int b = 0; b < 3; b++) *bits[b] = shifted(base[b], best_shift);
+    psort_tune_install(p);
+}
+
+// Width specialized engine vs psort_u: *generic_min becomes the smallest
+// tested size from which psort_u wins at every larger tested size.
+static void tune_engine(tune_ctx* c, psort_profile* p, int* generic_min, tune_run run, int max_n) {
+    int sizes[8], ns = 0;
+    for (int s = 1 << 10; s < max_n && ns < 7; s <<= 3) sizes[ns++] = s;
+    sizes[ns++] = max_n;
+
+    int from = INT_MAX;
+    for (int k = ns - 1; k >= 0; k--) {
+        *generic_min = INT_MAX;
+        psort_tune_install(p);
+        const double t_special = time_run(c, run, sizes[k]);
+        *generic_min = 0;
+        psort_tune_install(p);
+        const double t_generic = time_run(c, run, sizes[k]);
+        if (t_generic >= t_special) break;
+        from = sizes[k];
+    }
+    *generic_min = from;
+    psort_tune_install(p);
+}
+
+int psort_tune(psort_profile* out, size_t max_n) {
+    if (max_n == 0) max_n = TUNE_DEFAULT_N;
+    if (max_n < TUNE_MIN_N) max_n = TUNE_MIN_N;
+    if (max_n > TUNE_MAX_N) max_n = TUNE_MAX_N;
+
+    tune_ctx c;
+    c.max_n = max_n;
+    c.batch = max_n < TUNE_BATCH / 4 ? (int)max_n * 4 : TUNE_BATCH;
+    c.keys = (uint64_t*)malloc(max_n * 4 * sizeof(uint64_t));
+    c.work = (uint64_t*)malloc(max_n * 4 * sizeof(uint64_t));
+    c.idx = (uint32_t*)malloc(max_n * sizeof(uint32_t));
+    c.tmp = (uint32_t*)malloc(max_n * sizeof(uint32_t));
+    if (!c.keys || !c.work || !c.idx || !c.tmp) {
+        free(c.keys); free(c.work); free(c.idx); free(c.tmp);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    uint64_t s = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < max_n * 4; i++) {
+        s ^= s << 13; s ^= s >> 7; s ^= s << 17;
+        c.keys[i] = s;
+    }
+
+    psort_profile p;
+    psort_tune_defaults(&p);
+
+    const int leaf_n[1] = { (int)(max_n < TUNE_LEAF_N ? max_n : TUNE_LEAF_N) };
+    const int leaf_n512[1] = { leaf_n[0] / 2 };
+    static const int cut_u128[]  = { 16, 24, 32, 48, 64, 96 };
+    static const int cut_u256[]  = { 12, 16, 24, 32, 48, 64 };
+    static const int cut_u512[]  = { 8, 12, 16, 24, 32, 48 };
+    static const int cut_u[]     = { 8, 12, 16, 24, 32, 48 };
+    static const int cut_radix[] = { 32, 48, 64, 96, 128, 192 };
+#define NCAND(a) ((int)(sizeof(a) / sizeof((a)[0])))
+    tune_field(&c, &p, &p.u128_cutoff, cut_u128, NCAND(cut_u128), RUN_U128, leaf_n, 1);
+    tune_field(&c, &p, &p.u256_cutoff, cut_u256, NCAND(cut_u256), RUN_U256, leaf_n, 1);
+    tune_field(&c, &p, &p.u512_cutoff, cut_u512, NCAND(cut_u512), RUN_U512, leaf_n512, 1);
+    tune_field(&c, &p, &p.u_cutoff, cut_u, NCAND(cut_u), RUN_U, leaf_n, 1);
+    tune_field(&c, &p, &p.radix_cutoff, cut_radix, NCAND(cut_radix), RUN_INDEX, leaf_n, 1);
+    tune_field(&c, &p, &p.u512_radix_cutoff, cut_radix, NCAND(cut_radix), RUN_INDEX512, leaf_n512, 1);
+#undef NCAND
+    int* const bits256[3] = { &p.radix_bits6_min, &p.radix_bits8_min, &p.radix_bits11_min };
+    int* const bits512[3] = { &p.u512_radix_bits6_min, &p.u512_radix_bits8_min, &p.u512_radix_bits11_min };
+    tune_digit_widths(&c, &p, bits256, RUN_INDEX, (int)max_n);
+    tune_digit_widths(&c, &p, bits512, RUN_INDEX512, (int)max_n / 2);
+
+    tune_engine(&c, &p, &p.u128_generic_min, RUN_U128, (int)max_n);
+    tune_engine(&c, &p, &p.u256_generic_min, RUN_U256, (int)max_n);
+    tune_engine(&c, &p, &p.u512_generic_min, RUN_U512, (int)max_n / 2);
+
+    free(c.keys); free(c.work); free(c.idx); free(c.tmp);
+    if (out) *out = *psort_tune_profile();
+    return 0;
+}
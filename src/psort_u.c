@@ -1,47 +1,45 @@
 #include "pipesort/pipesort.h"
-
-#include <string.h>   // memcpy, memmove
-#include <stdlib.h>   // malloc, free
+#include "psort_bits.h"
+#include "psort_partition.h"
+#include "psort_runs.h"
+#include "psort_simd.h"
+#include "psort_stats.h"
+#include "psort_tune.h"
 
 // ---------------- helpers ----------------
+//
+// Same scheme as pipe_sort_u128, for any number of limbs:
+//   - OR-diff scan against the first key finds the highest bit that differs
+//     anywhere in the range, so a shared prefix of any length costs one scan
+//   - a child range first probes its parent's next bit (early exit, nearly
+//     free on random data) and only falls back to the diff scan if that bit is shared
+//   - partition on that bit, push the larger side, continue on the smaller
+//     (explicit stack, depth <= log2(n))
+//   - insertion sort at the leaves, no heap allocation
+// Limb counts 2..8 get their own copy of the engine with `limbs` constant,
+// so the per key loops are fully unrolled. Large diff scans go to the vector
+// kernels in psort_simd; partitions use the kernel psort_partition_pick chooses.
 
-static inline int psort_msb_pos_u64(uint64_t x) {
 #if defined(__GNUC__) || defined(__clang__)
-    return x ? (int)(63 - __builtin_clzll(x)) : -1;
+#define PSORT_U_INLINE inline __attribute__((always_inline))
 #else
-    if (!x) return -1;
-    int p = 0;
-    while (x >>= 1) p++;
-    return p;
+#define PSORT_U_INLINE inline
 #endif
-}
 
-static int psort_get_max_bit_u(const uint64_t* keys, size_t n, size_t limbs) {
-    int max_bit = -1;
-    for (size_t i = 0; i < n; i++) {
-        const uint64_t* k = keys + i * limbs;
-        for (size_t l = 0; l < limbs; l++) {
-            int bit = psort_msb_pos_u64(k[l]);
-            if (bit >= 0) {
-                int abs_bit = bit + (int)((limbs - 1 - l) * 64);
-                if (abs_bit > max_bit) max_bit = abs_bit;
-                break;
-            }
-        }
-    }
-    return max_bit;
-}
+#define PSORT_U_WINDOW 8    // limbs folded per diff scan pass / stack key buffer
+#define PSORT_U_STACK  64   // smaller side first: pending ranges <= log2(n)
+#define PSORT_U_SIMD_MIN 64 // below this the scalar loops win (call + setup cost)
 
-// returns 1 if a >= b (big endian limbs), else 0
-static int psort_ge_key(const uint64_t* a, const uint64_t* b, size_t limbs) {
-    for (size_t i = 0; i < limbs; i++) {
-        if (a[i] > b[i]) return 1;
-        if (a[i] < b[i]) return 0;
+// returns 1 if a > b (big endian limbs), else 0. Limbs before `from` are equal.
+static PSORT_U_INLINE int psort_gt_key(const uint64_t* a, const uint64_t* b,
+                                       size_t from, size_t limbs) {
+    for (size_t i = from; i < limbs; i++) {
+        if (a[i] != b[i]) return a[i] > b[i];
     }
-    return 1;
+    return 0;
 }
 
-static void psort_swap_key(uint64_t* a, uint64_t* b, size_t limbs) {
+static PSORT_U_INLINE void psort_swap_key(uint64_t* a, uint64_t* b, size_t limbs) {
     for (size_t i = 0; i < limbs; i++) {
         uint64_t t = a[i];
         a[i] = b[i];
@@ -49,79 +47,183 @@ static void psort_swap_key(uint64_t* a, uint64_t* b, size_t limbs) {
     }
 }
 
-static void psort_insertion_sort_u(uint64_t* keys, size_t n, size_t limbs) {
-    uint64_t* tmp = (uint64_t*)malloc(limbs * sizeof(uint64_t));
-    if (!tmp) return;
+static PSORT_U_INLINE void psort_insertion_sort_u(uint64_t* keys, size_t n,
+                                                  size_t limbs, size_t top) {
+    if (limbs <= PSORT_U_WINDOW) {
+        uint64_t tmp[PSORT_U_WINDOW];
+        for (size_t i = 1; i < n; i++) {
+            for (size_t l = 0; l < limbs; l++) tmp[l] = keys[i * limbs + l];
+
+            size_t j = i;
+            while (j > 0 && psort_gt_key(keys + (j - 1) * limbs, tmp, top, limbs)) {
+                for (size_t l = 0; l < limbs; l++) keys[j * limbs + l] = keys[(j - 1) * limbs + l];
+                j--;
+            }
+            for (size_t l = 0; l < limbs; l++) keys[j * limbs + l] = tmp[l];
+        }
+        return;
+    }
 
+    // Wider keys: sink by adjacent swaps, no key sized buffer needed.
     for (size_t i = 1; i < n; i++) {
-        memcpy(tmp, keys + i * limbs, limbs * sizeof(uint64_t));
-
         size_t j = i;
-        while (j > 0 && psort_ge_key(keys + (j - 1) * limbs, tmp, limbs)) {
-            memmove(keys + j * limbs,
-                    keys + (j - 1) * limbs,
-                    limbs * sizeof(uint64_t));
+        while (j > 0 && psort_gt_key(keys + (j - 1) * limbs, keys + j * limbs, top, limbs)) {
+            psort_swap_key(keys + (j - 1) * limbs, keys + j * limbs, limbs);
             j--;
         }
-        memcpy(keys + j * limbs, tmp, limbs * sizeof(uint64_t));
     }
-
-    free(tmp);
 }
 
-static void psort_pipe_sort_u(uint64_t* keys, size_t n, size_t limbs, int bit) {
-    const size_t SMALL = 16;
-    if (n <= 1 || bit < 0) return;
+// Highest bit where keys[1..n) differ from keys[0]. Limbs before `top` are
+// shared by the whole range and are not scanned (except when the key fits
+// one window: then scanning all limbs keeps the loop fully unrolled).
+// Returns 0 if all keys are equal, else sets *li (big endian limb) and *bit.
+static PSORT_U_INLINE int psort_diff_scan_u(const uint64_t* keys, size_t n, size_t limbs,
+                                            size_t top, size_t* li, int* bit) {
+    size_t w = limbs <= PSORT_U_WINDOW ? 0 : top;
+
+    for (; w < limbs; w += PSORT_U_WINDOW) {
+        const size_t wn = limbs - w < PSORT_U_WINDOW ? limbs - w : PSORT_U_WINDOW;
+        uint64_t d[PSORT_U_WINDOW] = {0, 0, 0, 0, 0, 0, 0, 0};
+        const uint64_t* b = keys + w;
+
+        if (n >= PSORT_U_SIMD_MIN && psort_simd_level() > PSORT_SIMD_SCALAR) {
+            psort_simd_diff_scan(keys + limbs, n - 1, limbs, keys, w, wn, d);
+        } else {
+            for (size_t i = 1; i < n; i++) {
+                const uint64_t* k = keys + i * limbs + w;
+                for (size_t l = 0; l < wn; l++) d[l] |= k[l] ^ b[l];
+            }
+        }
 
-    if (n <= SMALL) {
-        psort_insertion_sort_u(keys, n, limbs);
-        return;
+        for (size_t l = 0; l < wn; l++) {
+            if (d[l]) {
+                *li = w + l;
+                *bit = 63 - psort_clz64(d[l]);
+                return 1;
+            }
+        }
     }
+    return 0;
+}
 
-    size_t limb_index = (size_t)(limbs - 1 - (size_t)(bit / 64));
-    size_t bit_in_limb = (size_t)(bit % 64);
-
-    // Adaptive bit skip: check if all keys share this bit
-    uint64_t first_bit = (keys[0 * limbs + limb_index] >> bit_in_limb) & 1ULL;
-    int all_same = 1;
+// Early exit probe: does bit `bit` of limb `li` take both values in the range?
+// On random data this stops after a couple of keys, which is why a child range
+// tries its parent's next bit before paying for a full diff scan.
+static PSORT_U_INLINE int psort_bit_varies_u(const uint64_t* keys, size_t n, size_t limbs,
+                                             size_t li, int bit) {
+    const uint64_t first = (keys[li] >> bit) & 1ULL;
     for (size_t i = 1; i < n; i++) {
-        uint64_t b = (keys[i * limbs + limb_index] >> bit_in_limb) & 1ULL;
-        if (b != first_bit) { all_same = 0; break; }
-    }
-    if (all_same) {
-        psort_pipe_sort_u(keys, n, limbs, bit - 1);
-        return;
+        if (((keys[i * limbs + li] >> bit) & 1ULL) != first) return 1;
     }
+    return 0;
+}
 
-    // Partition by current bit
-    size_t left = 0;
-    size_t right = n - 1;
+// Keys with bit `bit` of limb `li` clear go left. Returns the split.
+static PSORT_U_INLINE size_t psort_partition_u(uint64_t* keys, size_t n, size_t limbs,
+                                               size_t li, int bit) {
+    const int kind = psort_partition_pick(n, limbs);
+    if (kind == PSORT_PART_SIMD && (limbs == 2 || limbs == 4 || limbs == 8) &&
+        n >= PSORT_U_SIMD_MIN) {
+        PSORT_STAT_MOVE(n, limbs * sizeof(uint64_t)); // compress stores rewrite the range
+        return psort_simd_partition_bit(keys, n, limbs, li, bit);
+    }
+    if (kind != PSORT_PART_HOARE && n > 2 * PSORT_BLOCK) {
+        return psort_block_partition_bit(keys, n, limbs, li, bit);
+    }
+    return psort_hoare_partition_bit(keys, n, limbs, li, bit);
+}
 
-    while (left <= right) {
-        uint64_t lb = (keys[left * limbs + limb_index] >> bit_in_limb) & 1ULL;
-        if (lb == 0) { left++; continue; }
+static PSORT_U_INLINE void psort_pipe_sort_u(uint64_t* keys, size_t n, size_t limbs) {
+    const size_t SMALL = (size_t)psort_tune_profile()->u_cutoff;
+
+    // Per range: `top` = limbs [0, top) are equal across the range,
+    // (hl, hb) = the bit right below the one the parent split on (hl == limbs: none).
+    struct { uint64_t* keys; size_t n; size_t top; size_t hl; int hb; } stack[PSORT_U_STACK];
+    int sp = 0;
+    size_t top = 0;
+    size_t hl = limbs;
+    int hb = 0;
+
+    for (;;) {
+        while (n > SMALL) {
+            size_t li;
+            int bit;
+            PSORT_STAT_CLOCK(t_scan);
+            PSORT_STAT_ADD(levels, 1);
+            if (hl < limbs && psort_bit_varies_u(keys, n, limbs, hl, hb)) {
+                li = hl;
+                bit = hb;
+            } else if (!psort_diff_scan_u(keys, n, limbs, top, &li, &bit)) {
+                PSORT_STAT_CYCLES(cycles_diff_scan, t_scan);
+                PSORT_STAT_ADD(skipped_levels, 1);
+                n = 0; // all equal in this range
+                break;
+            }
+            PSORT_STAT_CYCLES(cycles_diff_scan, t_scan);
+
+            PSORT_STAT_CLOCK(t_part);
+            const size_t split = psort_partition_u(keys, n, limbs, li, bit);
+            PSORT_STAT_CYCLES(cycles_partition, t_part);
+            PSORT_STAT_ADD(partitions, 1);
+            const size_t right_n = n - split;
+            top = li;
+            if (bit > 0)             { hl = li;     hb = bit - 1; }
+            else if (li + 1 < limbs) { hl = li + 1; hb = 63; }
+            else                     { hl = limbs;  hb = 0; }
+
+            // Keep the smaller side, defer the larger one.
+            stack[sp].top = top;
+            stack[sp].hl = hl;
+            stack[sp].hb = hb;
+            if (split < right_n) {
+                stack[sp].keys = keys + split * limbs;
+                stack[sp].n = right_n;
+                n = split;
+            } else {
+                stack[sp].keys = keys;
+                stack[sp].n = split;
+                keys += split * limbs;
+                n = right_n;
+            }
+            sp++;
+            PSORT_STAT_DEPTH(sp);
+        }
 
-        uint64_t rb = (keys[right * limbs + limb_index] >> bit_in_limb) & 1ULL;
-        if (rb == 1) { 
-            if (right == 0) break;
-            right--; 
-            continue; 
+        if (n > 0) {
+            PSORT_STAT_CLOCK(t_leaf);
+            psort_insertion_sort_u(keys, n, limbs, top);
+            PSORT_STAT_CYCLES(cycles_leaf, t_leaf);
+            PSORT_STAT_LEAF(n);
         }
 
-        psort_swap_key(keys + left * limbs, keys + right * limbs, limbs);
-        left++;
-        if (right == 0) break;
-        right--;
+        if (sp == 0) return;
+        sp--;
+        keys = stack[sp].keys;
+        n = stack[sp].n;
+        top = stack[sp].top;
+        hl = stack[sp].hl;
+        hb = stack[sp].hb;
     }
+}
 
-    psort_pipe_sort_u(keys, left, limbs, bit - 1);
-    psort_pipe_sort_u(keys + left * limbs, n - left, limbs, bit - 1);
+static void psort_u_generic(uint64_t* keys, size_t n, size_t limbs) {
+    psort_pipe_sort_u(keys, n, limbs);
 }
 
 // ---------------- public entry ----------------
 void psort_u(uint64_t* keys, size_t n, size_t limbs) {
     if (!keys || n <= 1 || limbs == 0) return;
-    int max_bit = psort_get_max_bit_u(keys, n, limbs);
-    if (max_bit < 0) return;
-    psort_pipe_sort_u(keys, n, limbs, max_bit);
+    if (psort_runs_presorted(keys, n, limbs, psort_u)) return;
+
+    switch (limbs) {
+        case 2: psort_pipe_sort_u(keys, n, 2); break;
+        case 3: psort_pipe_sort_u(keys, n, 3); break;
+        case 4: psort_pipe_sort_u(keys, n, 4); break;
+        case 5: psort_pipe_sort_u(keys, n, 5); break;
+        case 6: psort_pipe_sort_u(keys, n, 6); break;
+        case 7: psort_pipe_sort_u(keys, n, 7); break;
+        case 8: psort_pipe_sort_u(keys, n, 8); break;
+        default: psort_u_generic(keys, n, limbs); break;
+    }
 }
@@ -1,14 +1,123 @@
 #include "pipesort/pipesort.h"
 #include "pipe_sort_u128.h"
+#include "pipe_sort_u128_kv.h"
+#include "pipe_sort_u128_merge.h"
+#include "pipe_sort_u128_stable.h"
+#include "psort_lookup.h"
+#include "psort_runs.h"
+#include "psort_strided.h"
+#include "psort_tune.h"
 #include "u128.h"
+#include <limits.h>
 
 /* Layout compatibility:
  *   psort_u128 == u128  (hi, lo)
  */
+static void psort_u128_runs(uint64_t* keys, size_t n, size_t limbs) {
+    (void)limbs;
+    psort_u128((psort_u128_t*)keys, (int)n);
+}
+
 void psort_u128(psort_u128_t* keys, int n) {
-    pipe_sort_u128((u128*)keys, n);
+    if (n > 1 && psort_runs_presorted((uint64_t*)keys, (size_t)n, 2, psort_u128_runs)) return;
+    if (n >= psort_tune_profile()->u128_generic_min) psort_u((uint64_t*)keys, (size_t)(n > 0 ? n : 0), 2);
+    else                                             pipe_sort_u128((u128*)keys, n);
+}
+
+void psort_u128_large(psort_u128_t* keys, size_t n) {
+    if (n <= (size_t)INT_MAX) psort_u128(keys, (int)n);
+    else                      psort_u((uint64_t*)keys, n, 2);
+}
+
+void psort_u128_select(psort_u128_t* keys, int n, int k) {
+    pipe_sort_u128_select((u128*)keys, n, k);
+}
+
+void psort_u128_partial_sort(psort_u128_t* keys, int n, int k) {
+    pipe_sort_u128_partial((u128*)keys, n, k);
+}
+
+int psort_u128_unique(psort_u128_t* keys, int n, uint32_t* counts) {
+    return pipe_sort_u128_unique((u128*)keys, n, counts);
+}
+
+void psort_u128_parallel(psort_u128_t* keys, int n, int nthreads) {
+    pipe_sort_u128_parallel((u128*)keys, n, nthreads);
+}
+
+void psort_u128_kv(psort_u128_t* keys, void* vals, int n, size_t val_size) {
+    pipe_sort_u128_kv((u128*)keys, vals, n, val_size);
+}
+
+void psort_u128_stable(psort_u128_t* keys, psort_u128_t* tmp, int n) {
+    pipe_sort_u128_stable((u128*)keys, (u128*)tmp, n);
+}
+
+void psort_u128_kv_stable(psort_u128_t* keys, void* vals,
+                          psort_u128_t* tmp, void* tmp_vals,
+                          int n, size_t val_size) {
+    pipe_sort_u128_kv_stable((u128*)keys, vals, (u128*)tmp, tmp_vals, n, val_size);
+}
+
+void psort_u128_records(void* base, size_t n, size_t stride, size_t key_offset) {
+    psort_strided_sort((uint8_t*)base, n, stride, key_offset, 2);
+}
+
+void psort_u128_records_index(uint32_t* idx, uint32_t* tmp, const void* base, int n,
+                              size_t stride, size_t key_offset) {
+    psort_strided_index_sort(idx, tmp, (const uint8_t*)base, n, stride, key_offset, 2);
 }
 
 int psort_u128_is_sorted(const psort_u128_t* keys, int n) {
     return u128_is_sorted((const u128*)keys, n);
 }
+
+void psort_u128_merge(psort_u128_t* out,
+                      const psort_u128_t* a, size_t na,
+                      const psort_u128_t* b, size_t nb) {
+    u128_merge2((u128*)out, (const u128*)a, na, (const u128*)b, nb);
+}
+
+void psort_u128_merge_k(psort_u128_t* out, const psort_u128_t* const* runs,
+                        const size_t* lens, size_t k) {
+    u128_merge_k((u128*)out, (const u128* const*)runs, lens, k);
+}
+
+/* psort_u128_stream is the opaque public name of u128_stream. */
+psort_u128_stream* psort_u128_stream_create(void) {
+    return (psort_u128_stream*)u128_stream_create();
+}
+
+void psort_u128_stream_destroy(psort_u128_stream* s) {
+    u128_stream_destroy((u128_stream*)s);
+}
+
+int psort_u128_stream_push(psort_u128_stream* s, const psort_u128_t* keys, size_t n) {
+    return u128_stream_push((u128_stream*)s, (const u128*)keys, n);
+}
+
+size_t psort_u128_stream_size(const psort_u128_stream* s) {
+    return u128_stream_size((const u128_stream*)s);
+}
+
+void psort_u128_stream_finish(const psort_u128_stream* s, psort_u128_t* out) {
+    u128_stream_finish((const u128_stream*)s, (u128*)out);
+}
+
+/* psort_u128_dir is the opaque public name of psort_lookup. */
+psort_u128_dir* psort_u128_dir_build(const psort_u128_t* keys, size_t n, int bits) {
+    return (psort_u128_dir*)psort_lookup_build((const uint64_t*)keys, n, 2, bits);
+}
+
+void psort_u128_dir_destroy(psort_u128_dir* d) {
+    psort_lookup_destroy((psort_lookup*)d);
+}
+
+size_t psort_u128_lower_bound(const psort_u128_dir* d, const psort_u128_t* key) {
+    return psort_lookup_lower_bound((const psort_lookup*)d, (const uint64_t*)key);
+}
+
+void psort_u128_lower_bound_batch(const psort_u128_dir* d, const psort_u128_t* keys,
+                                  size_t m, size_t* out) {
+    psort_lookup_lower_bound_batch((const psort_lookup*)d, (const uint64_t*)keys, m, out);
+}
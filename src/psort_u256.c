@@ -1,12 +1,149 @@
 #include "pipesort/pipesort.h"
-#include "pipe_sort_u256_idx_radix8.h"
+#include "pipe_sort_u256.h"
+#include "psort_idx_words.h"
+#include "pipe_sort_u256_kv.h"
+#include "pipe_sort_u256_merge.h"
+#include "psort_hash.h"
+#include "psort_prefix.h"
+#include "psort_index64.h"
+#include "psort_lookup.h"
+#include "psort_runs.h"
+#include "psort_tune.h"
+#include "psort_strided.h"
 #include "u256.h"
+#include <limits.h>
 
 /* Layout compatibility:
  *   psort_u256 == u256  (w3,w2,w1,w0)
  */
+static void psort_u256_runs(uint64_t* keys, size_t n, size_t limbs)
+{
+    (void)limbs;
+    psort_u256((psort_u256_t*)keys, (int)n);
+}
+
+static void psort_u256_index_runs(uint32_t* idx, uint32_t* tmp, const uint64_t* keys,
+                                  int n, size_t limbs)
+{
+    (void)limbs;
+    psort_u256_index(idx, tmp, (const psort_u256_t*)keys, n);
+}
+
+void psort_u256(psort_u256_t* keys, int n)
+{
+    if (n > 1 && psort_runs_presorted((uint64_t*)keys, (size_t)n, 4, psort_u256_runs)) return;
+    if (n >= psort_tune_profile()->u256_generic_min) psort_u((uint64_t*)keys, (size_t)(n > 0 ? n : 0), 4);
+    else                                             pipe_sort_u256((u256*)keys, n);
+}
+
+int psort_u256_is_sorted(const psort_u256_t* keys, int n)
+{
+    return u256_is_sorted((const u256*)keys, n);
+}
+
 void psort_u256_index(uint32_t* idx, uint32_t* tmp,
                       const psort_u256_t* keys, int n)
 {
-    pipe_sort_u256_index_radix8_fixed(idx, tmp, (const u256*)keys, n);
+    if (n > 1 && psort_runs_presorted_index(idx, tmp, (const uint64_t*)keys, n, 4,
+                                            psort_u256_index_runs)) return;
+    psort_words_index_sort(idx, tmp, (const uint64_t*)keys, n, 4);
+}
+
+void psort_u256_large(psort_u256_t* keys, size_t n)
+{
+    if (n <= (size_t)INT_MAX) psort_u256(keys, (int)n);
+    else                      psort_u((uint64_t*)keys, n, 4);
+}
+
+void psort_u256_index64(uint64_t* idx, uint64_t* tmp,
+                        const psort_u256_t* keys, size_t n)
+{
+    psort_index64_sort(idx, tmp, (const uint64_t*)keys, n, 4);
+}
+
+void psort_u256_records(void* base, size_t n, size_t stride, size_t key_offset)
+{
+    psort_strided_sort((uint8_t*)base, n, stride, key_offset, 4);
+}
+
+void psort_u256_records_index(uint32_t* idx, uint32_t* tmp, const void* base, int n,
+                              size_t stride, size_t key_offset)
+{
+    psort_strided_index_sort(idx, tmp, (const uint8_t*)base, n, stride, key_offset, 4);
+}
+
+void psort_u256_index_select(uint32_t* idx, uint32_t* tmp,
+                             const psort_u256_t* keys, int n, int k)
+{
+    psort_words_index_select(idx, tmp, (const uint64_t*)keys, n, 4, k);
+}
+
+void psort_u256_index_partial_sort(uint32_t* idx, uint32_t* tmp,
+                                   const psort_u256_t* keys, int n, int k)
+{
+    psort_words_index_partial(idx, tmp, (const uint64_t*)keys, n, 4, k);
+}
+
+int psort_u256_index_unique(uint32_t* idx, uint32_t* tmp,
+                            const psort_u256_t* keys, int n, uint32_t* counts)
+{
+    return psort_words_index_unique(idx, tmp, (const uint64_t*)keys, n, 4, counts);
+}
+
+void psort_u256_index_cached(uint32_t* idx, uint32_t* tmp,
+                             const psort_u256_t* keys, int n)
+{
+    psort_prefix_index_sort(idx, tmp, (const uint64_t*)keys, n, 4);
+}
+
+void psort_u256_index_hash(uint32_t* idx, uint32_t* tmp,
+                           const psort_u256_t* keys, int n)
+{
+    psort_hash_index_sort(idx, tmp, (const uint64_t*)keys, n, 4);
+}
+
+void psort_u256_index_parallel(uint32_t* idx, uint32_t* tmp,
+                               const psort_u256_t* keys, int n, int nthreads)
+{
+    psort_words_index_parallel(idx, tmp, (const uint64_t*)keys, n, 4, nthreads);
+}
+
+void psort_u256_kv(psort_u256_t* keys, void* vals, int n, size_t val_size)
+{
+    pipe_sort_u256_kv((u256*)keys, vals, n, val_size);
+}
+
+void psort_u256_merge(psort_u256_t* out,
+                      const psort_u256_t* a, size_t na,
+                      const psort_u256_t* b, size_t nb)
+{
+    u256_merge2((u256*)out, (const u256*)a, na, (const u256*)b, nb);
+}
+
+void psort_u256_merge_k(psort_u256_t* out, const psort_u256_t* const* runs,
+                        const size_t* lens, size_t k)
+{
+    u256_merge_k((u256*)out, (const u256* const*)runs, lens, k);
+}
+
+/* psort_u256_dir is the opaque public name of psort_lookup. */
+psort_u256_dir* psort_u256_dir_build(const psort_u256_t* keys, size_t n, int bits)
+{
+    return (psort_u256_dir*)psort_lookup_build((const uint64_t*)keys, n, 4, bits);
+}
+
+void psort_u256_dir_destroy(psort_u256_dir* d)
+{
+    psort_lookup_destroy((psort_lookup*)d);
+}
+
+size_t psort_u256_lower_bound(const psort_u256_dir* d, const psort_u256_t* key)
+{
+    return psort_lookup_lower_bound((const psort_lookup*)d, (const uint64_t*)key);
+}
+
+void psort_u256_lower_bound_batch(const psort_u256_dir* d, const psort_u256_t* keys,
+                                  size_t m, size_t* out)
+{
+    psort_lookup_lower_bound_batch((const psort_lookup*)d, (const uint64_t*)keys, m, out);
 }
@@ -1,12 +1,93 @@
 #include "pipesort/pipesort.h"
-#include "pipe_sort_u512_idx_radix8.h"
+#include "psort_idx_words.h"
+#include "psort_hash.h"
+#include "psort_prefix.h"
+#include "psort_index64.h"
+#include "psort_runs.h"
+#include "psort_tune.h"
 #include "u512.h"
+#include <limits.h>
 
 /* Layout compatibility:
  *   psort_u512 == u512  (w7..w0)
  */
+static void psort_u512_runs(uint64_t* keys, size_t n, size_t limbs)
+{
+    (void)limbs;
+    psort_u512((psort_u512_t*)keys, (int)n);
+}
+
+static void psort_u512_index_runs(uint32_t* idx, uint32_t* tmp, const uint64_t* keys,
+                                  int n, size_t limbs)
+{
+    (void)limbs;
+    psort_u512_index(idx, tmp, (const psort_u512_t*)keys, n);
+}
+
+void psort_u512(psort_u512_t* keys, int n)
+{
+    if (n > 1 && psort_runs_presorted((uint64_t*)keys, (size_t)n, 8, psort_u512_runs)) return;
+    if (n >= psort_tune_profile()->u512_generic_min) psort_u((uint64_t*)keys, (size_t)(n > 0 ? n : 0), 8);
+    else                                             pipe_sort_u512((u512*)keys, n);
+}
+
+int psort_u512_is_sorted(const psort_u512_t* keys, int n)
+{
+    return u512_is_sorted((const u512*)keys, n);
+}
+
 void psort_u512_index(uint32_t* idx, uint32_t* tmp,
                       const psort_u512_t* keys, int n)
 {
-    pipe_sort_u512_index_radix8_fixed(idx, tmp, (const u512*)keys, n);
+    if (n > 1 && psort_runs_presorted_index(idx, tmp, (const uint64_t*)keys, n, 8,
+                                            psort_u512_index_runs)) return;
+    psort_words_index_sort(idx, tmp, (const uint64_t*)keys, n, 8);
+}
+
+void psort_u512_large(psort_u512_t* keys, size_t n)
+{
+    if (n <= (size_t)INT_MAX) psort_u512(keys, (int)n);
+    else                      psort_u((uint64_t*)keys, n, 8);
+}
+
+void psort_u512_index64(uint64_t* idx, uint64_t* tmp,
+                        const psort_u512_t* keys, size_t n)
+{
+    psort_index64_sort(idx, tmp, (const uint64_t*)keys, n, 8);
+}
+
+void psort_u512_index_select(uint32_t* idx, uint32_t* tmp,
+                             const psort_u512_t* keys, int n, int k)
+{
+    psort_words_index_select(idx, tmp, (const uint64_t*)keys, n, 8, k);
+}
+
+void psort_u512_index_partial_sort(uint32_t* idx, uint32_t* tmp,
+                                   const psort_u512_t* keys, int n, int k)
+{
+    psort_words_index_partial(idx, tmp, (const uint64_t*)keys, n, 8, k);
+}
+
+int psort_u512_index_unique(uint32_t* idx, uint32_t* tmp,
+                            const psort_u512_t* keys, int n, uint32_t* counts)
+{
+    return psort_words_index_unique(idx, tmp, (const uint64_t*)keys, n, 8, counts);
+}
+
+void psort_u512_index_cached(uint32_t* idx, uint32_t* tmp,
+                             const psort_u512_t* keys, int n)
+{
+    psort_prefix_index_sort(idx, tmp, (const uint64_t*)keys, n, 8);
+}
+
+void psort_u512_index_hash(uint32_t* idx, uint32_t* tmp,
+                           const psort_u512_t* keys, int n)
+{
+    psort_hash_index_sort(idx, tmp, (const uint64_t*)keys, n, 8);
+}
+
+void psort_u512_index_parallel(uint32_t* idx, uint32_t* tmp,
+                               const psort_u512_t* keys, int n, int nthreads)
+{
+    psort_words_index_parallel(idx, tmp, (const uint64_t*)keys, n, 8, nthreads);
 }
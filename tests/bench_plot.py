@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""Regenerates assets/graphs from bench_suite CSV output.
+
+    # run the standard sweeps, save the CSV, draw the graphs
+    python3 tests/bench_plot.py --run _build/bench_suite --csv bench.csv
+
+    # redraw from an existing CSV
+    python3 tests/bench_plot.py --csv bench.csv
+
+Graphs (median over reps, uniform keys unless noted):
+    compare_scaling_n.png      seconds vs n at 128 bits
+    compare_scaling_w.png      seconds vs key width (n of the width sweep)
+    compare_memory.png         peak RSS minus the key array at the largest n
+    compare_distributions.png  keys/s per distribution, 128 bits, n = 1M
+Needs matplotlib for the drawing step only.
+"""
+import argparse
+import csv
+import os
+import statistics
+import subprocess
+import sys
+
+SWEEPS = [
+    # (-n, -w, -d)
+    ("10000,100000,1000000,4000000", "128", "uniform"),
+    ("1000000", "256,512,1024", "uniform"),
+    ("1000000", "128", "prefix,dups,sorted,reverse,nearly,zipf,lowent"),
+]
+
+
+def run_sweeps(bench, reps, out_path):
+    with open(out_path, "w", newline="") as out:
+        header_done = False
+        for ns, ws, ds in SWEEPS:
+            cmd = [bench, "-n", ns, "-w", ws, "-d", ds, "-r", str(reps)]
+            print("running:", " ".join(cmd), file=sys.stderr)
+            res = subprocess.run(cmd, check=True, stdout=subprocess.PIPE, text=True)
+            lines = res.stdout.splitlines()
+            if header_done:
+                lines = lines[1:]
+            header_done = True
+            out.write("\n".join(lines) + "\n")
+
+
+def load(path):
+    with open(path, newline="") as f:
+        rows = [r for r in csv.DictReader(f) if r["sorted"] == "1"]
+    for r in rows:
+        r["n"] = int(r["n"])
+        r["bits"] = int(r["bits"])
+        for k in ("seconds", "keys_per_sec", "peak_rss_kb", "input_kb"):
+            r[k] = float(r[k])
+    return rows
+
+
+def median_by(rows, key, value):
+    groups = {}
+    for r in rows:
+        groups.setdefault(key(r), []).append(value(r))
+    return {k: statistics.median(v) for k, v in groups.items()}
+
+
+def family(algo):
+    # psort_u128 / psort_u256_index / ... are one line: "psort (specialized)"
+    return "psort" if algo.startswith("psort_u") and algo != "psort_u" else algo
+
+
+def plot(rows, out_dir):
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        sys.exit("bench_plot.py: matplotlib is required to draw the graphs")
+
+    os.makedirs(out_dir, exist_ok=True)
+    uni = [r for r in rows if r["dist"] == "uniform"]
+    max_n = max(r["n"] for r in rows)
+
+    # seconds vs n
+    sel = [r for r in uni if r["bits"] == 128]
+    med = median_by(sel, lambda r: (family(r["algo"]), r["n"]), lambda r: r["seconds"])
+    fig, ax = plt.subplots(figsize=(8, 5))
+    for algo in sorted({a for a, _ in med}):
+        pts = sorted((n, t) for (a, n), t in med.items() if a == algo)
+        ax.plot([p[0] for p in pts], [p[1] for p in pts], marker="o", label=algo)
+    ax.set(xscale="log", yscale="log", xlabel="n (keys)", ylabel="seconds",
+           title="Scaling with n (128-bit uniform keys)")
+    ax.grid(True, which="both", alpha=0.3)
+    ax.legend()
+    fig.savefig(os.path.join(out_dir, "compare_scaling_n.png"), dpi=120, bbox_inches="tight")
+    plt.close(fig)
+
+    # seconds vs width
+    wide = [r["n"] for r in uni if r["bits"] != 128]
+    n_w = max(wide) if wide else max_n
+    sel = [r for r in uni if r["n"] == n_w]
+    med = median_by(sel, lambda r: (family(r["algo"]), r["bits"]), lambda r: r["seconds"])
+    fig, ax = plt.subplots(figsize=(8, 5))
+    for algo in sorted({a for a, _ in med}):
+        pts = sorted((b, t) for (a, b), t in med.items() if a == algo)
+        ax.plot([p[0] for p in pts], [p[1] for p in pts], marker="o", label=algo)
+    ax.set(xscale="log", yscale="log", xlabel="key width (bits)", ylabel="seconds",
+           title="Scaling with key width (uniform keys, n = %d)" % n_w)
+    ax.grid(True, which="both", alpha=0.3)
+    ax.legend()
+    fig.savefig(os.path.join(out_dir, "compare_scaling_w.png"), dpi=120, bbox_inches="tight")
+    plt.close(fig)
+
+    # auxiliary memory
+    sel = [r for r in uni if r["n"] == max_n]
+    med = median_by(sel, lambda r: (r["algo"], r["bits"]),
+                    lambda r: max(r["peak_rss_kb"] - r["input_kb"], 0.0) / 1024.0)
+    labels = sorted(med, key=lambda k: (k[1], k[0]))
+    fig, ax = plt.subplots(figsize=(9, 5))
+    ax.bar(range(len(labels)), [med[k] for k in labels])
+    ax.set_xticks(range(len(labels)))
+    ax.set_xticklabels(["%s\n%d-bit" % k for k in labels], rotation=45, ha="right", fontsize=8)
+    ax.set(ylabel="peak RSS - input (MiB)", title="Auxiliary memory (n = %d)" % max_n)
+    fig.savefig(os.path.join(out_dir, "compare_memory.png"), dpi=120, bbox_inches="tight")
+    plt.close(fig)
+
+    # throughput per distribution
+    sel = [r for r in rows if r["bits"] == 128 and r["n"] == 1000000]
+    if sel:
+        med = median_by(sel, lambda r: (family(r["algo"]), r["dist"]), lambda r: r["keys_per_sec"])
+        algos = sorted({a for a, _ in med})
+        dists = sorted({d for _, d in med})
+        width = 0.8 / len(algos)
+        fig, ax = plt.subplots(figsize=(10, 5))
+        for i, algo in enumerate(algos):
+            ax.bar([j + i * width for j in range(len(dists))],
+                   [med.get((algo, d), 0.0) / 1e6 for d in dists], width, label=algo)
+        ax.set_xticks([j + 0.4 - width / 2 for j in range(len(dists))])
+        ax.set_xticklabels(dists)
+        ax.set(ylabel="million keys / s", title="Throughput by distribution (128-bit, n = 1M)")
+        ax.legend()
+        fig.savefig(os.path.join(out_dir, "compare_distributions.png"), dpi=120, bbox_inches="tight")
+        plt.close(fig)
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--run", metavar="BENCH_SUITE", help="bench_suite binary to run the sweeps with")
+    ap.add_argument("--csv", default="bench.csv", help="CSV to write (--run) or read")
+    ap.add_argument("--reps", type=int, default=3)
+    ap.add_argument("--out", default=os.path.join(here, "..", "assets", "graphs"))
+    args = ap.parse_args()
+
+    if args.run:
+        run_sweeps(args.run, args.reps, args.csv)
+    plot(load(args.csv), args.out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,43 @@
+// std::sort competitor for bench_suite (the only C++ in the tree; the bench
+// builds without it when no C++ compiler is available).
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+
+template <size_t L>
+struct Key {
+    uint64_t w[L]; // most significant limb first, as psort_u
+};
+
+template <size_t L>
+bool key_less(const Key<L>& a, const Key<L>& b) {
+    for (size_t i = 0; i < L; i++) {
+        if (a.w[i] != b.w[i]) return a.w[i] < b.w[i];
+    }
+    return false;
+}
+
+template <size_t L>
+void sort_keys(uint64_t* keys, size_t n) {
+    Key<L>* k = reinterpret_cast<Key<L>*>(keys);
+    std::sort(k, k + n, key_less<L>);
+}
+
+} // namespace
+
+// Sorts n keys of `limbs` words with std::sort. Returns 0, or -1 for a limb
+// count without an instantiation.
+extern "C" int bench_std_sort(uint64_t* keys, size_t n, size_t limbs) {
+    switch (limbs) {
+        case 1:  sort_keys<1>(keys, n);  return 0;
+        case 2:  sort_keys<2>(keys, n);  return 0;
+        case 3:  sort_keys<3>(keys, n);  return 0;
+        case 4:  sort_keys<4>(keys, n);  return 0;
+        case 6:  sort_keys<6>(keys, n);  return 0;
+        case 8:  sort_keys<8>(keys, n);  return 0;
+        case 16: sort_keys<16>(keys, n); return 0;
+        default: return -1;
+    }
+}
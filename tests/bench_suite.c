@@ -0,0 +1,411 @@
+// Benchmark matrix: sorter x distribution x key width x n, CSV on stdout.
+//
+//   bench_suite [-n N,...] [-w BITS,...] [-d DIST,...] [-a ALGO,...]
+//               [-r REPS] [-s SEED]
+//
+// ALGO: psort     psort_u128 (128 bit), psort_u256_index, psort_u512_index,
+//                 psort_u for other widths
+//       psort_u   psort_u at every width
+//       qsort     libc qsort
+//       lsd       plain LSD radix sort (8 bit digits, ping-pong buffer)
+//       std       std::sort (only when built with bench_std_sort.cpp)
+// DIST: uniform prefix dups sorted reverse nearly zipf lowent
+//
+// Every measurement runs in a forked child, so peak_rss_kb (from wait4) is
+// the peak of that one sort: input keys, index/scratch buffers and whatever
+// the sorter allocates. input_kb is the key array alone.
+// bench_plot.py turns the CSV into the graphs in assets/graphs.
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/pipesort/pipesort.h"
+
+#ifdef BENCH_HAVE_STD_SORT
+int bench_std_sort(uint64_t* keys, size_t n, size_t limbs);
+#endif
+
+#define MAX_LIST 32
+
+static const char* const DISTS[] = {
+    "uniform", "prefix", "dups", "sorted", "reverse", "nearly", "zipf", "lowent"
+};
+#define NUM_DISTS (sizeof(DISTS) / sizeof(DISTS[0]))
+
+static const char* const ALGOS[] = { "psort", "psort_u", "qsort", "lsd", "std" };
+#define NUM_ALGOS (sizeof(ALGOS) / sizeof(ALGOS[0]))
+
+static inline uint64_t xorshift64(uint64_t* s) {
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *s = x;
+    return x;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// ---------------- key helpers (limbs words per key, MS first) ----------------
+
+static size_t g_limbs; // for qsort's comparator
+
+static int key_cmp(const uint64_t* a, const uint64_t* b, size_t limbs) {
+    for (size_t l = 0; l < limbs; l++) {
+        if (a[l] != b[l]) return a[l] < b[l] ? -1 : 1;
+    }
+    return 0;
+}
+
+static int qsort_cmp(const void* a, const void* b) {
+    return key_cmp((const uint64_t*)a, (const uint64_t*)b, g_limbs);
+}
+
+static int keys_sorted(const uint64_t* k, size_t n, size_t limbs) {
+    for (size_t i = 1; i < n; i++) {
+        if (key_cmp(k + (i - 1) * limbs, k + i * limbs, limbs) > 0) return 0;
+    }
+    return 1;
+}
+
+static int index_sorted(const uint32_t* idx, const uint64_t* k, size_t n, size_t limbs) {
+    for (size_t i = 1; i < n; i++) {
+        if (key_cmp(k + (size_t)idx[i - 1] * limbs, k + (size_t)idx[i] * limbs, limbs) > 0) return 0;
+    }
+    return 1;
+}
+
+static void swap_keys(uint64_t* a, uint64_t* b, size_t limbs) {
+    for (size_t l = 0; l < limbs; l++) {
+        const uint64_t t = a[l];
+        a[l] = b[l];
+        b[l] = t;
+    }
+}
+
+// ---------------- distributions ----------------
+
+static int dist_id(const char* name) {
+    for (size_t i = 0; i < NUM_DISTS; i++) {
+        if (strcmp(name, DISTS[i]) == 0) return (int)i;
+    }
+    return -1;
+}
+
+// Zipf (s = 1) ranks over m values by inverse CDF.
+static void fill_zipf(uint64_t* k, size_t n, size_t limbs, uint64_t* s) {
+    const size_t m = n < ((size_t)1 << 20) ? n : ((size_t)1 << 20);
+    double* cdf = (double*)malloc(m * sizeof(double));
+    uint64_t* pool = (uint64_t*)malloc(m * limbs * sizeof(uint64_t));
+    if (!cdf || !pool) {
+        free(cdf); free(pool);
+        for (size_t i = 0; i < n * limbs; i++) k[i] = xorshift64(s);
+        return;
+    }
+    double sum = 0.0;
+    for (size_t r = 0; r < m; r++) {
+        sum += 1.0 / (double)(r + 1);
+        cdf[r] = sum;
+    }
+    for (size_t i = 0; i < m * limbs; i++) pool[i] = xorshift64(s);
+
+    for (size_t i = 0; i < n; i++) {
+        const double u = (double)(xorshift64(s) >> 11) * (1.0 / 9007199254740992.0) * sum;
+        size_t lo = 0, hi = m - 1;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (cdf[mid] < u) lo = mid + 1;
+            else              hi = mid;
+        }
+        memcpy(k + i * limbs, pool + lo * limbs, limbs * sizeof(uint64_t));
+    }
+    free(cdf);
+    free(pool);
+}
+
+static void fill_keys(uint64_t* k, size_t n, size_t limbs, int dist, uint64_t seed) {
+    uint64_t s = seed ? seed : 1;
+    const size_t words = n * limbs;
+
+    switch (dist) {
+        case 1: // prefix: every limb but the last is shared
+            for (size_t i = 0; i < words; i++) {
+                k[i] = (i % limbs == limbs - 1) ? xorshift64(&s) : 0x9E3779B97F4A7C15ULL * (i % limbs + 1);
+            }
+            break;
+        case 2: { // dups: 1000 distinct keys
+            uint64_t pool[1000 * 16];
+            const size_t pl = limbs < 16 ? limbs : 16;
+            for (size_t i = 0; i < 1000 * pl; i++) pool[i] = xorshift64(&s);
+            for (size_t i = 0; i < n; i++) {
+                const uint64_t* p = pool + (xorshift64(&s) % 1000) * pl;
+                for (size_t l = 0; l < limbs; l++) k[i * limbs + l] = l < pl ? p[l] : 0;
+            }
+            break;
+        }
+        case 6:
+            fill_zipf(k, n, limbs, &s);
+            break;
+        case 7: // lowent: a few set bits per byte position
+            for (size_t i = 0; i < words; i++) k[i] = xorshift64(&s) & 0x0101010101010101ULL;
+            break;
+        default: // uniform, and the base of sorted / reverse / nearly
+            for (size_t i = 0; i < words; i++) k[i] = xorshift64(&s);
+            break;
+    }
+
+    if (dist >= 3 && dist <= 5) {
+        psort_u(k, n, limbs);
+        if (dist == 4) {
+            for (size_t i = 0; i < n / 2; i++) swap_keys(k + i * limbs, k + (n - 1 - i) * limbs, limbs);
+        } else if (dist == 5) { // nearly: 1% random swaps
+            for (size_t i = 0; i < n / 100 && n > 1; i++) {
+                swap_keys(k + (xorshift64(&s) % n) * limbs, k + (xorshift64(&s) % n) * limbs, limbs);
+            }
+        }
+    }
+}
+
+// ---------------- LSD radix baseline ----------------
+
+// 8 bit digits from the least significant byte up, stable counting scatter
+// between keys and tmp each pass; the result ends in keys.
+static int lsd_radix(uint64_t* keys, size_t n, size_t limbs) {
+    uint64_t* tmp = (uint64_t*)malloc(n * limbs * sizeof(uint64_t));
+    if (!tmp) return -1;
+    uint64_t* src = keys;
+    uint64_t* dst = tmp;
+    size_t c[256];
+
+    for (size_t l = limbs; l-- > 0;) {
+        for (unsigned shift = 0; shift < 64; shift += 8) {
+            memset(c, 0, sizeof(c));
+            for (size_t i = 0; i < n; i++) c[(src[i * limbs + l] >> shift) & 0xFF]++;
+            size_t sum = 0;
+            for (size_t b = 0; b < 256; b++) {
+                const size_t cnt = c[b];
+                c[b] = sum;
+                sum += cnt;
+            }
+            for (size_t i = 0; i < n; i++) {
+                const size_t p = c[(src[i * limbs + l] >> shift) & 0xFF]++;
+                memcpy(dst + p * limbs, src + i * limbs, limbs * sizeof(uint64_t));
+            }
+            uint64_t* t = src;
+            src = dst;
+            dst = t;
+        }
+    }
+    if (src != keys) memcpy(keys, src, n * limbs * sizeof(uint64_t));
+    free(tmp);
+    return 0;
+}
+
+// ---------------- one measurement ----------------
+
+typedef struct {
+    double seconds;
+    int status; // 1 sorted, 0 wrong order, -1 not run
+    char algo[24];
+} bench_result;
+
+// Runs in the child: builds the input, times the sort, checks the order.
+static bench_result run_one(const char* algo, int dist, size_t bits, size_t n, uint64_t seed) {
+    bench_result r = { 0.0, -1, "" };
+    const size_t limbs = bits / 64;
+    uint64_t* k = (uint64_t*)malloc(n * limbs * sizeof(uint64_t));
+    if (!k) return r;
+    fill_keys(k, n, limbs, dist, seed);
+
+    uint32_t* idx = NULL;
+    uint32_t* tmp = NULL;
+    const int use_index = strcmp(algo, "psort") == 0 && (bits == 256 || bits == 512);
+    if (use_index) {
+        idx = (uint32_t*)malloc(n * sizeof(uint32_t));
+        tmp = (uint32_t*)malloc(n * sizeof(uint32_t));
+        if (!idx || !tmp) { free(k); free(idx); free(tmp); return r; }
+        for (size_t i = 0; i < n; i++) idx[i] = (uint32_t)i;
+    }
+
+    int rc = 0;
+    const double t0 = now_sec();
+    if (strcmp(algo, "psort") == 0) {
+        if (bits == 128) {
+            snprintf(r.algo, sizeof(r.algo), "psort_u128");
+            psort_u128((psort_u128_t*)k, (int)n);
+        } else if (bits == 256) {
+            snprintf(r.algo, sizeof(r.algo), "psort_u256_index");
+            psort_u256_index(idx, tmp, (const psort_u256_t*)k, (int)n);
+        } else if (bits == 512) {
+            snprintf(r.algo, sizeof(r.algo), "psort_u512_index");
+            psort_u512_index(idx, tmp, (const psort_u512_t*)k, (int)n);
+        } else {
+            snprintf(r.algo, sizeof(r.algo), "psort_u");
+            psort_u(k, n, limbs);
+        }
+    } else if (strcmp(algo, "psort_u") == 0) {
+        snprintf(r.algo, sizeof(r.algo), "psort_u");
+        psort_u(k, n, limbs);
+    } else if (strcmp(algo, "qsort") == 0) {
+        snprintf(r.algo, sizeof(r.algo), "qsort");
+        g_limbs = limbs;
+        qsort(k, n, limbs * sizeof(uint64_t), qsort_cmp);
+    } else if (strcmp(algo, "lsd") == 0) {
+        snprintf(r.algo, sizeof(r.algo), "lsd_radix");
+        rc = lsd_radix(k, n, limbs);
+    } else {
+        snprintf(r.algo, sizeof(r.algo), "std_sort");
+#ifdef BENCH_HAVE_STD_SORT
+        rc = bench_std_sort(k, n, limbs);
+#else
+        rc = -1;
+#endif
+    }
+    const double t1 = now_sec();
+
+    if (rc == 0) {
+        r.seconds = t1 - t0;
+        r.status = use_index ? index_sorted(idx, k, n, limbs) : keys_sorted(k, n, limbs);
+    }
+    free(k); free(idx); free(tmp);
+    return r;
+}
+
+// Forks, runs one measurement in the child and prints its CSV row.
+// Returns 0, or -1 if the child could not be run.
+static int measure(const char* algo, int dist, size_t bits, size_t n, int rep, uint64_t seed) {
+    int fds[2];
+    if (pipe(fds) != 0) return -1;
+
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]); close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        const bench_result r = run_one(algo, dist, bits, n, seed);
+        const ssize_t w = write(fds[1], &r, sizeof(r));
+        _exit(w == (ssize_t)sizeof(r) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    bench_result r;
+    ssize_t got;
+    do {
+        got = read(fds[0], &r, sizeof(r));
+    } while (got < 0 && errno == EINTR);
+    close(fds[0]);
+
+    int wstatus = 0;
+    struct rusage ru;
+    memset(&ru, 0, sizeof(ru));
+    while (wait4(pid, &wstatus, 0, &ru) < 0 && errno == EINTR) {}
+
+    if (got != (ssize_t)sizeof(r)) return -1;
+    if (r.status < 0) return 0; // sorter not available at this width
+
+    const double input_kb = (double)(n * (bits / 8)) / 1024.0;
+    printf("%s,%s,%zu,%zu,%d,%.6f,%.0f,%ld,%.0f,%d\n",
+           r.algo, DISTS[dist], bits, n, rep, r.seconds,
+           r.seconds > 0 ? (double)n / r.seconds : 0.0,
+           ru.ru_maxrss, input_kb, r.status);
+    return 0;
+}
+
+// ---------------- command line ----------------
+
+static size_t split_list(char* s, char** out) {
+    size_t m = 0;
+    for (char* tok = strtok(s, ","); tok && m < MAX_LIST; tok = strtok(NULL, ",")) out[m++] = tok;
+    return m;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: bench_suite [-n N,...] [-w BITS,...] [-d DIST,...] [-a ALGO,...] [-r REPS] [-s SEED]\n"
+            "  BITS: multiple of 64\n"
+            "  DIST: uniform prefix dups sorted reverse nearly zipf lowent\n"
+            "  ALGO: psort psort_u qsort lsd std\n");
+}
+
+int main(int argc, char** argv) {
+    char ns_buf[256] = "100000,1000000";
+    char ws_buf[256] = "128,256,512";
+    char ds_buf[256] = "uniform,prefix,dups,sorted,reverse,nearly,zipf,lowent";
+    char as_buf[256] = "psort,psort_u,qsort,lsd,std";
+    int reps = 3;
+    uint64_t seed = 123;
+
+    for (int i = 1; i < argc; i++) {
+        const char* opt = argv[i];
+        if (i + 1 >= argc || opt[0] != '-' || opt[2] != '\0') { usage(); return 2; }
+        const char* val = argv[++i];
+        switch (opt[1]) {
+            case 'n': snprintf(ns_buf, sizeof(ns_buf), "%s", val); break;
+            case 'w': snprintf(ws_buf, sizeof(ws_buf), "%s", val); break;
+            case 'd': snprintf(ds_buf, sizeof(ds_buf), "%s", val); break;
+            case 'a': snprintf(as_buf, sizeof(as_buf), "%s", val); break;
+            case 'r': reps = atoi(val); break;
+            case 's': seed = (uint64_t)strtoull(val, NULL, 10); break;
+            default: usage(); return 2;
+        }
+    }
+
+    char* ns[MAX_LIST];
+    char* ws[MAX_LIST];
+    char* ds[MAX_LIST];
+    char* as[MAX_LIST];
+    const size_t nn = split_list(ns_buf, ns);
+    const size_t nw = split_list(ws_buf, ws);
+    const size_t nd = split_list(ds_buf, ds);
+    const size_t na = split_list(as_buf, as);
+
+    for (size_t i = 0; i < nw; i++) {
+        const long b = atol(ws[i]);
+        if (b <= 0 || b % 64 != 0) { usage(); return 2; }
+    }
+    for (size_t i = 0; i < nd; i++) {
+        if (dist_id(ds[i]) < 0) { usage(); return 2; }
+    }
+    for (size_t i = 0; i < na; i++) {
+        size_t j = 0;
+        while (j < NUM_ALGOS && strcmp(as[i], ALGOS[j]) != 0) j++;
+        if (j == NUM_ALGOS) { usage(); return 2; }
+    }
+
+    printf("algo,dist,bits,n,rep,seconds,keys_per_sec,peak_rss_kb,input_kb,sorted\n");
+    for (size_t ni = 0; ni < nn; ni++) {
+        const size_t n = (size_t)strtoull(ns[ni], NULL, 10);
+        if (n == 0 || n > 0x7FFFFFFFu) { usage(); return 2; }
+        for (size_t wi = 0; wi < nw; wi++) {
+            const size_t bits = (size_t)atol(ws[wi]);
+            for (size_t di = 0; di < nd; di++) {
+                for (size_t ai = 0; ai < na; ai++) {
+                    for (int rep = 0; rep < reps; rep++) {
+                        if (measure(as[ai], dist_id(ds[di]), bits, n, rep, seed) != 0) {
+                            fprintf(stderr, "bench_suite: %s/%s/%zu/%zu failed\n",
+                                    as[ai], ds[di], bits, n);
+                            return 1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
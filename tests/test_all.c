@@ -5,6 +5,7 @@
 #include <time.h>
 
 #include "../include/pipesort/pipesort.h"  
+#include "../internal/psort_index64.h"
 
 
 static inline uint64_t xorshift64(uint64_t *s) {
@@ -44,6 +45,1313 @@ static int arrays_equal_u128(const psort_u128_t *a, const psort_u128_t *b, int n
     return memcmp(a, b, (size_t)n * sizeof(psort_u128_t)) == 0;
 }
 
+// Parallel sort must match the serial one byte for byte, on random keys and
+// on low entropy keys (long shared prefixes + duplicates).
+static int check_u128_parallel(const psort_u128_t *base, const psort_u128_t *ref, int n) {
+    psort_u128_t *a = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u128_t *b = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    if (!a || !b) { free(a); free(b); return 0; }
+
+    memcpy(a, base, (size_t)n * sizeof(psort_u128_t));
+    psort_u128_parallel(a, n, 4);
+    int ok = arrays_equal_u128(a, ref, n);
+
+    for (int i = 0; i < n; i++) {
+        a[i].hi = 0xABCDEF0000000000ULL | (base[i].hi & 0xF);
+        a[i].lo = base[i].lo & 0xFF;
+    }
+    memcpy(b, a, (size_t)n * sizeof(psort_u128_t));
+    psort_u128_parallel(a, n, 3);
+    psort_u128(b, n);
+    ok = ok && arrays_equal_u128(a, b, n);
+
+    printf("psort_u128_parallel: %s\n", ok ? "OK" : "FAIL");
+    free(a); free(b);
+    return ok;
+}
+
+static int cmp_u256(const psort_u256_t *x, const psort_u256_t *y) {
+    if (x->w3 != y->w3) return x->w3 < y->w3 ? -1 : 1;
+    if (x->w2 != y->w2) return x->w2 < y->w2 ? -1 : 1;
+    if (x->w1 != y->w1) return x->w1 < y->w1 ? -1 : 1;
+    if (x->w0 != y->w0) return x->w0 < y->w0 ? -1 : 1;
+    return 0;
+}
+
+static int cmp_u512(const psort_u512_t *x, const psort_u512_t *y) {
+    const uint64_t a[8] = { x->w7, x->w6, x->w5, x->w4, x->w3, x->w2, x->w1, x->w0 };
+    const uint64_t b[8] = { y->w7, y->w6, y->w5, y->w4, y->w3, y->w2, y->w1, y->w0 };
+    for (int l = 0; l < 8; l++) {
+        if (a[l] != b[l]) return a[l] < b[l] ? -1 : 1;
+    }
+    return 0;
+}
+
+static void iota_u32(uint32_t *idx, int n) {
+    for (int i = 0; i < n; i++) idx[i] = (uint32_t)i;
+}
+
+// Index sorts: sorted order, and parallel == serial (both are stable).
+// Top limbs are narrowed so the upper digit levels are all skip levels.
+static int check_index_sorts(int n, uint64_t seed) {
+    psort_u256_t *k256 = (psort_u256_t *)calloc((size_t)n, sizeof(psort_u256_t));
+    psort_u512_t *k512 = (psort_u512_t *)calloc((size_t)n, sizeof(psort_u512_t));
+    uint32_t *i1 = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *i2 = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *tmp = (uint32_t *)malloc(4 * (size_t)n * sizeof(uint32_t)); // 4n: cached sorts
+    if (!k256 || !k512 || !i1 || !i2 || !tmp) {
+        free(k256); free(k512); free(i1); free(i2); free(tmp);
+        return 0;
+    }
+
+    uint64_t s = seed ? seed : 1;
+    for (int i = 0; i < n; i++) {
+        k256[i].w3 = 0x0123456789ABCDEFULL;
+        k256[i].w2 = xorshift64(&s) & 0xFFFF;
+        k256[i].w1 = xorshift64(&s);
+        k256[i].w0 = xorshift64(&s);
+        k512[i].w7 = xorshift64(&s) & 0xF;
+        k512[i].w6 = k512[i].w5 = k512[i].w4 = 0;
+        k512[i].w3 = xorshift64(&s);
+        k512[i].w2 = xorshift64(&s) & 0x3;
+        k512[i].w1 = 0;
+        k512[i].w0 = xorshift64(&s);
+    }
+
+    int ok = 1;
+
+    iota_u32(i1, n); iota_u32(i2, n);
+    psort_u256_index(i1, tmp, k256, n);
+    psort_u256_index_parallel(i2, tmp, k256, n, 4);
+    for (int i = 1; i < n; i++) ok = ok && cmp_u256(&k256[i1[i-1]], &k256[i1[i]]) <= 0;
+    ok = ok && memcmp(i1, i2, (size_t)n * sizeof(uint32_t)) == 0;
+    iota_u32(i2, n);
+    psort_u256_index_cached(i2, tmp, k256, n);
+    ok = ok && memcmp(i1, i2, (size_t)n * sizeof(uint32_t)) == 0;
+
+    iota_u32(i1, n); iota_u32(i2, n);
+    psort_u512_index(i1, tmp, k512, n);
+    psort_u512_index_parallel(i2, tmp, k512, n, 3);
+    for (int i = 1; i < n; i++) ok = ok && cmp_u512(&k512[i1[i-1]], &k512[i1[i]]) <= 0;
+    ok = ok && memcmp(i1, i2, (size_t)n * sizeof(uint32_t)) == 0;
+    iota_u32(i2, n);
+    psort_u512_index_cached(i2, tmp, k512, n);
+    ok = ok && memcmp(i1, i2, (size_t)n * sizeof(uint32_t)) == 0;
+
+    // In place key sorts must give the keys in the order the index sort found.
+    psort_u512_t *s512 = (psort_u512_t *)malloc((size_t)n * sizeof(psort_u512_t));
+    psort_u256_t *s256 = (psort_u256_t *)malloc((size_t)n * sizeof(psort_u256_t));
+    if (!s512 || !s256) ok = 0;
+    if (ok) {
+        memcpy(s512, k512, (size_t)n * sizeof(psort_u512_t));
+        psort_u512(s512, n);
+        ok = psort_u512_is_sorted(s512, n);
+        for (int i = 0; i < n && ok; i++) ok = cmp_u512(&s512[i], &k512[i1[i]]) == 0;
+
+        iota_u32(i1, n);
+        psort_u256_index(i1, tmp, k256, n);
+        memcpy(s256, k256, (size_t)n * sizeof(psort_u256_t));
+        psort_u256(s256, n);
+        ok = ok && psort_u256_is_sorted(s256, n);
+        for (int i = 0; i < n && ok; i++) ok = cmp_u256(&s256[i], &k256[i1[i]]) == 0;
+    }
+
+    printf("u256/u512 sorts (index, cached, parallel, in place): %s\n", ok ? "OK" : "FAIL");
+    free(s256); free(s512);
+    free(k256); free(k512); free(i1); free(i2); free(tmp);
+    return ok;
+}
+
+// Key + payload sorts: keys match the reference and every payload still
+// identifies its key (payload = original position), for 8, 4 and 12 byte payloads.
+static int check_kv_sorts(const psort_u128_t *base, const psort_u128_t *ref, int n) {
+    psort_u128_t *a = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u256_t *b = (psort_u256_t *)malloc((size_t)n * sizeof(psort_u256_t));
+    psort_u256_t *b0 = (psort_u256_t *)malloc((size_t)n * sizeof(psort_u256_t));
+    uint64_t *v64 = (uint64_t *)malloc((size_t)n * sizeof(uint64_t));
+    uint32_t *v32 = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *v96 = (uint32_t *)malloc((size_t)n * 3 * sizeof(uint32_t));
+    if (!a || !b || !b0 || !v64 || !v32 || !v96) {
+        free(a); free(b); free(b0); free(v64); free(v32); free(v96);
+        return 0;
+    }
+    int ok = 1;
+
+    memcpy(a, base, (size_t)n * sizeof(psort_u128_t));
+    for (int i = 0; i < n; i++) v64[i] = (uint64_t)i;
+    psort_u128_kv(a, v64, n, sizeof(uint64_t));
+    ok = ok && arrays_equal_u128(a, ref, n);
+    for (int i = 0; i < n && ok; i++) ok = memcmp(&a[i], &base[v64[i]], sizeof(psort_u128_t)) == 0;
+
+    for (int i = 0; i < n; i++) {
+        b0[i].w3 = base[i].hi & 0xFF;   // lots of duplicates in the top limb
+        b0[i].w2 = 0;
+        b0[i].w1 = base[i].lo;
+        b0[i].w0 = base[i].hi;
+    }
+    memcpy(b, b0, (size_t)n * sizeof(psort_u256_t));
+    for (int i = 0; i < n; i++) v32[i] = (uint32_t)i;
+    psort_u256_kv(b, v32, n, sizeof(uint32_t));
+    for (int i = 1; i < n && ok; i++) ok = cmp_u256(&b[i-1], &b[i]) <= 0;
+    for (int i = 0; i < n && ok; i++) ok = memcmp(&b[i], &b0[v32[i]], sizeof(psort_u256_t)) == 0;
+
+    memcpy(b, b0, (size_t)n * sizeof(psort_u256_t));
+    for (int i = 0; i < n; i++) {
+        v96[3*i] = (uint32_t)i; v96[3*i+1] = (uint32_t)~i; v96[3*i+2] = 7;
+    }
+    psort_u256_kv(b, v96, n, 3 * sizeof(uint32_t));
+    for (int i = 0; i < n && ok; i++) {
+        ok = memcmp(&b[i], &b0[v96[3*i]], sizeof(psort_u256_t)) == 0 &&
+             v96[3*i+1] == (uint32_t)~v96[3*i] && v96[3*i+2] == 7;
+    }
+
+    printf("kv sorts: %s\n", ok ? "OK" : "FAIL");
+    free(a); free(b); free(b0); free(v64); free(v32); free(v96);
+    return ok;
+}
+
+static size_t g_limbs;
+
+static int cmp_limbs(const void *a, const void *b) {
+    const uint64_t *x = (const uint64_t *)a;
+    const uint64_t *y = (const uint64_t *)b;
+    for (size_t l = 0; l < g_limbs; l++) {
+        if (x[l] != y[l]) return x[l] < y[l] ? -1 : 1;
+    }
+    return 0;
+}
+
+// psort_u for specialized (2..8) and generic limb counts, on keys with a
+// shared leading limb, a few duplicates and random low limbs.
+static int check_psort_u(int n, uint64_t seed) {
+    static const size_t widths[] = { 1, 2, 3, 5, 8, 9, 12 };
+    if (n > 100000) n = 100000;
+    uint64_t *a = (uint64_t *)malloc((size_t)n * 12 * sizeof(uint64_t));
+    uint64_t *b = (uint64_t *)malloc((size_t)n * 12 * sizeof(uint64_t));
+    if (!a || !b) { free(a); free(b); return 0; }
+
+    int ok = 1;
+    uint64_t s = seed ? seed : 1;
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]) && ok; w++) {
+        const size_t limbs = widths[w];
+        for (int i = 0; i < n; i++) {
+            uint64_t *k = a + (size_t)i * limbs;
+            for (size_t l = 0; l < limbs; l++) k[l] = xorshift64(&s);
+            if (limbs > 1) k[0] = 0xFEEDFACE;
+            if (i % 7 == 3) memcpy(k, a, limbs * sizeof(uint64_t));
+        }
+        memcpy(b, a, (size_t)n * limbs * sizeof(uint64_t));
+        psort_u(a, (size_t)n, limbs);
+        g_limbs = limbs;
+        qsort(b, (size_t)n, limbs * sizeof(uint64_t), cmp_limbs);
+        ok = memcmp(a, b, (size_t)n * limbs * sizeof(uint64_t)) == 0;
+    }
+
+    printf("psort_u (1..12 limbs): %s\n", ok ? "OK" : "FAIL");
+    free(a); free(b);
+    return ok;
+}
+
+// Every partition kernel must produce the same sorted output.
+static int check_partition_modes(const psort_u128_t *base, const psort_u128_t *ref, int n, uint64_t seed) {
+    static const int modes[] = { PSORT_PARTITION_HOARE, PSORT_PARTITION_BLOCK,
+                                 PSORT_PARTITION_SIMD, PSORT_PARTITION_AUTO };
+    const int m = n > 100000 ? 100000 : n;
+    psort_u128_t *a = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    uint64_t *u = (uint64_t *)malloc((size_t)m * 3 * sizeof(uint64_t));
+    uint64_t *v = (uint64_t *)malloc((size_t)m * 3 * sizeof(uint64_t));
+    if (!a || !u || !v) { free(a); free(u); free(v); return 0; }
+
+    uint64_t s = seed ? seed : 1;
+    for (size_t i = 0; i < (size_t)m * 3; i++) u[i] = xorshift64(&s) & 0xFFFF0000FFFFULL;
+    memcpy(v, u, (size_t)m * 3 * sizeof(uint64_t));
+    g_limbs = 3;
+    qsort(v, (size_t)m, 3 * sizeof(uint64_t), cmp_limbs);
+
+    const int saved = psort_get_partition();
+    int ok = 1;
+    for (size_t k = 0; k < sizeof(modes) / sizeof(modes[0]) && ok; k++) {
+        psort_set_partition(modes[k]);
+        ok = psort_get_partition() == modes[k];
+
+        memcpy(a, base, (size_t)n * sizeof(psort_u128_t));
+        psort_u128(a, n);
+        ok = ok && arrays_equal_u128(a, ref, n);
+
+        memcpy(a, base, (size_t)n * sizeof(psort_u128_t));
+        psort_u128_parallel(a, n, 2);
+        ok = ok && arrays_equal_u128(a, ref, n);
+
+        uint64_t *w = (uint64_t *)a;
+        if ((size_t)n * 2 >= (size_t)m * 3) {
+            memcpy(w, u, (size_t)m * 3 * sizeof(uint64_t));
+            psort_u(w, (size_t)m, 3);
+            ok = ok && memcmp(w, v, (size_t)m * 3 * sizeof(uint64_t)) == 0;
+        }
+    }
+    psort_set_partition(saved);
+
+    printf("partition modes (hoare, block, simd, auto): %s\n", ok ? "OK" : "FAIL");
+    free(a); free(u); free(v);
+    return ok;
+}
+
+// Merges: sorted slices of base merged back must equal the full sort.
+// Streaming: batches of varying size, checked against psort_u128 of the
+// prefix pushed so far at a few checkpoints.
+static int check_merge_stream(const psort_u128_t *base, const psort_u128_t *ref, int n) {
+    enum { K = 7 };
+    psort_u128_t *parts = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u128_t *out = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u128_t *pref = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u256_t *w = (psort_u256_t *)malloc((size_t)n * 3 * sizeof(psort_u256_t));
+    if (!parts || !out || !pref || !w) { free(parts); free(out); free(pref); free(w); return 0; }
+
+    const psort_u128_t *runs[K];
+    size_t lens[K];
+    memcpy(parts, base, (size_t)n * sizeof(psort_u128_t));
+    for (int r = 0; r < K; r++) {
+        const int lo = (int)((long long)n * r / K), hi = (int)((long long)n * (r + 1) / K);
+        psort_u128(parts + lo, hi - lo);
+        runs[r] = parts + lo;
+        lens[r] = (size_t)(hi - lo);
+    }
+    psort_u128_merge_k(out, runs, lens, K);
+    int ok = arrays_equal_u128(out, ref, n);
+    psort_u128_merge(out, runs[0], lens[0], runs[1], lens[1]);
+    ok = ok && is_sorted_u128(out, (int)(lens[0] + lens[1]));
+
+    // u256: two sorted halves with many equal keys
+    for (int i = 0; i < n; i++) {
+        w[i].w3 = base[i].hi & 0xFF; w[i].w2 = 0; w[i].w1 = base[i].lo & 0xFFF; w[i].w0 = (uint64_t)i & 3;
+    }
+    const int h = n / 2;
+    psort_u256(w, h);
+    psort_u256(w + h, n - h);
+    psort_u256_merge(w + n, w, (size_t)h, w + h, (size_t)(n - h));
+    const psort_u256_t *wr[3] = { w, w + h, w + h };
+    size_t wl[3] = { (size_t)h, (size_t)(n - h), 0 };
+    psort_u256_merge_k(w + 2 * n, wr, wl, 3);
+    ok = ok && psort_u256_is_sorted(w + n, n) &&
+         memcmp(w + n, w + 2 * n, (size_t)n * sizeof(psort_u256_t)) == 0;
+
+    psort_u128_stream *st = psort_u128_stream_create();
+    int pushed = 0, batch = 1;
+    ok = ok && st != NULL;
+    while (ok && pushed < n) {
+        const int m = batch < n - pushed ? batch : n - pushed;
+        ok = psort_u128_stream_push(st, base + pushed, (size_t)m) == 0;
+        pushed += m;
+        batch = batch * 3 + 1;
+        if (ok && (batch % 4 == 0 || pushed == n)) {
+            memcpy(pref, base, (size_t)pushed * sizeof(psort_u128_t));
+            psort_u128(pref, pushed);
+            ok = psort_u128_stream_size(st) == (size_t)pushed;
+            psort_u128_stream_finish(st, out);
+            ok = ok && arrays_equal_u128(out, pref, pushed);
+        }
+    }
+    ok = ok && arrays_equal_u128(out, ref, n);
+    psort_u128_stream_destroy(st);
+
+    printf("merges + streaming sorter: %s\n", ok ? "OK" : "FAIL");
+    free(parts); free(out); free(pref); free(w);
+    return ok;
+}
+
+// select / partial sort against the full sort, for a few k (incl. edges).
+static int check_select(const psort_u128_t *base, const psort_u128_t *ref, int n, uint64_t seed) {
+    psort_u128_t *a = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u256_t *k256 = (psort_u256_t *)malloc((size_t)n * sizeof(psort_u256_t));
+    psort_u512_t *k512 = (psort_u512_t *)calloc((size_t)n, sizeof(psort_u512_t));
+    uint32_t *i1 = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *i2 = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *tmp = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    if (!a || !k256 || !k512 || !i1 || !i2 || !tmp) {
+        free(a); free(k256); free(k512); free(i1); free(i2); free(tmp);
+        return 0;
+    }
+
+    uint64_t s = seed ? seed : 1;
+    for (int i = 0; i < n; i++) {
+        k256[i].w3 = 7;
+        k256[i].w2 = xorshift64(&s) & 0x3;
+        k256[i].w1 = xorshift64(&s);
+        k256[i].w0 = xorshift64(&s) & 0xFF;
+        k512[i].w7 = xorshift64(&s) >> 50;
+        k512[i].w0 = xorshift64(&s);
+    }
+    iota_u32(i1, n);
+    psort_u256_index(i1, tmp, k256, n);
+
+    const int ks[] = { 0, 1, n / 100, n / 2, n - 1 };
+    int ok = 1;
+    for (size_t t = 0; t < sizeof(ks) / sizeof(ks[0]) && ok; t++) {
+        const int k = ks[t];
+        if (k >= n) continue;
+
+        memcpy(a, base, (size_t)n * sizeof(psort_u128_t));
+        psort_u128_select(a, n, k);
+        ok = cmp_u128(&a[k], &ref[k]) == 0;
+        for (int i = 0; i < n && ok; i++) {
+            const int c = cmp_u128(&a[i], &a[k]);
+            ok = i < k ? c <= 0 : c >= 0;
+        }
+
+        memcpy(a, base, (size_t)n * sizeof(psort_u128_t));
+        psort_u128_partial_sort(a, n, k + 1);
+        ok = ok && arrays_equal_u128(a, ref, k + 1);
+
+        iota_u32(i2, n);
+        psort_u256_index_select(i2, tmp, k256, n, k);
+        ok = ok && cmp_u256(&k256[i2[k]], &k256[i1[k]]) == 0;
+        for (int i = 0; i < n && ok; i++) {
+            const int c = cmp_u256(&k256[i2[i]], &k256[i2[k]]);
+            ok = i < k ? c <= 0 : c >= 0;
+        }
+
+        iota_u32(i2, n);
+        psort_u256_index_partial_sort(i2, tmp, k256, n, k + 1);
+        for (int i = 0; i <= k && ok; i++) ok = cmp_u256(&k256[i2[i]], &k256[i1[i]]) == 0;
+
+        iota_u32(i2, n);
+        psort_u512_index_partial_sort(i2, tmp, k512, n, k + 1);
+        for (int i = 1; i <= k && ok; i++) ok = cmp_u512(&k512[i2[i - 1]], &k512[i2[i]]) <= 0;
+        iota_u32(i1, n);
+        psort_u512_index_select(i1, tmp, k512, n, k);
+        ok = ok && cmp_u512(&k512[i1[k]], &k512[i2[k]]) == 0;
+
+        iota_u32(i1, n);
+        psort_u256_index(i1, tmp, k256, n);
+    }
+
+    printf("select / partial sort (u128, u256/u512 index): %s\n", ok ? "OK" : "FAIL");
+    free(a); free(k256); free(k512); free(i1); free(i2); free(tmp);
+    return ok;
+}
+
+// unique against sort + a separate dedup pass, on keys with many duplicates
+// (small equal runs and large ones that stay above the insertion cutoff).
+static int check_unique(const psort_u128_t *base, int n) {
+    psort_u128_t *a = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u128_t *b = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u256_t *k256 = (psort_u256_t *)calloc((size_t)n, sizeof(psort_u256_t));
+    psort_u512_t *k512 = (psort_u512_t *)calloc((size_t)n, sizeof(psort_u512_t));
+    uint32_t *cnt = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *idx = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *tmp = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    if (!a || !b || !k256 || !k512 || !cnt || !idx || !tmp) {
+        free(a); free(b); free(k256); free(k512); free(cnt); free(idx); free(tmp);
+        return 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        const uint64_t v = (i % 3 == 0) ? 42 : base[i].lo % 1000;
+        a[i].hi = v >> 3;
+        a[i].lo = v * 0x9E3779B97F4A7C15ULL;
+        k256[i].w3 = a[i].hi; k256[i].w0 = a[i].lo;
+        k512[i].w7 = a[i].hi; k512[i].w1 = a[i].lo;
+    }
+    memcpy(b, a, (size_t)n * sizeof(psort_u128_t));
+    psort_u128(b, n);
+    int m_ref = 0;
+    for (int i = 0; i < n; i++) {
+        if (m_ref == 0 || cmp_u128(&b[m_ref - 1], &b[i]) != 0) b[m_ref++] = b[i];
+    }
+
+    const int m = psort_u128_unique(a, n, cnt);
+    int ok = m == m_ref && arrays_equal_u128(a, b, m);
+    long long total = 0;
+    for (int g = 0; g < m; g++) total += cnt[g];
+    ok = ok && total == n;
+
+    iota_u32(idx, n);
+    const int m256 = psort_u256_index_unique(idx, tmp, k256, n, NULL);
+    ok = ok && m256 == m;
+    for (int g = 0; g < m256 && ok; g++) ok = k256[idx[g]].w3 == a[g].hi && k256[idx[g]].w0 == a[g].lo;
+
+    iota_u32(idx, n);
+    const int m512 = psort_u512_index_unique(idx, tmp, k512, n, (uint32_t *)b);
+    ok = ok && m512 == m;
+    for (int g = 0; g < m512 && ok; g++) {
+        ok = k512[idx[g]].w7 == a[g].hi && k512[idx[g]].w1 == a[g].lo && ((uint32_t *)b)[g] == cnt[g];
+    }
+    for (int g = 1; g < m512 && ok; g++) ok = idx[g] != idx[g - 1];
+
+    printf("unique (u128, u256/u512 index): %s\n", ok ? "OK" : "FAIL");
+    free(a); free(b); free(k256); free(k512); free(cnt); free(idx); free(tmp);
+    return ok;
+}
+
+// Stable buffered sorts: psort_u128_stable must match psort_u128; the kv
+// variant on keys with many duplicates (and differing bits on both sides of
+// bit 64) must keep the input order (payload = input index) within equal keys.
+static int check_stable(const psort_u128_t *base, const psort_u128_t *ref, int n) {
+    psort_u128_t *a = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u128_t *tmp = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    uint32_t *v = (uint32_t *)malloc((size_t)n * 3 * sizeof(uint32_t));
+    uint32_t *tv = (uint32_t *)malloc((size_t)n * 3 * sizeof(uint32_t));
+    if (!a || !tmp || !v || !tv) { free(a); free(tmp); free(v); free(tv); return 0; }
+
+    memcpy(a, base, (size_t)n * sizeof(psort_u128_t));
+    psort_u128_stable(a, tmp, n);
+    int ok = arrays_equal_u128(a, ref, n);
+
+    for (size_t vsz = 4; vsz <= 12 && ok; vsz += 8) {
+        const size_t w = vsz / 4;
+        for (int i = 0; i < n; i++) {
+            a[i].hi = base[i].hi & 0x3;
+            a[i].lo = (base[i].lo & 0xC000000000000007ULL);
+            for (size_t j = 0; j < w; j++) v[(size_t)i * w + j] = (uint32_t)i + (uint32_t)j;
+        }
+        psort_u128_kv_stable(a, v, tmp, tv, n, vsz);
+        ok = is_sorted_u128(a, n);
+        for (int i = 0; i < n && ok; i++) {
+            const uint32_t o = v[(size_t)i * w];
+            ok = base[o].hi % 4 == a[i].hi && (base[o].lo & 0xC000000000000007ULL) == a[i].lo &&
+                 (w == 1 || v[(size_t)i * w + 2] == o + 2);
+            if (ok && i > 0 && cmp_u128(&a[i - 1], &a[i]) == 0) ok = v[(size_t)(i - 1) * w] < o;
+        }
+    }
+
+    printf("stable (u128, kv payloads): %s\n", ok ? "OK" : "FAIL");
+    free(a); free(tmp); free(v); free(tv);
+    return ok;
+}
+
+// 64-bit entry points: psort_uW_index64 (narrowed uint32 path) and the
+// uint64 engine behind it for n > INT_MAX must give the same (stable) order
+// as psort_uW_index; psort_u128_large must match psort_u128. Keys have long
+// shared prefixes and duplicates so skip levels and ties are exercised.
+static int check_large(const psort_u128_t *base, const psort_u128_t *ref, int n, uint64_t seed) {
+    psort_u128_t *a = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u256_t *k256 = (psort_u256_t *)calloc((size_t)n, sizeof(psort_u256_t));
+    psort_u512_t *k512 = (psort_u512_t *)calloc((size_t)n, sizeof(psort_u512_t));
+    uint32_t *i32 = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *t32 = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint64_t *i64 = (uint64_t *)malloc((size_t)n * sizeof(uint64_t));
+    uint64_t *t64 = (uint64_t *)malloc((size_t)n * sizeof(uint64_t));
+    if (!a || !k256 || !k512 || !i32 || !t32 || !i64 || !t64) {
+        free(a); free(k256); free(k512); free(i32); free(t32); free(i64); free(t64);
+        return 0;
+    }
+
+    memcpy(a, base, (size_t)n * sizeof(psort_u128_t));
+    psort_u128_large(a, (size_t)n);
+    int ok = arrays_equal_u128(a, ref, n);
+
+    uint64_t s = seed ? seed : 1;
+    for (int i = 0; i < n; i++) {
+        k256[i].w3 = 0xFEDCBA9876543210ULL;
+        k256[i].w2 = xorshift64(&s) & 0x7;
+        k256[i].w1 = xorshift64(&s) & 0xFF00000000000000ULL;
+        k256[i].w0 = xorshift64(&s) % 97;
+        k512[i].w6 = xorshift64(&s) & 0x1;
+        k512[i].w3 = xorshift64(&s);
+        k512[i].w0 = xorshift64(&s) & 0xF;
+    }
+
+    for (int pass = 0; pass < 4 && ok; pass++) {
+        iota_u32(i32, n);
+        for (int i = 0; i < n; i++) i64[i] = (uint64_t)i;
+        switch (pass) {
+            case 0:
+                psort_u256_index(i32, t32, k256, n);
+                psort_u256_index64(i64, t64, k256, (size_t)n);
+                break;
+            case 1:
+                psort_u256_index(i32, t32, k256, n);
+                psort_index64_radix(i64, t64, (const uint64_t *)k256, (size_t)n, 4);
+                break;
+            case 2:
+                psort_u512_index(i32, t32, k512, n);
+                psort_u512_index64(i64, t64, k512, (size_t)n);
+                break;
+            default:
+                psort_u512_index(i32, t32, k512, n);
+                psort_index64_radix(i64, t64, (const uint64_t *)k512, (size_t)n, 8);
+                break;
+        }
+        for (int i = 0; i < n && ok; i++) ok = i64[i] == i32[i];
+    }
+
+    printf("64-bit sizes (large, index64): %s\n", ok ? "OK" : "FAIL");
+    free(a); free(k256); free(k512); free(i32); free(t32); free(i64); free(t64);
+    return ok;
+}
+
+static void put_be64(unsigned char *p, uint64_t x) {
+    for (int i = 7; i >= 0; i--) { p[i] = (unsigned char)(x & 0xFF); x >>= 8; }
+}
+
+static uint64_t get_be64(const unsigned char *p) {
+    uint64_t x = 0;
+    for (int i = 0; i < 8; i++) x = (x << 8) | p[i];
+    return x;
+}
+
+// Record sorts: 72 byte records with a u128 key at (unaligned) offset 20 and
+// 96 byte records with a u256 key at offset 40, the rest of each record
+// filled from its original index. Keys must come out in psort_u128 /
+// psort_u256 order with their records intact; the index sorts must give the
+// same (stable) order as psort_u128 / psort_u256_index on the extracted keys.
+static int check_records(const psort_u128_t *base, int n) {
+    const size_t st128 = 72, off128 = 20, st256 = 96, off256 = 40;
+    uint8_t *r128 = (uint8_t *)malloc((size_t)n * st128);
+    uint8_t *r256 = (uint8_t *)malloc((size_t)n * st256);
+    psort_u128_t *k128 = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u256_t *k256 = (psort_u256_t *)malloc((size_t)n * sizeof(psort_u256_t));
+    uint32_t *i1 = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *i2 = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *tmp = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    if (!r128 || !r256 || !k128 || !k256 || !i1 || !i2 || !tmp) {
+        free(r128); free(r256); free(k128); free(k256); free(i1); free(i2); free(tmp);
+        return 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        k128[i].hi = base[i].hi & 0x00FF00000000000FULL;
+        k128[i].lo = base[i].lo % 1000;
+        k256[i].w3 = 7;
+        k256[i].w2 = base[i].lo & 0xF;
+        k256[i].w1 = base[i].hi;
+        k256[i].w0 = base[i].lo >> 60;
+        memset(r128 + (size_t)i * st128, (int)(i & 0xFF), st128);
+        memset(r256 + (size_t)i * st256, (int)(i & 0xFF), st256);
+        memcpy(r128 + (size_t)i * st128, &i, sizeof(int));
+        memcpy(r256 + (size_t)i * st256, &i, sizeof(int));
+        memcpy(r128 + (size_t)i * st128 + off128, &k128[i], sizeof(psort_u128_t));
+        memcpy(r256 + (size_t)i * st256 + off256, &k256[i], sizeof(psort_u256_t));
+    }
+
+    iota_u32(i1, n);
+    psort_u128_records_index(i1, tmp, r128, n, st128, off128);
+    int ok = 1;
+    for (int i = 1; i < n && ok; i++) {
+        const int c = cmp_u128(&k128[i1[i - 1]], &k128[i1[i]]);
+        ok = c < 0 || (c == 0 && i1[i - 1] < i1[i]);
+    }
+
+    iota_u32(i1, n); iota_u32(i2, n);
+    psort_u256_records_index(i1, tmp, r256, n, st256, off256);
+    psort_u256_index(i2, tmp, k256, n);
+    ok = ok && memcmp(i1, i2, (size_t)n * sizeof(uint32_t)) == 0;
+
+    psort_u128_records(r128, (size_t)n, st128, off128);
+    psort_u256_records(r256, (size_t)n, st256, off256);
+    psort_u128(k128, n);
+    for (int i = 0; i < n && ok; i++) {
+        const uint8_t *a = r128 + (size_t)i * st128;
+        const uint8_t *b = r256 + (size_t)i * st256;
+        int o128, o256;
+        memcpy(&o128, a, sizeof(int));
+        memcpy(&o256, b, sizeof(int));
+        ok = memcmp(a + off128, &k128[i], sizeof(psort_u128_t)) == 0 &&
+             memcmp(b + off256, &k256[i2[i]], sizeof(psort_u256_t)) == 0 &&
+             o128 >= 0 && o128 < n && o256 >= 0 && o256 < n &&
+             a[st128 - 1] == (uint8_t)(o128 & 0xFF) && b[st256 - 1] == (uint8_t)(o256 & 0xFF);
+        if (ok) {
+            psort_u128_t orig;
+            memcpy(&orig, a + off128, sizeof(orig));
+            ok = orig.hi == (base[o128].hi & 0x00FF00000000000FULL) && orig.lo == base[o128].lo % 1000;
+        }
+    }
+
+    printf("record sorts (strided u128/u256 keys): %s\n", ok ? "OK" : "FAIL");
+    free(r128); free(r256); free(k128); free(k256); free(i1); free(i2); free(tmp);
+    return ok;
+}
+
+static size_t g_bytes_width;
+
+static int cmp_bytes(const void *a, const void *b) {
+    return memcmp(a, b, g_bytes_width);
+}
+
+// Byte string keys against qsort + memcmp: 32 bytes (digest like, but with
+// a shared prefix and duplicates), 20 and 13 bytes (partial last chunk).
+// The index sort must be stable: ties keep ascending idx.
+static int check_bytes(int n, uint64_t seed) {
+    const size_t widths[3] = {32, 20, 13};
+    uint8_t *a = (uint8_t *)malloc((size_t)n * 32);
+    uint8_t *r = (uint8_t *)malloc((size_t)n * 32);
+    uint32_t *idx = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *tmp = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    if (!a || !r || !idx || !tmp) { free(a); free(r); free(idx); free(tmp); return 0; }
+
+    int ok = 1;
+    uint64_t s = seed ? seed : 1;
+    for (int wi = 0; wi < 3 && ok; wi++) {
+        const size_t w = widths[wi];
+        for (int i = 0; i < n; i++) {
+            uint8_t *k = a + (size_t)i * w;
+            uint8_t buf[32];
+            put_be64(buf, 0x5A5A5A5A00000000ULL | (xorshift64(&s) & 0x3));
+            put_be64(buf + 8, xorshift64(&s) & 0xF0F0F0F0F0F0F0F0ULL);
+            put_be64(buf + 16, xorshift64(&s) % 5);
+            put_be64(buf + 24, xorshift64(&s));
+            if (i % 4 == 1) memset(buf + 4, 0xFF, 28);
+            memcpy(k, buf, w);
+        }
+        memcpy(r, a, (size_t)n * w);
+        g_bytes_width = w;
+        qsort(r, (size_t)n, w, cmp_bytes);
+
+        iota_u32(idx, n);
+        psort_bytes_index(idx, tmp, a, n, w);
+        for (int i = 0; i < n && ok; i++) {
+            ok = memcmp(a + (size_t)idx[i] * w, r + (size_t)i * w, w) == 0;
+            if (ok && i > 0 && memcmp(a + (size_t)idx[i - 1] * w, a + (size_t)idx[i] * w, w) == 0) {
+                ok = idx[i - 1] < idx[i];
+            }
+        }
+
+        psort_bytes(a, (size_t)n, w);
+        ok = ok && memcmp(a, r, (size_t)n * w) == 0;
+    }
+
+    printf("byte string keys (in place, index): %s\n", ok ? "OK" : "FAIL");
+    free(a); free(r); free(idx); free(tmp);
+    return ok;
+}
+
+// Writes n keys of `limbs` words as big endian bytes, sorts the file with a
+// 1 MiB budget (several runs; for 8 limbs more runs than one merge takes)
+// and compares with qsort. The u256 case sorts the file onto itself.
+static int check_file_sort(size_t limbs, const uint64_t *keys, int n, const char *dir) {
+    const size_t kb = limbs * 8;
+    char in[512], out[512];
+    snprintf(in, sizeof(in), "%s/psort_test_in_%zu.bin", dir, limbs);
+    snprintf(out, sizeof(out), "%s/psort_test_out_%zu.bin", dir, limbs);
+    if (limbs == 4) snprintf(out, sizeof(out), "%s", in);
+
+    unsigned char *bytes = (unsigned char *)malloc((size_t)n * kb);
+    uint64_t *ref = (uint64_t *)malloc((size_t)n * kb);
+    if (!bytes || !ref) { free(bytes); free(ref); return 0; }
+
+    for (size_t i = 0; i < (size_t)n * limbs; i++) put_be64(bytes + 8 * i, keys[i]);
+    FILE *f = fopen(in, "wb");
+    int ok = f && fwrite(bytes, kb, (size_t)n, f) == (size_t)n;
+    if (f) ok = (fclose(f) == 0) && ok;
+
+    int r = -1;
+    if (ok) {
+        switch (limbs) {
+            case 2:  r = psort_file_u128(in, out, 1 << 20, dir); break;
+            case 4:  r = psort_file_u256(in, out, 1 << 20, dir); break;
+            default: r = psort_file_u512(in, out, 1 << 20, dir); break;
+        }
+    }
+    ok = ok && r == 0;
+
+    f = ok ? fopen(out, "rb") : NULL;
+    ok = f && fread(bytes, kb, (size_t)n, f) == (size_t)n && fgetc(f) == EOF;
+    if (f) fclose(f);
+
+    memcpy(ref, keys, (size_t)n * kb);
+    g_limbs = limbs;
+    qsort(ref, (size_t)n, kb, cmp_limbs);
+    for (size_t i = 0; ok && i < (size_t)n * limbs; i++) ok = get_be64(bytes + 8 * i) == ref[i];
+
+    remove(in);
+    remove(out);
+    free(bytes); free(ref);
+    return ok;
+}
+
+static int check_file_sorts(int n, uint64_t seed) {
+    const char *dir = getenv("TMPDIR");
+    if (!dir || !*dir) dir = "/tmp";
+    uint64_t *keys = (uint64_t *)malloc((size_t)n * 8 * sizeof(uint64_t));
+    if (!keys) return 0;
+
+    uint64_t s = seed ? seed : 1;
+    for (size_t i = 0; i < (size_t)n * 8; i++) keys[i] = xorshift64(&s) >> (i % 3 == 0 ? 40 : 0);
+
+    const int ok = check_file_sort(2, keys, n, dir) &&
+                   check_file_sort(4, keys, n, dir) &&
+                   check_file_sort(8, keys, n, dir);
+
+    printf("file sorts (u128, u256 in place, u512 multi pass): %s\n", ok ? "OK" : "FAIL");
+    free(keys);
+    return ok;
+}
+
+// psort_stats: zeros when compiled out; otherwise the counters must add up
+// (every level is either skipped or partitions, distinct keys all end in a
+// leaf) and reset must clear them.
+static int check_stats(const psort_u128_t *base, int n) {
+    psort_stats st;
+    memset(&st, 0xff, sizeof(st));
+    psort_stats_reset();
+    psort_stats_get(&st);
+    int ok = st.levels == 0 && st.partitions == 0 && st.leaf_elems == 0 && st.max_depth == 0;
+    if (!psort_stats_enabled()) {
+        printf("stats (compiled out): %s\n", ok ? "OK" : "FAIL");
+        return ok;
+    }
+
+    psort_u128_t *a = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u256_t *k256 = (psort_u256_t *)calloc((size_t)n, sizeof(psort_u256_t));
+    uint32_t *idx = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *tmp = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    if (!a || !k256 || !idx || !tmp) {
+        free(a); free(k256); free(idx); free(tmp);
+        return 0;
+    }
+
+    // Counts below assume the built in cutoffs (PIPESORT_PROFILE may differ).
+    psort_profile prof;
+    psort_get_profile(&prof);
+    psort_set_profile(NULL);
+
+    // Random 128-bit keys are distinct, so no range is skipped.
+    memcpy(a, base, (size_t)n * sizeof(psort_u128_t));
+    psort_u128(a, n);
+    psort_stats_get(&st);
+    ok = ok && is_sorted_u128(a, n) && st.leaf_elems == (uint64_t)n &&
+         st.levels == st.partitions + st.skipped_levels && st.max_leaf <= 48;
+    if (n > 48) {
+        ok = ok && st.partitions > 0 && st.max_depth > 1 && st.elems_moved > 0 &&
+             st.bytes_moved == st.elems_moved * sizeof(psort_u128_t) && st.cycles_diff_scan > 0;
+    }
+
+    // Index radix: 64 high bits shared, so whole levels are skipped.
+    for (int i = 0; i < n; i++) {
+        k256[i].w3 = 7;
+        k256[i].w2 = base[i].hi;
+        k256[i].w1 = base[i].lo;
+    }
+    iota_u32(idx, n);
+    psort_stats_reset();
+    psort_u256_index(idx, tmp, k256, n);
+    psort_stats_get(&st);
+    ok = ok && st.leaf_elems <= (uint64_t)n && st.levels == st.partitions + st.skipped_levels &&
+         st.bytes_moved == st.elems_moved * sizeof(uint32_t);
+    if (n > 96) ok = ok && st.skipped_levels > 0 && st.elems_moved >= 2 * (uint64_t)n;
+
+    // psort_u: explicit stack depth; the all-equal copies are skipped levels.
+    for (int i = 0; i < n; i++) a[i] = base[i % 64];
+    psort_stats_reset();
+    psort_u((uint64_t *)a, (size_t)n, 2);
+    psort_stats_get(&st);
+    ok = ok && is_sorted_u128(a, n) && st.levels == st.partitions + st.skipped_levels;
+    if (n > 64) ok = ok && st.skipped_levels > 0 && st.max_depth > 0;
+    ok = ok && st.bytes_moved == st.elems_moved * sizeof(psort_u128_t); // per key bytes, swaps included
+
+    psort_stats_reset();
+    psort_stats_get(&st);
+    ok = ok && st.levels == 0 && st.elems_moved == 0 && st.cycles_leaf == 0;
+
+    psort_set_profile(&prof);
+    printf("stats (u128, u256 index, psort_u): %s\n", ok ? "OK" : "FAIL");
+    free(a); free(k256); free(idx); free(tmp);
+    return ok;
+}
+
+// Profile: extreme values must still sort correctly through every engine the
+// profile steers; save/load round trips; psort_tune installs what it returns.
+static int check_tune(const psort_u128_t *base, const psort_u128_t *sorted, int n) {
+    const char *dir = getenv("TMPDIR");
+    if (!dir || !*dir) dir = "/tmp";
+    char path[512];
+    snprintf(path, sizeof(path), "%s/psort_test_profile.txt", dir);
+
+    psort_u128_t *a = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u512_t *k512 = (psort_u512_t *)calloc((size_t)n, sizeof(psort_u512_t));
+    uint32_t *idx = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *i2 = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *tmp = (uint32_t *)malloc(4 * (size_t)n * sizeof(uint32_t)); // 4n: cached sort
+    if (!a || !k512 || !idx || !i2 || !tmp) {
+        free(a); free(k512); free(idx); free(i2); free(tmp);
+        return 0;
+    }
+
+    psort_profile def, cur, p, q;
+    psort_profile_default(&def);
+    psort_get_profile(&cur);
+    int ok = getenv("PIPESORT_PROFILE") || memcmp(&def, &cur, sizeof(def)) == 0;
+
+    // Tiny leaves, 11-bit digits everywhere, psort_u for every width;
+    // then the opposite corner.
+    for (int pass = 0; pass < 2 && ok; pass++) {
+        p = def;
+        p.u128_cutoff = p.u256_cutoff = p.u512_cutoff = p.u_cutoff = pass ? 300 : 2;
+        p.radix_cutoff = p.u512_radix_cutoff = pass ? 300 : 2;
+        p.radix_bits6_min = p.radix_bits8_min = p.radix_bits11_min = pass ? 1 << 30 : 1;
+        p.u512_radix_bits6_min = p.u512_radix_bits8_min = p.u512_radix_bits11_min = pass ? 1 << 30 : 1;
+        p.u128_generic_min = p.u256_generic_min = p.u512_generic_min = pass ? 1 << 30 : 0;
+        psort_set_profile(&p);
+
+        memcpy(a, base, (size_t)n * sizeof(psort_u128_t));
+        psort_u128(a, n);
+        ok = ok && arrays_equal_u128(a, sorted, n);
+        memcpy(a, base, (size_t)n * sizeof(psort_u128_t));
+        psort_u128_select(a, n, n / 3);
+        ok = ok && a[n / 3].hi == sorted[n / 3].hi && a[n / 3].lo == sorted[n / 3].lo;
+
+        for (int i = 0; i < n; i++) {
+            k512[i].w7 = base[i].hi >> 60;   // few distinct tops: deep shared prefixes
+            k512[i].w3 = base[i].hi;
+            k512[i].w0 = base[i].lo;
+        }
+        iota_u32(idx, n);
+        psort_u512_index(idx, tmp, k512, n);
+        for (int i = 1; i < n && ok; i++) ok = cmp_u512(&k512[idx[i - 1]], &k512[idx[i]]) <= 0;
+        iota_u32(i2, n);
+        psort_u512_index_cached(i2, tmp, k512, n);
+        ok = ok && memcmp(idx, i2, (size_t)n * sizeof(uint32_t)) == 0;
+        psort_u512(k512, n);
+        ok = ok && psort_u512_is_sorted(k512, n);
+    }
+
+    p = def;
+    p.u128_cutoff = 7;
+    p.radix_bits8_min = 12345;
+    p.u512_radix_bits8_min = 23456;
+    p.u512_generic_min = 4096;
+    ok = ok && psort_profile_save(path, &p) == 0 && psort_profile_load(path, &q) == 0;
+    ok = ok && q.u128_cutoff == 7 && q.radix_bits8_min == 12345 &&
+         q.u512_radix_bits8_min == 23456 && q.u512_generic_min == 4096;
+    FILE *f = fopen(path, "w");
+    if (f) {
+        fputs("not a profile\n", f);
+        fclose(f);
+    }
+    ok = ok && psort_profile_load(path, &q) == -1;
+    remove(path);
+
+    ok = ok && psort_tune(&p, 4096) == 0;
+    psort_get_profile(&q);
+    ok = ok && memcmp(&p, &q, sizeof(p)) == 0 && p.u128_cutoff >= 2 &&
+         p.radix_bits6_min <= p.radix_bits8_min && p.radix_bits8_min <= p.radix_bits11_min &&
+         p.u512_radix_bits6_min <= p.u512_radix_bits8_min &&
+         p.u512_radix_bits8_min <= p.u512_radix_bits11_min;
+    memcpy(a, base, (size_t)n * sizeof(psort_u128_t));
+    psort_u128(a, n);
+    ok = ok && arrays_equal_u128(a, sorted, n);
+
+    psort_set_profile(NULL);
+    psort_get_profile(&q);
+    ok = ok && memcmp(&def, &q, sizeof(def)) == 0;
+
+    printf("profile (extremes, save/load, psort_tune): %s\n", ok ? "OK" : "FAIL");
+    free(a); free(k512); free(idx); free(i2); free(tmp);
+    return ok;
+}
+
+// Run detection pre-pass: sorted, reversed, sorted prefix + tail, several
+// runs, descending prefix, nearly sorted (drop-merge) and a drop-merge that
+// gives up, through psort_u128 / psort_u256 / psort_u and the stable u256
+// index sort. Keys repeat, so index ties check stability too.
+static void runs_pattern(uint64_t *k, int n, size_t limbs, int pat, uint64_t *s) {
+    for (int i = 0; i < n; i++) {
+        const uint64_t v = xorshift64(s) % 8000;
+        for (size_t l = 0; l < limbs; l++) k[(size_t)i * limbs + l] = v * (0x9E3779B97F4A7C15ULL + l);
+    }
+    g_limbs = limbs;
+    const size_t ksz = limbs * sizeof(uint64_t);
+    const int q = n / 4;
+    switch (pat) {
+        case 0: qsort(k, (size_t)n, ksz, cmp_limbs); break;                        // sorted
+        case 1: case 4:                                                             // reversed / descending prefix
+            qsort(k, (size_t)(pat == 1 ? n : 3 * q), ksz, cmp_limbs);
+            for (int i = 0, j = (pat == 1 ? n : 3 * q) - 1; i < j; i++, j--) {
+                uint64_t t[8];
+                memcpy(t, k + (size_t)i * limbs, ksz);
+                memcpy(k + (size_t)i * limbs, k + (size_t)j * limbs, ksz);
+                memcpy(k + (size_t)j * limbs, t, ksz);
+            }
+            break;
+        case 2: qsort(k, (size_t)(3 * q), ksz, cmp_limbs); break;                  // sorted prefix + tail
+        case 3:                                                                     // three runs
+            qsort(k, (size_t)(2 * q), ksz, cmp_limbs);
+            qsort(k + (size_t)(2 * q) * limbs, (size_t)q, ksz, cmp_limbs);
+            qsort(k + (size_t)(3 * q) * limbs, (size_t)(n - 3 * q), ksz, cmp_limbs);
+            break;
+        case 5: case 6:                                                             // nearly sorted
+            qsort(k, (size_t)n, ksz, cmp_limbs);
+            for (int t = 0; t < n / 100; t++) {
+                const size_t i = (size_t)(xorshift64(s) % (uint64_t)n), j = (size_t)(xorshift64(s) % (uint64_t)n);
+                uint64_t x[8];
+                memcpy(x, k + i * limbs, ksz);
+                memcpy(k + i * limbs, k + j * limbs, ksz);
+                memcpy(k + j * limbs, x, ksz);
+            }
+            if (pat == 6) {  // a block of maximal keys early on: backtracking pops
+                for (int i = 200; i < 240; i++) memset(k + (size_t)i * limbs, 0xff, ksz);
+            }
+            break;
+        default: qsort(k, 100, ksz, cmp_limbs); break;                             // drop-merge gives up
+    }
+}
+
+static int check_runs(uint64_t seed) {
+    const int n = 20000;
+    uint64_t *k = (uint64_t *)malloc((size_t)n * 4 * sizeof(uint64_t));
+    uint64_t *w = (uint64_t *)malloc((size_t)n * 4 * sizeof(uint64_t));
+    uint64_t *ref = (uint64_t *)malloc((size_t)n * 4 * sizeof(uint64_t));
+    uint32_t *idx = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *tmp = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    if (!k || !w || !ref || !idx || !tmp) {
+        free(k); free(w); free(ref); free(idx); free(tmp);
+        return 0;
+    }
+
+    uint64_t s = seed ? seed : 1;
+    int ok = 1;
+    for (int pat = 0; pat < 8 && ok; pat++) {
+        for (size_t limbs = 2; limbs <= 4 && ok; limbs++) {
+            const size_t words = (size_t)n * limbs;
+            runs_pattern(k, n, limbs, pat, &s);
+            memcpy(ref, k, words * sizeof(uint64_t));
+            g_limbs = limbs;
+            qsort(ref, (size_t)n, limbs * sizeof(uint64_t), cmp_limbs);
+
+            memcpy(w, k, words * sizeof(uint64_t));
+            if (limbs == 2)      psort_u128((psort_u128_t *)w, n);
+            else if (limbs == 4) psort_u256((psort_u256_t *)w, n);
+            else                 psort_u(w, (size_t)n, limbs);
+            ok = memcmp(w, ref, words * sizeof(uint64_t)) == 0;
+
+            if (limbs == 4 && ok) {
+                iota_u32(idx, n);
+                psort_u256_index(idx, tmp, (const psort_u256_t *)k, n);
+                for (int i = 1; i < n && ok; i++) {
+                    const int c = cmp_u256((const psort_u256_t *)k + idx[i - 1],
+                                           (const psort_u256_t *)k + idx[i]);
+                    ok = c < 0 || (c == 0 && idx[i - 1] < idx[i]);
+                }
+            }
+            if (!ok) fprintf(stderr, "runs: pattern %d, %zu limbs\n", pat, limbs);
+        }
+    }
+
+    // Shrinking sorted runs (n/2, n/4, ...) and a short n/3 prefix: every peel
+    // merges, through one buffer of the shorter part at a time.
+    psort_ctx *ctx = psort_ctx_create(NULL, 0);
+    ok = ok && ctx != NULL;
+    for (int layout = 0; layout < 2 && ok; layout++) {
+        const size_t words = (size_t)n * 4;
+        for (size_t i = 0; i < words; i++) k[i] = xorshift64(&s);
+        if (layout == 0) {
+            for (int lo = 0, len = n / 2; lo < n; lo += len, len = len / 2 ? len / 2 : 1) {
+                const int m = len < n - lo ? len : n - lo;
+                psort_u256((psort_u256_t *)k + lo, m);
+            }
+        } else {
+            psort_u256((psort_u256_t *)k, n / 3);
+        }
+        memcpy(ref, k, words * sizeof(uint64_t));
+        g_limbs = 4;
+        qsort(ref, (size_t)n, 4 * sizeof(uint64_t), cmp_limbs);
+
+        psort_ctx *prev = psort_ctx_bind(ctx);
+        psort_u256((psort_u256_t *)k, n);
+        psort_ctx_bind(prev);
+        ok = memcmp(k, ref, words * sizeof(uint64_t)) == 0 &&
+             psort_ctx_peak(ctx) <= (size_t)(n / 2) * sizeof(psort_u256_t) + 64;
+        if (!ok) fprintf(stderr, "runs: merge layout %d, peak %zu\n", layout, psort_ctx_peak(ctx));
+    }
+    psort_ctx_destroy(ctx);
+
+    printf("run detection (sorted, reversed, runs, nearly sorted): %s\n", ok ? "OK" : "FAIL");
+    free(k); free(w); free(ref); free(idx); free(tmp);
+    return ok;
+}
+
+static int check_hash(uint64_t seed) {
+    const int n = 30000;
+    uint64_t *k = (uint64_t *)malloc((size_t)n * 8 * sizeof(uint64_t));
+    uint32_t *i1 = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *i2 = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *tmp = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    if (!k || !i1 || !i2 || !tmp) {
+        free(k); free(i1); free(i2); free(tmp);
+        return 0;
+    }
+
+    // 0: uniform, 1: many duplicate keys, 2: shared leading bits (long
+    // equal-prefix runs), 3: constant leading word
+    uint64_t s = seed ? seed : 1;
+    int ok = 1;
+    for (int pat = 0; pat < 4 && ok; pat++) {
+        for (size_t limbs = 4; limbs <= 8 && ok; limbs += 4) {
+            for (size_t i = 0; i < (size_t)n * limbs; i++) k[i] = xorshift64(&s);
+            for (int i = 0; i < n; i++) {
+                uint64_t *key = k + (size_t)i * limbs;
+                if (pat == 1) memcpy(key, k + (xorshift64(&s) % 500) * limbs, limbs * sizeof(uint64_t));
+                if (pat == 2) key[0] = 0xABCDEF0000000000ULL | (key[0] >> 48);
+                if (pat == 3) key[0] = 42;
+            }
+            iota_u32(i1, n);
+            iota_u32(i2, n);
+            if (limbs == 4) {
+                psort_u256_index(i1, tmp, (const psort_u256_t *)k, n);
+                psort_u256_index_hash(i2, tmp, (const psort_u256_t *)k, n);
+            } else {
+                psort_u512_index(i1, tmp, (const psort_u512_t *)k, n);
+                psort_u512_index_hash(i2, tmp, (const psort_u512_t *)k, n);
+            }
+            ok = memcmp(i1, i2, (size_t)n * sizeof(uint32_t)) == 0;
+            if (!ok) fprintf(stderr, "hash: pattern %d, %zu limbs\n", pat, limbs);
+        }
+    }
+
+    printf("hash index sorts (u256/u512): %s\n", ok ? "OK" : "FAIL");
+    free(k); free(i1); free(i2); free(tmp);
+    return ok;
+}
+
+typedef struct {
+    size_t calls;
+    size_t live_bytes;
+} count_alloc;
+
+static void *count_alloc_fn(void *user, size_t bytes) {
+    count_alloc *c = (count_alloc *)user;
+    c->calls++;
+    c->live_bytes += bytes;
+    return malloc(bytes);
+}
+
+static void count_free_fn(void *user, void *p, size_t bytes) {
+    count_alloc *c = (count_alloc *)user;
+    c->live_bytes -= bytes;
+    free(p);
+}
+
+// One round of the sorts that take scratch from a bound context (run
+// detection merge, hash index sort, a large k-way merge), plus the cached
+// prefix sort on a tmp taken from the context.
+static int ctx_round(psort_ctx *ctx, const psort_u256_t *keys, psort_u256_t *w,
+                     uint32_t *i1, uint32_t *i2, const psort_u128_t *const *runs,
+                     const size_t *lens, size_t k, psort_u128_t *out, int n) {
+    uint32_t *tmp = (uint32_t *)psort_ctx_alloc(ctx, 4 * (size_t)n * sizeof(uint32_t));
+    if (!tmp || ((uintptr_t)tmp & 63)) return 0;
+    int ok = 1;
+
+    iota_u32(i1, n);
+    ok = ok && psort_u256_index_ctx(ctx, i1, keys, n) == 0;
+    iota_u32(i2, n);
+    psort_u256_index_hash(i2, tmp, keys, n);
+    ok = ok && memcmp(i1, i2, (size_t)n * sizeof(uint32_t)) == 0;
+    iota_u32(i2, n);
+    psort_u256_index_cached(i2, tmp, keys, n);
+    ok = ok && memcmp(i1, i2, (size_t)n * sizeof(uint32_t)) == 0;
+
+    memcpy(w, keys, (size_t)n * sizeof(psort_u256_t));
+    psort_u256(w, n);
+    for (int i = 0; i < n && ok; i++) ok = cmp_u256(&w[i], &keys[i1[i]]) == 0;
+
+    psort_u128_merge_k(out, runs, lens, k);
+    size_t total = 0;
+    for (size_t r = 0; r < k; r++) total += lens[r];
+    ok = ok && is_sorted_u128(out, (int)total);
+
+    psort_ctx_free(ctx, tmp);
+    return ok;
+}
+
+static int check_ctx(const psort_u128_t *base, int n) {
+    enum { K = 100 };
+    const int m = 50000;
+    count_alloc counter = {0, 0};
+    const psort_allocator a = { count_alloc_fn, count_free_fn, &counter };
+    psort_ctx *ctx = psort_ctx_create(&a, 0);
+    psort_u256_t *keys = (psort_u256_t *)malloc((size_t)m * sizeof(psort_u256_t));
+    psort_u256_t *w = (psort_u256_t *)malloc((size_t)m * sizeof(psort_u256_t));
+    uint32_t *i1 = (uint32_t *)malloc((size_t)m * sizeof(uint32_t));
+    uint32_t *i2 = (uint32_t *)malloc((size_t)m * sizeof(uint32_t));
+    psort_u128_t *parts = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    psort_u128_t *out = (psort_u128_t *)malloc((size_t)n * sizeof(psort_u128_t));
+    if (!ctx || !keys || !w || !i1 || !i2 || !parts || !out) {
+        psort_ctx_destroy(ctx);
+        free(keys); free(w); free(i1); free(i2); free(parts); free(out);
+        return 0;
+    }
+
+    // Sorted first half, then random keys: psort_u256 sorts the tail and
+    // merges through a scratch buffer.
+    for (int i = 0; i < m; i++) {
+        const psort_u128_t *b = &base[i % n];
+        keys[i].w3 = i < m / 2 ? (uint64_t)i : b->hi;
+        keys[i].w2 = b->lo;
+        keys[i].w1 = b->hi ^ b->lo;
+        keys[i].w0 = (uint64_t)i;
+    }
+    const psort_u128_t *runs[K];
+    size_t lens[K];
+    memcpy(parts, base, (size_t)n * sizeof(psort_u128_t));
+    for (int r = 0; r < K; r++) {
+        const int lo = (int)((long long)n * r / K), hi = (int)((long long)n * (r + 1) / K);
+        psort_u128(parts + lo, hi - lo);
+        runs[r] = parts + lo;
+        lens[r] = (size_t)(hi - lo);
+    }
+
+    psort_ctx *prev = psort_ctx_bind(ctx);
+    int ok = ctx_round(ctx, keys, w, i1, i2, runs, lens, K, out, m);
+    const size_t warm = counter.calls;
+    ok = ok && ctx_round(ctx, keys, w, i1, i2, runs, lens, K, out, m);
+    ok = ok && ctx_round(ctx, keys, w, i1, i2, runs, lens, K, out, m / 3);
+    ok = ok && counter.calls == warm; // no allocator calls after warm-up
+    ok = ok && psort_ctx_peak(ctx) >= (size_t)m * 32 && psort_ctx_peak(ctx) <= psort_ctx_capacity(ctx);
+    psort_ctx_bind(prev);
+
+    ok = ok && psort_ctx_reserve(ctx, psort_ctx_capacity(ctx) * 2) == 0 && counter.calls == warm + 1;
+    psort_ctx_destroy(ctx);
+    ok = ok && counter.live_bytes == 0;
+
+    // Huge page chunks (a hint only; must work whether or not THP is on).
+    ctx = psort_ctx_create(NULL, PSORT_CTX_HUGE_PAGES);
+    ok = ok && ctx && psort_ctx_reserve(ctx, 4u << 20) == 0;
+    if (ctx) {
+        iota_u32(i1, m);
+        ok = ok && psort_u256_index_ctx(ctx, i1, keys, m) == 0;
+        for (int i = 1; i < m && ok; i++) ok = cmp_u256(&keys[i1[i - 1]], &keys[i1[i]]) < 0;
+        psort_ctx_destroy(ctx);
+    }
+
+    printf("sort context (reuse, allocator hooks, huge pages): %s\n", ok ? "OK" : "FAIL");
+    free(keys); free(w); free(i1); free(i2); free(parts); free(out);
+    return ok;
+}
+
+static int check_apply(int n, uint64_t seed) {
+    static const size_t widths[] = { 64, 4, 12, 100 };
+    enum { C = 4 };
+    void *src[C], *out[C], *ref[C];
+    uint32_t *idx = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *tmp = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    uint32_t *keep = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    int ok = idx && tmp && keep;
+    for (int c = 0; c < C; c++) {
+        src[c] = malloc((size_t)n * widths[c]);
+        out[c] = malloc((size_t)n * widths[c]);
+        ref[c] = malloc((size_t)n * widths[c]);
+        ok = ok && src[c] && out[c] && ref[c];
+    }
+
+    uint64_t s = seed ? seed : 1;
+    if (ok) {
+        for (int c = 0; c < C; c++) {
+            uint8_t *b = (uint8_t *)src[c];
+            for (size_t i = 0; i < (size_t)n * widths[c]; i++) b[i] = (uint8_t)xorshift64(&s);
+        }
+        // Column 0 are u512 keys with few distinct high limbs.
+        psort_u512_t *keys = (psort_u512_t *)src[0];
+        for (int i = 0; i < n; i++) keys[i].w7 &= 0xF;
+        iota_u32(idx, n);
+        psort_u512_index(idx, tmp, keys, n);
+        memcpy(keep, idx, (size_t)n * sizeof(uint32_t));
+        for (int c = 0; c < C; c++) {
+            for (int i = 0; i < n; i++) {
+                memcpy((uint8_t *)ref[c] + (size_t)i * widths[c],
+                       (const uint8_t *)src[c] + (size_t)idx[i] * widths[c], widths[c]);
+            }
+        }
+
+        for (int c = 0; c < C && ok; c++) {
+            psort_apply_index(out[c], src[c], idx, n, widths[c]);
+            ok = memcmp(out[c], ref[c], (size_t)n * widths[c]) == 0;
+        }
+        for (int c = 0; c < C; c++) memset(out[c], 0, (size_t)n * widths[c]);
+        psort_apply_index_columns(out, (const void *const *)src, widths, C, idx, n);
+        for (int c = 0; c < C && ok; c++) ok = memcmp(out[c], ref[c], (size_t)n * widths[c]) == 0;
+
+        for (int c = 0; c < C && ok; c++) {
+            psort_apply_index_inplace(src[c], idx, n, widths[c]);
+            ok = memcmp(src[c], ref[c], (size_t)n * widths[c]) == 0 &&
+                 memcmp(idx, keep, (size_t)n * sizeof(uint32_t)) == 0;
+        }
+        for (int i = 1; i < n && ok; i++) ok = cmp_u512(&keys[i - 1], &keys[i]) <= 0;
+    }
+
+    printf("apply index (gather, columns, in place cycles): %s\n", ok ? "OK" : "FAIL");
+    for (int c = 0; c < C; c++) { free(src[c]); free(out[c]); free(ref[c]); }
+    free(idx); free(tmp); free(keep);
+    return ok;
+}
+
+// Lower bounds through a directory vs. a plain binary search, for u128 and
+// u256 keys: uniform, duplicate heavy, shared leading bits, all equal.
+static int check_lookup(const psort_u128_t *sorted, int n, uint64_t seed) {
+    const size_t m = 4096;
+    psort_u128_t *q128 = (psort_u128_t *)malloc(m * sizeof(psort_u128_t));
+    psort_u256_t *k256 = (psort_u256_t *)malloc((size_t)n * sizeof(psort_u256_t));
+    psort_u256_t *q256 = (psort_u256_t *)malloc(m * sizeof(psort_u256_t));
+    size_t *out = (size_t *)malloc(m * sizeof(size_t));
+    if (!q128 || !k256 || !q256 || !out) {
+        free(q128); free(k256); free(q256); free(out);
+        return 0;
+    }
+
+    uint64_t s = seed ? seed : 1;
+    int ok = 1;
+    for (int pat = 0; pat < 4 && ok; pat++) {
+        for (int i = 0; i < n; i++) {
+            const uint64_t r = xorshift64(&s);
+            k256[i].w3 = pat == 2 ? 0xFEDC000000000000ULL | (r >> 40) : pat == 3 ? 7 : r;
+            k256[i].w2 = pat == 1 ? r % 3 : pat == 3 ? 5 : xorshift64(&s);
+            k256[i].w1 = pat == 1 || pat == 3 ? 0 : xorshift64(&s);
+            k256[i].w0 = pat == 3 ? 1 : xorshift64(&s);
+            if (pat == 1) k256[i].w3 = r % 50;
+        }
+        psort_u256(k256, n);
+        for (size_t j = 0; j < m; j++) {
+            const psort_u256_t *k = &k256[xorshift64(&s) % (uint64_t)n];
+            q256[j] = *k;
+            if (j % 4 == 1) q256[j].w0++;                      // between keys
+            if (j % 4 == 2) q256[j].w3 = xorshift64(&s);        // anywhere, mostly outside the prefix
+            if (j % 4 == 3) q256[j].w2 ^= 1ULL << (j % 64);
+        }
+        q256[0].w3 = q256[0].w2 = q256[0].w1 = q256[0].w0 = 0;
+        q256[1].w3 = q256[1].w2 = q256[1].w1 = q256[1].w0 = ~0ULL;
+
+        for (int bits = 0; bits <= 12 && ok; bits += 12) {
+            psort_u256_dir *d = psort_u256_dir_build(k256, (size_t)n, bits);
+            ok = d != NULL;
+            if (ok) psort_u256_lower_bound_batch(d, q256, m, out);
+            for (size_t j = 0; j < m && ok; j++) {
+                size_t lo = 0, hi = (size_t)n;
+                while (lo < hi) {
+                    const size_t mid = lo + (hi - lo) / 2;
+                    if (cmp_u256(&k256[mid], &q256[j]) < 0) lo = mid + 1;
+                    else                                    hi = mid;
+                }
+                ok = out[j] == lo && psort_u256_lower_bound(d, &q256[j]) == lo;
+            }
+            psort_u256_dir_destroy(d);
+        }
+        if (!ok) fprintf(stderr, "lookup: u256 pattern %d\n", pat);
+    }
+
+    // u128 over the sorted base keys (n - 1 of them, so odd counts and n = 1 -> empty occur)
+    const size_t nk = (size_t)n - 1;
+    for (size_t j = 0; j < m; j++) {
+        q128[j] = sorted[xorshift64(&s) % (uint64_t)n];
+        if (j % 2) q128[j].lo += j % 3 ? 1 : (uint64_t)-1;
+    }
+    psort_u128_dir *d = psort_u128_dir_build(sorted, nk, 0);
+    ok = ok && d != NULL;
+    if (ok) psort_u128_lower_bound_batch(d, q128, m, out);
+    for (size_t j = 0; j < m && ok; j++) {
+        size_t lo = 0, hi = nk;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (cmp_u128(&sorted[mid], &q128[j]) < 0) lo = mid + 1;
+            else                                      hi = mid;
+        }
+        ok = out[j] == lo && psort_u128_lower_bound(d, &q128[j]) == lo;
+    }
+    psort_u128_dir_destroy(d);
+
+    printf("lookup directory (u128/u256 lower bounds, batched): %s\n", ok ? "OK" : "FAIL");
+    free(q128); free(k256); free(q256); free(out);
+    return ok;
+}
+
 int main(int argc, char **argv) {
     int n = (argc > 1) ? atoi(argv[1]) : 200000;
     uint64_t seed = (argc > 2) ? (uint64_t)strtoull(argv[2], NULL, 10) : 123;
@@ -103,6 +1411,31 @@ int main(int argc, char **argv) {
     double speedup = (t1 - t0) / (t3 - t2);
     printf("speedup (qsort/psort): %.3fx\n", speedup);
 
+    if (!check_u128_parallel(base, a_q, n) ||
+        !check_index_sorts(n, seed) ||
+        !check_kv_sorts(base, a_q, n) ||
+        !check_psort_u(n, seed) ||
+        !check_partition_modes(base, a_q, n, seed) ||
+        !check_file_sorts(n, seed) ||
+        !check_merge_stream(base, a_q, n) ||
+        !check_select(base, a_q, n, seed) ||
+        !check_unique(base, n) ||
+        !check_stable(base, a_q, n) ||
+        !check_large(base, a_q, n, seed) ||
+        !check_bytes(n, seed) ||
+        !check_records(base, n) ||
+        !check_stats(base, n) ||
+        !check_tune(base, a_q, n) ||
+        !check_runs(seed) ||
+        !check_hash(seed) ||
+        !check_ctx(base, n) ||
+        !check_apply(n, seed) ||
+        !check_lookup(a_q, n, seed)) {
+        fprintf(stderr, "ERROR: extended checks failed\n");
+        free(base); free(a_q); free(a_p);
+        return 1;
+    }
+
     free(base);
     free(a_q);
     free(a_p);